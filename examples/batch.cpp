@@ -0,0 +1,158 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include "ACESclipBatch.h"
+
+
+static bool is_directory( const char* path )
+{
+#ifdef _WIN32
+    DWORD a = GetFileAttributesA( path );
+    return a != INVALID_FILE_ATTRIBUTES && ( a & FILE_ATTRIBUTE_DIRECTORY );
+#else
+    struct stat st;
+    return stat( path, &st ) == 0 && S_ISDIR( st.st_mode );
+#endif
+}
+
+static void usage( const char* prog )
+{
+    std::cerr << prog << " v0.2" << std::endl
+              << std::endl
+              << prog << " [-j threads] [-p] <directory|file>..."
+              << std::endl
+              << std::endl
+              << "  -j threads  number of threads (default: all cores)"
+              << std::endl
+              << "  -p          only read ClipName, Source_MediaID and IDT"
+              << std::endl
+              << std::endl
+              << "Example: "
+              << std::endl
+              << std::endl
+              << prog << " -j 8 /shows/potc/"
+              << std::endl;
+    exit(-1);
+}
+
+int main( int argc, char** argv )
+{
+    unsigned threads = 0;
+    bool probe = false;
+    std::vector< std::string > files;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-j" ) == 0 && i+1 < argc )
+        {
+            threads = atoi( argv[++i] );
+        }
+        else if ( strcmp( argv[i], "-p" ) == 0 )
+        {
+            probe = true;
+        }
+        else if ( argv[i][0] == '-' )
+        {
+            usage( argv[0] );
+        }
+        else if ( is_directory( argv[i] ) )
+        {
+            if ( !ACES::ACESclipBatch::find_files( argv[i], files ) )
+                std::cerr << "Could not read '" << argv[i] << "'." 
+                          << std::endl;
+        }
+        else
+        {
+            files.push_back( argv[i] );
+        }
+    }
+
+    if ( files.empty() ) usage( argv[0] );
+
+    ACES::ThreadPool pool( threads );
+    ACES::ACESclipBatch batch( &pool );
+    if ( probe )
+        batch.sections( ACES::ACESclipReader::kSectionClipID |
+                        ACES::ACESclipReader::kSectionITL );
+
+    std::chrono::steady_clock::time_point start = 
+    std::chrono::steady_clock::now();
+
+    ACES::ACESclipBatch::Results results;
+    batch.load( files, results );
+
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - 
+                                         start;
+
+    ACES::ACESclipReader r;   // for error_name()
+    size_t errors = 0;
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        const ACES::ACESclipBatch::Result& res = results[i];
+        std::cout << res.filename << ": ";
+        if ( res.error != ACES::ACESclipReader::kAllOK )
+        {
+            ++errors;
+            std::cout << "ERROR " << r.error_name( res.error ) << std::endl;
+            continue;
+        }
+
+        const ACES::ACESclipMetadata& m = res.metadata;
+        std::cout << m.clip_name << " | " << m.media_id;
+        if ( !m.IDT.name.empty() ) std::cout << " | IDT: " << m.IDT.name;
+        if ( !probe )
+        {
+            for ( size_t j = 0; j < m.LMT.size(); ++j )
+                std::cout << " | LMT: " << m.LMT[j].name;
+            if ( !m.RRTODT.name.empty() )
+                std::cout << " | RRTODT: " << m.RRTODT.name;
+            if ( !m.RRT.name.empty() ) std::cout << " | RRT: " << m.RRT.name;
+            if ( !m.ODT.name.empty() ) std::cout << " | ODT: " << m.ODT.name;
+        }
+        std::cout << std::endl;
+    }
+
+    std::cerr << results.size() << " files, " << errors << " errors, "
+              << pool.size() << " threads, " << secs.count() << " s, "
+              << ( secs.count() > 0 ? results.size() / secs.count() : 0 )
+              << " files/s" << std::endl;
+
+    return errors ? 1 : 0;
+}
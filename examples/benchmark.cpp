@@ -0,0 +1,2601 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+//
+// Benchmarks for libACESclip.
+//
+// Usage: ACESclipBench <mode> [arguments]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ACESclipReader.h"
+#include "ACESclipWriter.h"
+#include "ACESclipStreamWriter.h"
+#include "ACESclipTemplate.h"
+#include "ACESclipBatch.h"
+#include "ACESclipBatchWriter.h"
+#include "ACESclipCache.h"
+#include "ACESclipCatalog.h"
+#include "ACESclipPatch.h"
+#include "ACESCDLBitDepth.h"
+#include "ACESCDLExecutor.h"
+#include "ACESCDLInverse.h"
+#include "ACESCDLLut.h"
+#include "ACESCDLProcessor.h"
+#include "ACESCDLWorkSpace.h"
+#include "ACESNumeric.h"
+#include "ACESObjectPool.h"
+#include "ACESUUID.h"
+
+#ifdef ACES_HAVE_BOOST
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#endif
+
+
+//
+// Allocation counters.  Every operator new in the process goes through
+// here, including the ones made inside the library.
+//
+static std::atomic<size_t> g_alloc_bytes( 0 );
+static std::atomic<size_t> g_alloc_count( 0 );
+
+void* operator new( size_t n )
+{
+    g_alloc_bytes.fetch_add( n, std::memory_order_relaxed );
+    g_alloc_count.fetch_add( 1, std::memory_order_relaxed );
+    void* p = malloc( n ? n : 1 );
+    if ( !p ) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete( void* p ) noexcept
+{
+    free( p );
+}
+
+struct Counters
+{
+    Counters() { reset(); }
+
+    void reset()
+    {
+        bytes = g_alloc_bytes.load();
+        count = g_alloc_count.load();
+        start = std::chrono::steady_clock::now();
+    }
+
+    double seconds() const
+    {
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - 
+                                          start;
+        return d.count();
+    }
+
+    size_t allocated_bytes() const { return g_alloc_bytes.load() - bytes; }
+    size_t allocations() const { return g_alloc_count.load() - count; }
+
+    size_t bytes, count;
+    std::chrono::steady_clock::time_point start;
+};
+
+static void report( const char* name, const Counters& c, size_t items,
+                    const char* unit )
+{
+    double s = c.seconds();
+    std::cout << "  " << name << ": " 
+              << ( s > 0 ? items / s : 0 ) << " " << unit << "/s, "
+              << (double) c.allocated_bytes() / items << " bytes and "
+              << (double) c.allocations() / items << " allocations per "
+              << unit << std::endl;
+}
+
+
+//
+// load: compare ACESclipReader::load() and ACESclipReader::load_mapped()
+//
+static int bench_load( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "load <file.xml>... [-n iterations]" << std::endl;
+        return -1;
+    }
+
+    std::vector< const char* > files;
+    int iterations = 1000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+        else
+            files.push_back( argv[i] );
+    }
+
+    size_t total = files.size() * iterations;
+    std::cout << "load: " << files.size() << " files x " << iterations
+              << " iterations" << std::endl;
+
+    Counters c;
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+        {
+            ACES::ACESclipReader r;
+            if ( r.load( files[i] ) != ACES::ACESclipReader::kAllOK )
+            {
+                std::cerr << "Could not load " << files[i] << std::endl;
+                return -1;
+            }
+        }
+    }
+    report( "tinyxml2 DOM", c, total, "file" );
+
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+        {
+            ACES::ACESclipReader r;
+            if ( r.load_mapped( files[i] ) != ACES::ACESclipReader::kAllOK )
+            {
+                std::cerr << "Could not load " << files[i] << std::endl;
+                return -1;
+            }
+        }
+    }
+    report( "mapped scan ", c, total, "file" );
+
+    return 0;
+}
+
+
+//
+// probe: full scan against probing only ClipName, Source_MediaID and IDT
+//
+static int bench_probe( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "probe <file.xml>... [-n iterations]" << std::endl;
+        return -1;
+    }
+
+    std::vector< const char* > files;
+    int iterations = 1000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+        else
+            files.push_back( argv[i] );
+    }
+
+    size_t total = files.size() * iterations;
+    std::cout << "probe: " << files.size() << " files x " << iterations
+              << " iterations" << std::endl;
+
+    Counters c;
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+        {
+            ACES::ACESclipReader r;
+            r.load_mapped( files[i] );
+        }
+    }
+    report( "all sections ", c, total, "file" );
+
+    const unsigned sections = ACES::ACESclipReader::kSectionClipID |
+                              ACES::ACESclipReader::kSectionITL;
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+        {
+            ACES::ACESclipReader r;
+            r.probe( files[i], sections );
+        }
+    }
+    report( "ClipID + ITL ", c, total, "file" );
+
+    return 0;
+}
+
+
+//
+// batch: ACESclipBatch scaling from 1 thread to all cores
+//
+static int bench_batch( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "batch <directory|file.xml>... [-n iterations]" 
+                  << std::endl;
+        return -1;
+    }
+
+    std::vector< std::string > files;
+    int iterations = 10;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+        else if ( !ACES::ACESclipBatch::find_files( argv[i], files ) )
+            files.push_back( argv[i] );
+    }
+
+    std::cout << "batch: " << files.size() << " files x " << iterations
+              << " iterations" << std::endl;
+
+    unsigned cores = std::thread::hardware_concurrency();
+    if ( cores == 0 ) cores = 1;
+
+    double single = 0;
+    for ( unsigned threads = 1; ; threads *= 2 )
+    {
+        if ( threads > cores ) threads = cores;
+
+        ACES::ThreadPool pool( threads );
+        ACES::ACESclipBatch batch( &pool );
+        ACES::ACESclipBatch::Results results;
+
+        Counters c;
+        for ( int n = 0; n < iterations; ++n )
+            batch.load( files, results );
+        double s = c.seconds();
+        double rate = s > 0 ? files.size() * iterations / s : 0;
+        if ( threads == 1 ) single = rate;
+
+        std::cout << "  " << threads << " threads: " << rate << " files/s, "
+                  << "speedup " << ( single > 0 ? rate / single : 0 )
+                  << std::endl;
+
+        if ( threads == cores ) break;
+    }
+
+    return 0;
+}
+
+
+//
+// parse_V3: Slope/Offset/Power triplets per second, strtod against the
+// locale-free ACES::parse_V3
+//
+static int bench_parse_V3( int argc, char** argv )
+{
+    size_t count = 1000000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            count = atoi( argv[++i] );
+    }
+
+    std::vector< std::string > texts( count );
+    srand( 1 );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        char buf[128];
+        snprintf( buf, sizeof(buf), "%.6g %.6g %.6g",
+                  rand() / (double) RAND_MAX * 4.0 - 2.0,
+                  rand() / (double) RAND_MAX,
+                  rand() / (double) RAND_MAX * 1e-3 );
+        texts[i] = buf;
+    }
+
+    std::cout << "parse_V3: " << count << " triplets" << std::endl;
+
+    float out[3];
+    Counters c;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const char* s = texts[i].c_str();
+        char* e;
+        out[0] = (float) strtod( s, &e ); s = e;
+        out[1] = (float) strtod( s, &e ); s = e;
+        out[2] = (float) strtod( s, &e );
+    }
+    report( "strtod  ", c, count, "triplet" );
+
+    size_t mismatches = 0;
+    c.reset();
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const std::string& t = texts[i];
+        ACES::parse_V3( t.c_str(), t.c_str() + t.size(), out );
+    }
+    report( "parse_V3", c, count, "triplet" );
+
+    // Results must be identical to the C library in the "C" locale
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const std::string& t = texts[i];
+        ACES::parse_V3( t.c_str(), t.c_str() + t.size(), out );
+        const char* s = t.c_str();
+        char* e;
+        for ( int j = 0; j < 3; ++j )
+        {
+            if ( strtof( s, &e ) != out[j] ) ++mismatches;
+            s = e;
+        }
+    }
+    std::cout << "  " << mismatches << " mismatches against strtof" 
+              << std::endl;
+
+    return mismatches == 0 ? 0 : -1;
+}
+
+
+//
+// reuse: a new reader and writer per file against ones checked out of
+// an ObjectPool and reset()
+//
+template< class Writer >
+static void write_clip( Writer& c )
+{
+    c.info( "mrViewer", "v2.6.9", "Sample file <with> \"escapes\" & 'quotes'" );
+    c.clip_id( "/media/Linux/image/capture.exr", "POTC-ad20" );
+    c.config();
+
+    c.ITL_start();
+
+    ACES::ASC_CDL cdl;
+    cdl.slope( 1.1f, 1.2f, 1.3f );
+    cdl.offset( -0.01f, 0.02f, 0.03f );
+    cdl.power( 0.9f, 1.0f, 1.1f );
+    cdl.saturation( 0.85f );
+    c.gradeRef_start( "ACEScsc.ACES_to_ACEScct" );
+    c.gradeRef_SOPNode( cdl );
+    c.gradeRef_SatNode( cdl );
+    c.gradeRef_end( "ACEScsc.ACEScct_to_ACES" );
+
+    c.add_IDT( "IDT.Sony.F60" );
+    c.ITL_end();
+
+    c.PTL_start();
+    c.add_LMT( "LMT.Sat.1.0.0" );
+    c.add_LMT( "LMT.Sat.2.0.0", ACES::kApplied, "link&lut" );
+    c.add_RRT( "RRT.a1.0.0" );
+    c.add_ODT( "ODT.RGB.Monitor", ACES::kApplied );
+    c.PTL_end( "combined" );
+}
+
+static int bench_reuse( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "reuse <file.xml>... [-n iterations]" << std::endl;
+        return -1;
+    }
+
+    std::vector< const char* > files;
+    int iterations = 1000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+        else
+            files.push_back( argv[i] );
+    }
+
+    size_t total = files.size() * iterations;
+    std::cout << "reuse: " << files.size() << " files x " << iterations
+              << " iterations" << std::endl;
+
+    Counters c;
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+        {
+            ACES::ACESclipReader r;
+            r.load_mapped( files[i] );
+        }
+    }
+    report( "new reader   ", c, total, "file" );
+
+    ACES::ObjectPool< ACES::ACESclipReader > readers;
+    readers.reserve( 1 );
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+        {
+            ACES::ObjectPool< ACES::ACESclipReader >::Handle r = 
+                readers.acquire();
+            r->load_mapped( files[i] );
+        }
+    }
+    report( "pooled reader", c, total, "file" );
+
+    c.reset();
+    for ( size_t i = 0; i < total; ++i )
+    {
+        ACES::ACESclipWriter w;
+        write_clip( w );
+    }
+    report( "new writer   ", c, total, "file" );
+
+    ACES::ObjectPool< ACES::ACESclipWriter > writers;
+    writers.reserve( 1 );
+    c.reset();
+    for ( size_t i = 0; i < total; ++i )
+    {
+        ACES::ObjectPool< ACES::ACESclipWriter >::Handle w = 
+            writers.acquire();
+        write_clip( *w );
+    }
+    report( "pooled writer", c, total, "file" );
+
+    return 0;
+}
+
+
+//
+// cache: warm ACESclipCache loads against parsing the XML
+//
+static int bench_cache( int argc, char** argv )
+{
+    if ( argc < 2 )
+    {
+        std::cerr << "cache <cache directory> <file.xml>... [-n iterations]"
+                  << std::endl;
+        return -1;
+    }
+
+    std::vector< const char* > files;
+    int iterations = 1000;
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+        else
+            files.push_back( argv[i] );
+    }
+
+    size_t total = files.size() * iterations;
+    std::cout << "cache: " << files.size() << " files x " << iterations
+              << " iterations" << std::endl;
+
+    ACES::ACESclipReader r;
+    Counters c;
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+            r.load( files[i] );
+    }
+    report( "tinyxml2 DOM  ", c, total, "file" );
+
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        for ( size_t i = 0; i < files.size(); ++i )
+            r.load_mapped( files[i] );
+    }
+    report( "mapped scan   ", c, total, "file" );
+
+    const char* names[] = { "cache time+size", "cache hash     " };
+    const ACES::ACESclipCache::Validation modes[] = {
+        ACES::ACESclipCache::kPathTimeSize,
+        ACES::ACESclipCache::kContentHash
+    };
+    for ( int m = 0; m < 2; ++m )
+    {
+        ACES::ACESclipCache cache( argv[0], modes[m] );
+        ACES::ACESclipMetadata metadata;
+
+        // Fill the cache, then time warm loads only
+        for ( size_t i = 0; i < files.size(); ++i )
+            cache.load( files[i], metadata );
+        cache.clear_counters();
+
+        c.reset();
+        for ( int n = 0; n < iterations; ++n )
+        {
+            for ( size_t i = 0; i < files.size(); ++i )
+                cache.load( files[i], metadata );
+        }
+        report( names[m], c, total, "file" );
+        std::cout << "    " << cache.hits() << " hits, " << cache.misses()
+                  << " misses" << std::endl;
+        for ( size_t i = 0; i < files.size(); ++i )
+            cache.remove( files[i] );
+    }
+
+    return 0;
+}
+
+
+//
+// catalog: ingest a synthetic show into ACESclipCatalog and time lookups
+//
+static int bench_catalog( int argc, char** argv )
+{
+    size_t count = 1000000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            count = atoi( argv[++i] );
+    }
+
+    std::cout << "catalog: " << count << " clips" << std::endl;
+
+    // 40 IDTs, 12 ODTs, 2 RRTs, 60 LMTs with 0 to 3 per clip, one media
+    // id per shot of 8 takes.
+    ACES::ACESclipCatalog catalog;
+    catalog.reserve( count );
+    ACES::ACESclipMetadata m;
+    char buf[256];
+    srand( 1 );
+
+    Counters c;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        snprintf( buf, sizeof(buf), "/shows/potc/seq%03d/sh%04d/take%d.xml",
+                  int( i / 8000 ), int( i / 8 % 1000 ), int( i % 8 ) );
+        std::string filename = buf;
+        snprintf( buf, sizeof(buf), "POTC-%03d-%04d", int( i / 8000 ),
+                  int( i / 8 % 1000 ) );
+        m.media_id = buf;
+        snprintf( buf, sizeof(buf), "take%d.exr", int( i % 8 ) );
+        m.clip_name = buf;
+        snprintf( buf, sizeof(buf), "IDT.Camera.%02d", rand() % 40 );
+        m.IDT.name = buf;
+        snprintf( buf, sizeof(buf), "ODT.Display.%02d", rand() % 12 );
+        m.ODT.name = buf;
+        m.RRT.name = ( rand() % 2 ) ? "RRT.a1.0.0" : "RRT.a1.0.3";
+        m.LMT.resize( rand() % 4 );
+        for ( size_t j = 0; j < m.LMT.size(); ++j )
+        {
+            snprintf( buf, sizeof(buf), "LMT.Look.%02d", rand() % 60 );
+            m.LMT[j].name = buf;
+        }
+        catalog.add( filename, m );
+    }
+    report( "add          ", c, count, "clip" );
+
+    c.reset();
+    catalog.index();
+    std::cout << "  index: " << c.seconds() * 1000 << " ms, "
+              << (double) catalog.memory() / count << " bytes per clip"
+              << std::endl;
+
+    const int queries = 10000;
+    std::vector< std::string > idts, lmts, media, prefixes;
+    for ( int i = 0; i < queries; ++i )
+    {
+        snprintf( buf, sizeof(buf), "IDT.Camera.%02d", i % 40 );
+        idts.push_back( buf );
+        snprintf( buf, sizeof(buf), "LMT.Look.%02d", i % 60 );
+        lmts.push_back( buf );
+        snprintf( buf, sizeof(buf), "POTC-%03d-%04d", i % 125, i % 1000 );
+        media.push_back( buf );
+        snprintf( buf, sizeof(buf), "POTC-%03d-00", i % 125 );
+        prefixes.push_back( buf );
+    }
+
+    size_t found = 0;
+    c.reset();
+    for ( int i = 0; i < queries; ++i )
+        found += catalog.with_IDT( idts[i] ).size();
+    report( "with_IDT     ", c, queries, "query" );
+
+    c.reset();
+    for ( int i = 0; i < queries; ++i )
+        found += catalog.with_LMT( lmts[i] ).size();
+    report( "with_LMT     ", c, queries, "query" );
+
+    c.reset();
+    for ( int i = 0; i < queries; ++i )
+        found += catalog.with_media_id( media[i] ).size();
+    report( "with_media_id", c, queries, "query" );
+
+    ACES::ACESclipCatalog::Clips clips;
+    c.reset();
+    for ( int i = 0; i < queries; ++i )
+    {
+        catalog.with_media_id_prefix( prefixes[i], clips );
+        found += clips.size();
+    }
+    report( "media prefix ", c, queries, "query" );
+
+    // Linear scan of the IDT column, for comparison
+    c.reset();
+    for ( int i = 0; i < 10; ++i )
+    {
+        for ( size_t j = 0; j < catalog.size(); ++j )
+            if ( idts[i] == catalog.IDT( ACES::ACESclipCatalog::ClipId( j ) ) )
+                ++found;
+    }
+    report( "IDT scan     ", c, 10, "query" );
+
+    std::cout << "  " << found << " clips found" << std::endl;
+    return 0;
+}
+
+
+//
+// write: ACESclipWriter (tinyxml2 DOM) against ACESclipStreamWriter
+//
+static bool read_file( const char* filename, std::string& s )
+{
+    FILE* f = fopen( filename, "rb" );
+    if ( !f ) return false;
+    char buf[4096];
+    size_t n;
+    s.clear();
+    while ( ( n = fread( buf, 1, sizeof(buf), f ) ) > 0 ) s.append( buf, n );
+    fclose( f );
+    return true;
+}
+
+// Blank the text of an element, for values that change on every run
+static void blank( std::string& s, const char* element )
+{
+    std::string open = std::string( "<" ) + element + ">";
+    std::string close = std::string( "</" ) + element + ">";
+    size_t a = s.find( open );
+    size_t b = s.find( close );
+    if ( a != std::string::npos && b != std::string::npos && b > a )
+        s.replace( a + open.size(), b - a - open.size(), "" );
+}
+
+static int bench_write( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "write <output.xml> [-n iterations]" << std::endl;
+        return -1;
+    }
+
+    const char* output = argv[0];
+    std::string stream_output = std::string( output ) + ".stream";
+    int iterations = 10000;
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+    }
+
+    std::cout << "write: " << iterations << " files" << std::endl;
+
+    Counters c;
+    for ( int n = 0; n < iterations; ++n )
+    {
+        ACES::ACESclipWriter w;
+        write_clip( w );
+        w.save( output );
+    }
+    report( "tinyxml2 DOM        ", c, iterations, "file" );
+
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        ACES::ACESclipStreamWriter w;
+        write_clip( w );
+        w.save( stream_output.c_str() );
+    }
+    report( "stream              ", c, iterations, "file" );
+
+    ACES::ACESclipStreamWriter w;
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        w.reset();
+        write_clip( w );
+        w.finish();
+    }
+    report( "stream, reset/memory", c, iterations, "file" );
+
+    // Both must write the same bytes, but for the UUID and the times
+    std::string a, b;
+    if ( !read_file( output, a ) || !read_file( stream_output.c_str(), b ) )
+    {
+        std::cerr << "Could not read back the output" << std::endl;
+        return -1;
+    }
+    blank( a, "UUID" );
+    blank( b, "UUID" );
+    blank( a, "ModificationTime" );
+    blank( b, "ModificationTime" );
+    blank( a, "ClipDate" );
+    blank( b, "ClipDate" );
+    blank( a, "Timestamp" );
+    blank( b, "Timestamp" );
+    if ( a != b )
+    {
+        std::cerr << "DOM and stream output differ:" << std::endl
+                  << a << std::endl << b << std::endl;
+        return -1;
+    }
+    std::cout << "  DOM and stream output are identical" << std::endl;
+    remove( stream_output.c_str() );
+
+    return 0;
+}
+
+
+//
+// template: sidecars of a show, one per clip, rebuilt with each writer
+// against stamped from an ACESclipTemplate
+//
+template< class Writer >
+static void write_shot( Writer& c, const char* clip_name, 
+                        const char* media_id, const ACES::ASC_CDL& cdl )
+{
+    c.info( "mrViewer", "v2.6.9" );
+    c.clip_id( clip_name, media_id );
+    c.config();
+
+    c.ITL_start();
+    c.gradeRef_start( "ACEScsc.ACES_to_ACEScct" );
+    c.gradeRef_SOPNode( cdl );
+    c.gradeRef_SatNode( cdl );
+    c.gradeRef_end( "ACEScsc.ACEScct_to_ACES" );
+    c.add_IDT( "IDT.ARRI.Alexa-v3-logC-EI800" );
+    c.ITL_end();
+
+    c.PTL_start();
+    c.add_LMT( "LMT.Show.Look.1.0.0" );
+    c.add_LMT( "LMT.Show.Film.1.0.0" );
+    c.add_RRT( "RRT.a1.0.0" );
+    c.add_ODT( "ODT.Academy.Rec709_100nits_dim.a1.0.0" );
+    c.PTL_end();
+}
+
+static int bench_template( int argc, char** argv )
+{
+    int clips = 100000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            clips = atoi( argv[++i] );
+    }
+
+    std::vector< std::string > names( clips ), media( clips );
+    std::vector< ACES::ASC_CDL > cdls( 16 );
+    char buf[64];
+    for ( int i = 0; i < clips; ++i )
+    {
+        snprintf( buf, sizeof(buf), "A%03dC%03d_%06d.exr", i / 1000 % 1000,
+                  i % 1000, i );
+        names[i] = buf;
+        snprintf( buf, sizeof(buf), "A%03d", i / 1000 % 1000 );
+        media[i] = buf;
+    }
+    for ( size_t i = 0; i < cdls.size(); ++i )
+    {
+        float f = i * 0.01f;
+        cdls[i].slope( 1.0f + f, 1.01f, 0.99f - f );
+        cdls[i].offset( -f, 0.0f, f );
+        cdls[i].saturation( 1.0f - f );
+    }
+
+    std::cout << "template: " << clips << " clips" << std::endl;
+
+    std::string out;
+    size_t bytes = 0;
+    Counters c;
+    for ( int i = 0; i < clips; ++i )
+    {
+        ACES::ACESclipWriter w;
+        write_shot( w, names[i].c_str(), media[i].c_str(), cdls[i % 16] );
+        w.save_to_string( out );
+        bytes += out.size();
+    }
+    report( "tinyxml2 DOM   ", c, clips, "file" );
+
+    ACES::ACESclipStreamWriter w;
+    c.reset();
+    for ( int i = 0; i < clips; ++i )
+    {
+        w.reset();
+        write_shot( w, names[i].c_str(), media[i].c_str(), cdls[i % 16] );
+        w.save_to_string( out );
+        bytes += out.size();
+    }
+    report( "stream, reset  ", c, clips, "file" );
+
+    ACES::ACESclipTemplate t;
+    write_shot( t, "", "", ACES::ASC_CDL() );
+    t.finish();
+
+    ACES::ACESclipTemplate::Clip clip;
+    c.reset();
+    for ( int i = 0; i < clips; ++i )
+    {
+        clip.clip_name = names[i].c_str();
+        clip.media_id = media[i].c_str();
+        clip.cdl = &cdls[i % 16];
+        t.stamp( clip, out );
+        bytes += out.size();
+    }
+    report( "template, stamp", c, clips, "file" );
+
+    // A stamped document must be the one the writers write
+    int bad = 0;
+    for ( int i = 0; i < clips; i += 997 )
+    {
+        clip.clip_name = names[i].c_str();
+        clip.media_id = media[i].c_str();
+        clip.cdl = &cdls[i % 16];
+        clip.clip_date = clip.xml_date = time(0);
+        t.stamp( clip, out );
+
+        ACES::ACESclipWriter d;
+        write_shot( d, names[i].c_str(), media[i].c_str(), cdls[i % 16] );
+        std::string expected;
+        d.save_to_string( expected );
+
+        const char* kChanging[] = { "UUID", "ModificationTime", "ClipDate",
+                                    "Timestamp" };
+        for ( size_t j = 0; j < 4; ++j )
+        {
+            blank( out, kChanging[j] );
+            blank( expected, kChanging[j] );
+        }
+        if ( out != expected && bad++ == 0 )
+            std::cerr << "Template and DOM output differ:" << std::endl
+                      << out << std::endl << expected << std::endl;
+    }
+    std::cout << "  " << bytes / 3 / clips << " bytes per file, "
+              << ( bad ? "output differs" : "same output as the DOM" ) 
+              << std::endl;
+
+    return bad == 0 ? 0 : -1;
+}
+
+
+//
+// commit: sidecars saved one by one, synced one by one, and through
+// ACESclipBatchWriter with and without syncs
+//
+static void commit_report( const char* name, 
+                           const ACES::ACESclipBatchWriter& b )
+{
+    const ACES::ACESclipBatchWriter::Stats& s = b.stats();
+    std::cout << "  " << name << ": " 
+              << ( s.seconds > 0 ? s.files / s.seconds : 0 ) << " file/s, "
+              << s.commits << " commits of " 
+              << ( s.commits ? s.seconds / s.commits * 1000 : 0 ) 
+              << " ms, slowest " << s.max_seconds * 1000 << " ms, "
+              << s.failed << " failed" << std::endl;
+}
+
+static int bench_commit( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "commit <directory> [-n files] [-g group size]" 
+                  << std::endl;
+        return -1;
+    }
+
+    std::string dir = argv[0];
+    int files = 2000;
+    size_t group = 256;
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            files = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-g" ) == 0 && i+1 < argc )
+            group = atoi( argv[++i] );
+    }
+
+    ACES::ACESclipTemplate t;
+    write_shot( t, "", "", ACES::ASC_CDL() );
+    t.finish();
+
+    std::vector< std::string > names( files );
+    for ( int i = 0; i < files; ++i )
+    {
+        char buf[64];
+        snprintf( buf, sizeof(buf), "/A001C%04d.xml", i );
+        names[i] = dir + buf;
+    }
+
+    std::cout << "commit: " << files << " files in " << dir 
+              << ", groups of " << group << std::endl;
+
+    ACES::ACESclipTemplate::Clip clip;
+    std::string doc;
+    Counters c;
+    for ( int i = 0; i < files; ++i )
+    {
+        clip.clip_name = names[i].c_str();
+        t.stamp_to_file( names[i].c_str(), clip );
+    }
+    report( "save in place ", c, files, "file" );
+
+#ifndef _WIN32
+    c.reset();
+    for ( int i = 0; i < files; ++i )
+    {
+        clip.clip_name = names[i].c_str();
+        t.stamp( clip, doc );
+        int fd = open( names[i].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 
+                       0666 );
+        if ( fd < 0 ) continue;
+        if ( write( fd, doc.data(), doc.size() ) < 0 ||
+             fsync( fd ) != 0 ) 
+            std::cerr << "Could not write " << names[i] << std::endl;
+        close( fd );
+    }
+    report( "fsync each    ", c, files, "file" );
+#endif
+
+    int failed = 0;
+    ACES::ACESclipBatchWriter::Durability modes[] = 
+    { ACES::ACESclipBatchWriter::kAtomic, ACES::ACESclipBatchWriter::kDurable };
+    const char* mode_names[] = { "batch, atomic ", "batch, durable" };
+    for ( int m = 0; m < 2; ++m )
+    {
+        ACES::ACESclipBatchWriter b( modes[m], group );
+        for ( int i = 0; i < files; ++i )
+        {
+            clip.clip_name = names[i].c_str();
+            t.stamp( clip, doc );
+            b.add( names[i], doc );
+        }
+        b.commit();
+        commit_report( mode_names[m], b );
+
+        const ACES::ACESclipBatchWriter::Results& r = b.results();
+        for ( size_t i = 0; i < r.size(); ++i )
+        {
+            if ( !r[i].ok && failed++ < 10 )
+                std::cerr << "  " << r[i].filename << ": " 
+                          << strerror( r[i].error ) << std::endl;
+        }
+    }
+
+    // What was committed last must read back
+    ACES::ACESclipReader reader;
+    for ( int i = 0; i < files; i += 97 )
+    {
+        if ( reader.load( names[i].c_str() ) != ACES::ACESclipReader::kAllOK ||
+             reader.clip_name != names[i] )
+        {
+            if ( failed++ < 10 )
+                std::cerr << "  " << names[i] << " did not read back" 
+                          << std::endl;
+        }
+    }
+
+    for ( int i = 0; i < files; ++i )
+        remove( names[i].c_str() );
+
+    return failed == 0 ? 0 : -1;
+}
+
+
+//
+// patch: regrade and retarget sidecars, reading each into a reader and
+// writing it again against ACESclipPatch
+//
+static void rewrite( const ACES::ACESclipReader& r, const ACES::ASC_CDL& cdl,
+                     const char* odt, ACES::ACESclipStreamWriter& w )
+{
+    w.reset();
+    w.info( r.application, r.version, r.comment );
+    w.clip_id( r.clip_name, r.media_id );
+    w.config();
+    w.ITL_start();
+    w.gradeRef_start( r.convert_to );
+    w.gradeRef_SOPNode( cdl );
+    w.gradeRef_SatNode( cdl );
+    w.gradeRef_end( r.convert_from );
+    w.add_IDT( r.IDT.name, r.IDT.status );
+    w.ITL_end( r.link_ITL );
+    w.PTL_start();
+    for ( size_t i = 0; i < r.LMT.size(); ++i )
+        w.add_LMT( r.LMT[i].name, r.LMT[i].status, r.LMT[i].link_transform );
+    w.add_RRT( r.RRT.name, r.RRT.status );
+    w.add_ODT( odt, r.ODT.status, r.ODT.link_transform );
+    w.PTL_end( r.link_PTL );
+}
+
+static int bench_patch( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "patch <directory> [-n files]" << std::endl;
+        return -1;
+    }
+
+    std::string dir = argv[0];
+    int files = 2000;
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            files = atoi( argv[++i] );
+    }
+
+    ACES::ACESclipTemplate t;
+    write_shot( t, "", "", ACES::ASC_CDL() );
+    t.finish();
+
+    std::vector< std::string > names( files );
+    ACES::ACESclipTemplate::Clip clip;
+    for ( int i = 0; i < files; ++i )
+    {
+        char buf[64];
+        snprintf( buf, sizeof(buf), "/A001C%04d.xml", i );
+        names[i] = dir + buf;
+        clip.clip_name = names[i].c_str();
+        t.stamp_to_file( names[i].c_str(), clip );
+    }
+
+    ACES::ASC_CDL cdl;
+    cdl.slope( 1.05f, 1.0f, 0.95f );
+    cdl.offset( 0.01f, 0.0f, -0.01f );
+    cdl.power( 1.1f, 1.1f, 1.1f );
+    cdl.saturation( 0.9f );
+    const char* odt = "ODT.Academy.P3D60_48nits.a1.0.3";
+
+    std::cout << "patch: " << files << " files in " << dir << std::endl;
+
+    ACES::ACESclipReader r;
+    ACES::ACESclipStreamWriter w;
+    Counters c;
+    for ( int i = 0; i < files; ++i )
+    {
+        if ( r.load_mapped( names[i].c_str() ) != ACES::ACESclipReader::kAllOK )
+            continue;
+        rewrite( r, cdl, odt, w );
+        w.save( names[i].c_str() );
+    }
+    report( "read and rewrite", c, files, "file" );
+
+#ifndef _WIN32
+    // Patched files must keep their permissions, and links stay links
+    for ( int i = 0; i < files; ++i )
+        chmod( names[i].c_str(), 0640 );
+    std::string link = dir + "/A001C_link.xml";
+    remove( link.c_str() );
+    bool linked = files > 0 && symlink( names[0].c_str(), link.c_str() ) == 0;
+#endif
+
+    ACES::ACESclipPatch p;
+    p.cdl( cdl );
+    p.ODT( odt );
+    int bad = 0;
+    c.reset();
+    for ( int i = 0; i < files; ++i )
+    {
+        if ( p.patch_file( names[i].c_str() ) != ACES::ACESclipReader::kAllOK )
+            ++bad;
+    }
+    report( "patch_file      ", c, files, "file" );
+
+#ifndef _WIN32
+    int modes = 0;
+    for ( int i = 0; i < files; ++i )
+    {
+        struct stat s;
+        if ( stat( names[i].c_str(), &s ) != 0 || 
+             ( s.st_mode & 07777 ) != 0640 )
+            ++modes;
+    }
+    bool link_kept = true;
+    if ( linked )
+    {
+        // Back to the original grade through the link
+        ACES::ACESclipPatch undo;
+        undo.cdl( ACES::ASC_CDL() );
+        struct stat s;
+        link_kept = undo.patch_file( link.c_str() ) == 
+                    ACES::ACESclipReader::kAllOK &&
+                    lstat( link.c_str(), &s ) == 0 && S_ISLNK( s.st_mode ) &&
+                    stat( names[0].c_str(), &s ) == 0 && 
+                    ( s.st_mode & 07777 ) == 0640;
+        p.patch_file( link.c_str() );
+        remove( link.c_str() );
+    }
+    std::cout << "  " << modes << " files changed permissions, symlink " 
+              << ( link_kept ? "kept" : "replaced" ) << std::endl;
+    if ( modes || !link_kept ) ++bad;
+#endif
+
+    // Patch back to the template's grade, and check the reader sees it
+    ACES::ASC_CDL identity;
+    p.cdl( identity );
+    std::string out;
+    size_t changed = 0;
+    c.reset();
+    for ( int i = 0; i < files; ++i )
+    {
+        if ( p.apply( names[i].c_str(), out, &changed ) != 
+             ACES::ACESclipReader::kAllOK || changed != 5 )
+            ++bad;
+    }
+    report( "apply to memory ", c, files, "file" );
+
+    if ( r.load( out.data(), out.size() ) != ACES::ACESclipReader::kAllOK ||
+         r.ODT.name != odt || r.sops.slope(0) != 1.0f || 
+         r.sops.saturation() != 1.0f )
+        ++bad;
+    std::cout << "  " << ( bad ? "patched files differ" : 
+                                 "patched files read back" ) << std::endl;
+
+    for ( int i = 0; i < files; ++i )
+        remove( names[i].c_str() );
+
+    return bad == 0 ? 0 : -1;
+}
+
+
+//
+// save: the output paths of both writers, file against string, buffer
+// and file descriptor
+//
+template< class Writer >
+static int save_paths( const char* name, Writer& w, const char* output,
+                       int iterations )
+{
+    std::string file, s;
+    w.save( output );
+    read_file( output, file );
+
+    std::cout << "  " << name << ":" << std::endl;
+
+    Counters c;
+    for ( int n = 0; n < iterations; ++n )
+        w.save( output );
+    report( "  save          ", c, iterations, "file" );
+
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+        w.save_to_string( s );
+    report( "  save_to_string", c, iterations, "file" );
+    bool ok = ( s == file );
+
+    std::vector< char > buf( w.save_to_buffer( NULL, 0 ) );
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+        w.save_to_buffer( &buf[0], buf.size() );
+    report( "  save_to_buffer", c, iterations, "file" );
+    ok = ok && std::string( &buf[0], buf.size() ) == file;
+
+    int fd = open( output, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ) return -1;
+    c.reset();
+    for ( int n = 0; n < iterations; ++n )
+    {
+        lseek( fd, 0, SEEK_SET );
+        w.save_to_fd( fd );
+    }
+    report( "  save_to_fd    ", c, iterations, "file" );
+    close( fd );
+    read_file( output, s );
+    ok = ok && s == file;
+
+    if ( !ok )
+    {
+        std::cerr << name << ": outputs differ from save()" << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+static int bench_save( int argc, char** argv )
+{
+    if ( argc < 1 )
+    {
+        std::cerr << "save <output.xml> [-n iterations]" << std::endl;
+        return -1;
+    }
+
+    int iterations = 10000;
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+    }
+
+    std::cout << "save: " << iterations << " files" << std::endl;
+
+    ACES::ACESclipWriter dom;
+    write_clip( dom );
+    if ( save_paths( "tinyxml2 DOM", dom, argv[0], iterations ) != 0 )
+        return -1;
+
+    ACES::ACESclipStreamWriter stream;
+    write_clip( stream );
+    if ( save_paths( "stream", stream, argv[0], iterations ) != 0 )
+        return -1;
+
+    std::cout << "  all outputs identical" << std::endl;
+    return 0;
+}
+
+
+//
+// uuid: UUIDs per second, a boost::uuids::random_generator per document
+// (when built with boost) against ACES::new_uuid(), and writers
+// constructed per second from one thread and from many
+//
+static double writers_per_second( unsigned threads, int iterations )
+{
+    std::vector< std::thread > workers;
+    Counters c;
+    for ( unsigned t = 0; t < threads; ++t )
+    {
+        workers.push_back( std::thread( [iterations]() {
+            for ( int n = 0; n < iterations; ++n )
+            {
+                ACES::ACESclipWriter w;
+            }
+        } ) );
+    }
+    for ( size_t t = 0; t < workers.size(); ++t )
+        workers[t].join();
+    double s = c.seconds();
+    return s > 0 ? threads * (double) iterations / s : 0;
+}
+
+static int bench_uuid( int argc, char** argv )
+{
+    int iterations = 20000;
+    unsigned max_threads = std::thread::hardware_concurrency();
+    if ( max_threads < 4 ) max_threads = 4;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-t" ) == 0 && i+1 < argc )
+            max_threads = atoi( argv[++i] );
+    }
+
+    std::cout << "uuid: " << iterations << " per thread" << std::endl;
+
+    char buf[37];
+    Counters c;
+#ifdef ACES_HAVE_BOOST
+    for ( int n = 0; n < iterations; ++n )
+    {
+        boost::uuids::uuid u = boost::uuids::random_generator()();
+        buf[0] = (char) u.data[0];
+    }
+    report( "boost generator per uuid", c, iterations, "uuid" );
+
+    c.reset();
+#endif
+    for ( int n = 0; n < iterations; ++n )
+        ACES::new_uuid( buf );
+    report( "ACES::new_uuid          ", c, iterations, "uuid" );
+
+    // Every UUID from several threads must be distinct and well formed.
+    std::vector< std::string > all( max_threads * iterations );
+    {
+        std::vector< std::thread > workers;
+        for ( unsigned t = 0; t < max_threads; ++t )
+        {
+            workers.push_back( std::thread( [&all, t, iterations]() {
+                char b[37];
+                for ( int n = 0; n < iterations; ++n )
+                {
+                    ACES::new_uuid( b );
+                    all[ t * iterations + n ] = b;
+                }
+            } ) );
+        }
+        for ( size_t t = 0; t < workers.size(); ++t )
+            workers[t].join();
+    }
+    std::sort( all.begin(), all.end() );
+    for ( size_t i = 0; i < all.size(); ++i )
+    {
+        const std::string& u = all[i];
+        if ( u.size() != 36 || u[8] != '-' || u[14] != '4' ||
+             strchr( "89ab", u[19] ) == NULL ||
+             ( i > 0 && u == all[i-1] ) )
+        {
+            std::cerr << "bad or repeated uuid " << u << std::endl;
+            return -1;
+        }
+    }
+    std::cout << "  " << all.size() << " uuids from " << max_threads
+              << " threads, all distinct" << std::endl;
+
+    double single = 0;
+    for ( unsigned threads = 1; ; threads *= 2 )
+    {
+        if ( threads > max_threads ) threads = max_threads;
+        double rate = writers_per_second( threads, iterations );
+        if ( threads == 1 ) single = rate;
+        std::cout << "  ACESclipWriter, " << threads << " threads: "
+                  << rate << " writers/s, speedup "
+                  << ( single > 0 ? rate / single : 0 ) << std::endl;
+        if ( threads == max_threads ) break;
+    }
+
+    return 0;
+}
+
+
+//
+// format: CDL numbers written per second, printf's %g against
+// ACES::format_float, and the round trip through format_float and
+// parse_float, alone and through the writer and the reader
+//
+static int bench_format( int argc, char** argv )
+{
+    size_t count = 1000000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            count = atoi( argv[++i] );
+    }
+
+    // Half CDL-like values, half any finite float
+    std::vector< float > values( count );
+    srand( 1 );
+    for ( size_t i = 0; i < count; ++i )
+    {
+        if ( i % 2 )
+        {
+            values[i] = rand() / (float) RAND_MAX * 4.0f - 2.0f;
+            continue;
+        }
+        unsigned bits;
+        do 
+        {
+            bits = ( unsigned( rand() ) << 16 ) ^ unsigned( rand() );
+        } while ( ( bits & 0x7f800000 ) == 0x7f800000 );
+        memcpy( &values[i], &bits, sizeof(bits) );
+    }
+
+    std::cout << "format: " << count << " floats" << std::endl;
+
+    char buf[64];
+    size_t chars = 0;
+    Counters c;
+    for ( size_t i = 0; i < count; ++i )
+        chars += sprintf( buf, "%g", values[i] );
+    report( "%g          ", c, count, "float" );
+
+    c.reset();
+    for ( size_t i = 0; i < count; ++i )
+        chars += ACES::format_float( values[i], buf ) - buf;
+    report( "format_float", c, count, "float" );
+
+    // format_float must read back exactly, %g rarely does
+    size_t lossy = 0, bad = 0;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        float r;
+        sprintf( buf, "%g", values[i] );
+        if ( ACES::to_float( buf ) != values[i] ) ++lossy;
+
+        char* e = ACES::format_float( values[i], buf );
+        if ( ACES::parse_float( buf, e, r ) != e || 
+             memcmp( &r, &values[i], sizeof(r) ) != 0 )
+        {
+            if ( bad++ < 10 )
+                std::cerr << "  " << values[i] << " written as " << buf
+                          << std::endl;
+        }
+    }
+    std::cout << "  %g lost " << lossy << ", format_float lost " << bad
+              << std::endl;
+
+    // A grade must survive the writer and the reader bit for bit
+    size_t grades = count / 100;
+    ACES::ACESclipStreamWriter w;
+    ACES::ACESclipReader r;
+    for ( size_t i = 0; i + 10 <= count && i / 10 < grades; i += 10 )
+    {
+        ACES::ASC_CDL cdl;
+        cdl.slope( values[i+1], values[i+2], values[i+3] );
+        cdl.offset( values[i+4], values[i+5], values[i+6] );
+        cdl.power( values[i+7], values[i+8], values[i+9] );
+        cdl.saturation( values[i] );
+
+        w.reset();
+        w.info( "ACESclipBench", "1.0" );
+        w.clip_id( "clip", "media" );
+        w.config();
+        w.ITL_start();
+        w.gradeRef_start( "ACEScsc.ACES_to_ACEScct" );
+        w.gradeRef_SOPNode( cdl );
+        w.gradeRef_SatNode( cdl );
+        w.gradeRef_end( "ACEScsc.ACEScct_to_ACES" );
+        w.ITL_end();
+        w.PTL_start();
+        w.add_RRT( "RRT.a1.0.0" );
+        w.add_ODT( "ODT.RGB.Monitor" );
+        w.PTL_end();
+        w.finish();
+
+        bool same = r.load( w.data(), w.size() ) == ACES::ACESclipReader::kAllOK;
+        float a = r.sops.saturation(), b = cdl.saturation();
+        same = same && memcmp( &a, &b, sizeof(a) ) == 0;
+        for ( unsigned short j = 0; j < 3; ++j )
+        {
+            float x[3] = { r.sops.slope(j), r.sops.offset(j), r.sops.power(j) };
+            float y[3] = { cdl.slope(j), cdl.offset(j), cdl.power(j) };
+            same = same && memcmp( x, y, sizeof(x) ) == 0;
+        }
+        if ( !same )
+        {
+            if ( bad++ < 10 )
+                std::cerr << "  grade " << i / 10 << " changed" << std::endl;
+        }
+    }
+    std::cout << "  " << grades << " grades written and read back" 
+              << std::endl;
+
+    return bad == 0 && chars > 0 ? 0 : -1;
+}
+
+
+//
+// cdl: pixels/sec of CDLProcessor with each instruction set, RGB and
+// RGBA, and its largest error against CDLProcessor::reference() on
+// random CDLs and pixels, including NaN and infinities
+//
+static float random_float( float lo, float hi )
+{
+    return lo + ( hi - lo ) * ( rand() / (float) RAND_MAX );
+}
+
+static int bench_cdl( int argc, char** argv )
+{
+    size_t pixels = 3840 * 2160;
+    int grades = 1000;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-g" ) == 0 && i+1 < argc )
+            grades = atoi( argv[++i] );
+    }
+
+    std::cout << "cdl: " << pixels << " pixels, best instruction set "
+              << ACES::simd_name( ACES::simd_level() ) << std::endl;
+
+    // Pixels over and under 0..1, so the clamp is exercised
+    const size_t test = 1021;
+    std::vector< float > in( test * 4 ), out( test * 4 );
+    srand( 1 );
+    for ( size_t i = 0; i < in.size(); ++i )
+        in[i] = random_float( -0.5f, 1.5f );
+    in[0] = std::numeric_limits<float>::quiet_NaN();
+    in[4] = std::numeric_limits<float>::infinity();
+    in[5] = -std::numeric_limits<float>::infinity();
+
+    std::vector< ACES::ASC_CDL > cdls( grades );
+    for ( int i = 0; i < grades; ++i )
+    {
+        ACES::ASC_CDL& c = cdls[i];
+        c.slope( random_float( 0, 4 ), random_float( 0, 4 ), 
+                 random_float( 0, 4 ) );
+        c.offset( random_float( -1, 1 ), random_float( -1, 1 ), 
+                  random_float( -1, 1 ) );
+        c.power( random_float( 0.01f, 8 ), random_float( 0.01f, 8 ), 
+                 random_float( 0.01f, 8 ) );
+        c.saturation( random_float( 0, 4 ) );
+    }
+    if ( grades > 0 ) cdls[0].power( 0, 1, 2 );
+
+    std::vector< float > frame( pixels * 4, 0.18f );
+    int failed = 0;
+    ACES::SIMDLevel best = ACES::simd_level();
+    for ( int l = ACES::kSIMDScalar; l <= best; ++l )
+    {
+        ACES::CDLProcessor p;
+        p.simd( (ACES::SIMDLevel) l );
+        if ( p.simd() != l ) continue;
+
+        // Worst error at each precision, in units of the documented 
+        // tolerance
+        double worst[ACES::kCDLPrecisions] = { 0 };
+        for ( int g = 0; g < grades; ++g )
+        {
+            const ACES::ASC_CDL& c = cdls[g];
+            p.cdl( c );
+            for ( int q = 0; q < ACES::kCDLPrecisions; ++q )
+            {
+                ACES::CDLPrecision precision = (ACES::CDLPrecision) q;
+                p.apply( &in[0], &out[0], test, 4, precision );
+
+                double sat = fabs( c.saturation() );
+                double tol = 2.5e-7 * ( 1.0 + sat );
+                if ( precision > ACES::kCDLPrecise )
+                    tol += ACES::cdl_pow_error( precision ) * 
+                           ( 1.0 + 2.0 * sat );
+                for ( size_t i = 0; i < test; ++i )
+                {
+                    float r[3];
+                    ACES::CDLProcessor::reference( c, &in[i*4], r );
+                    for ( unsigned k = 0; k < 3; ++k )
+                    {
+                        double e = fabs( (double) out[i*4+k] - r[k] ) / tol;
+                        if ( !( e <= worst[q] ) ) worst[q] = e;
+                    }
+                    if ( memcmp( &out[i*4+3], &in[i*4+3], 
+                                 sizeof(float) ) != 0 )
+                        worst[q] = std::numeric_limits<double>::infinity();
+                }
+            }
+        }
+
+        ACES::ASC_CDL c;
+        c.slope( 1.1f, 0.95f, 0.9f );
+        c.offset( 0.01f, 0.0f, -0.01f );
+        c.power( 1.2f, 1.0f, 0.9f );
+        c.saturation( 0.8f );
+        p.cdl( c );
+
+        std::string name = ACES::simd_name( p.simd() );
+        name.resize( 7, ' ' );
+
+        Counters rgb;
+        p.apply( &frame[0], pixels, 3 );
+        report( ( name + "RGB " ).c_str(), rgb, pixels, "pixel" );
+
+        Counters rgba;
+        p.apply( &frame[0], pixels, 4 );
+        report( ( name + "RGBA" ).c_str(), rgba, pixels, "pixel" );
+
+        static const char* precisions[] = { "exact", "precise", "fast", 
+                                            "fastest" };
+        for ( int q = 0; q < ACES::kCDLPrecisions; ++q )
+        {
+            std::cout << "  " << name << "error " << worst[q] 
+                      << " of the tolerance, " << precisions[q] 
+                      << std::endl;
+            if ( !( worst[q] <= 1.0 ) ) ++failed;
+        }
+    }
+
+    return failed ? -1 : 0;
+}
+
+
+//
+// frames: CDLExecutor frames/sec on 4K and 8K RGBA float frames, from
+// 1 thread to all cores, checked against one CDLProcessor::apply()
+//
+static int bench_frames( int argc, char** argv )
+{
+    int iterations = 10;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            iterations = atoi( argv[++i] );
+    }
+
+    unsigned cores = std::thread::hardware_concurrency();
+    if ( cores == 0 ) cores = 1;
+
+    ACES::ASC_CDL cdl;
+    cdl.slope( 1.1f, 0.95f, 0.9f );
+    cdl.offset( 0.01f, 0.0f, -0.01f );
+    cdl.power( 1.2f, 1.0f, 0.9f );
+    cdl.saturation( 0.8f );
+    ACES::CDLProcessor p( cdl );
+
+    std::cout << "frames: " << iterations << " iterations, " 
+              << ACES::simd_name( p.simd() ) << std::endl;
+
+    const size_t sizes[2][2] = { { 3840, 2160 }, { 7680, 4320 } };
+    int failed = 0;
+    for ( int s = 0; s < 2; ++s )
+    {
+        size_t width = sizes[s][0], height = sizes[s][1];
+        size_t pixels = width * height;
+        std::vector< float > in( pixels * 4 ), out( pixels * 4 ), 
+                             expected( pixels * 4 );
+        srand( 1 );
+        for ( size_t i = 0; i < in.size(); ++i )
+            in[i] = rand() / (float) RAND_MAX;
+        p.apply( &in[0], &expected[0], pixels, 4 );
+
+        ACES::CDLFrame frame( &in[0], &out[0], width, height, 4 );
+
+        double single = 0;
+        for ( unsigned threads = 1; ; threads *= 2 )
+        {
+            if ( threads > cores ) threads = cores;
+
+            ACES::ThreadPool pool( threads );
+            ACES::CDLExecutor executor( p, &pool );
+
+            // Waiting on the future keeps the calling thread out of it
+            Counters c;
+            for ( int n = 0; n < iterations; ++n )
+                executor.apply_async( frame ).get();
+            double secs = c.seconds();
+            double rate = secs > 0 ? iterations / secs : 0;
+            if ( threads == 1 ) single = rate;
+
+            std::cout << "  " << width << "x" << height << ", " << threads 
+                      << " threads: " << rate << " frames/s, " 
+                      << rate * pixels / 1e6 << " Mpixels/s, speedup "
+                      << ( single > 0 ? rate / single : 0 ) << std::endl;
+
+            if ( memcmp( &out[0], &expected[0], 
+                         out.size() * sizeof(float) ) != 0 )
+            {
+                std::cerr << "  frame differs from CDLProcessor::apply()"
+                          << std::endl;
+                ++failed;
+            }
+
+            if ( threads == cores ) break;
+        }
+
+        // The synchronous call, in place, on the global pool
+        out = in;
+        ACES::CDLExecutor executor( p );
+        executor.apply( ACES::CDLFrame( &out[0], &out[0], width, height, 
+                                        4 ) );
+        if ( memcmp( &out[0], &expected[0], 
+                     out.size() * sizeof(float) ) != 0 )
+        {
+            std::cerr << "  apply() in place differs" << std::endl;
+            ++failed;
+        }
+    }
+
+    return failed ? -1 : 0;
+}
+
+
+//
+// paths: CDLProcessor pixels/sec with the kernel specialized for CDLs
+// without offset, power or saturation, against the full kernel, and
+// their error against CDLProcessor::reference()
+//
+static int bench_paths( int argc, char** argv )
+{
+    size_t pixels = 3840 * 2160;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+    }
+
+    // A preset is classified when compiling
+    constexpr ACES::CDLPreset kWarm( 1.1f, 1.0f, 0.9f,  0, 0, 0,  
+                                     1, 1, 1,  1 );
+    static_assert( kWarm.paths() == ( ACES::kCDLNoOffset | 
+                                      ACES::kCDLNoPower |
+                                      ACES::kCDLNoSaturation ), 
+                   "kWarm only has a slope" );
+
+    std::cout << "paths: " << pixels << " RGB pixels, " 
+              << ACES::simd_name( ACES::simd_level() ) << std::endl;
+
+    std::vector< float > in( pixels * 3 ), out( pixels * 3 );
+    srand( 1 );
+    for ( size_t i = 0; i < in.size(); ++i )
+        in[i] = rand() / (float) RAND_MAX * 1.2f - 0.1f;
+
+    int failed = 0;
+    for ( unsigned paths = 0; paths < ACES::kCDLPaths; ++paths )
+    {
+        ACES::ASC_CDL cdl;
+        cdl.slope( 1.1f, 0.95f, 0.9f );
+        if ( !( paths & ACES::kCDLNoOffset ) )
+            cdl.offset( 0.01f, 0.0f, -0.01f );
+        if ( !( paths & ACES::kCDLNoPower ) )
+            cdl.power( 1.2f, 1.0f, 0.9f );
+        if ( !( paths & ACES::kCDLNoSaturation ) )
+            cdl.saturation( 0.8f );
+
+        ACES::CDLProcessor p( cdl );
+        if ( p.paths() != paths ) ++failed;
+
+        char name[64];
+        sprintf( name, "%-9s %-8s %-11s specialized", 
+                 paths & ACES::kCDLNoOffset ? "no offset" : "offset",
+                 paths & ACES::kCDLNoPower ? "no power" : "power",
+                 paths & ACES::kCDLNoSaturation ? "no sat" : "saturation" );
+        Counters c;
+        p.apply( &in[0], &out[0], pixels );
+        report( name, c, pixels, "pixel" );
+
+        double worst = 0, tol = 2.5e-7 * ( 1.0 + fabs( cdl.saturation() ) );
+        for ( size_t i = 0; i < pixels; i += 13 )
+        {
+            float r[3];
+            ACES::CDLProcessor::reference( cdl, &in[i*3], r );
+            for ( unsigned k = 0; k < 3; ++k )
+                worst = std::max( worst, fabs( (double) out[i*3+k] - r[k] ) );
+        }
+        if ( !( worst <= tol ) )
+        {
+            std::cerr << "  error " << worst << std::endl;
+            ++failed;
+        }
+
+        sprintf( name, "%-9s %-8s %-11s full       ", "", "", "" );
+        p.specialize( false );
+        c.reset();
+        p.apply( &in[0], &out[0], pixels );
+        report( name, c, pixels, "pixel" );
+    }
+
+    return failed ? -1 : 0;
+}
+
+
+//
+// lut: CDLLut bake time, pixels/sec on each instruction set and largest
+// error against CDLProcessor for 1D and 3D tables, and CDLLutCache
+// lookups/sec for many clips sharing a few grades.  Fails if an
+// instruction set gives other results than the scalar code.
+//
+static int bench_lut( int argc, char** argv )
+{
+    size_t pixels = 1920 * 1080;
+    size_t clips = 100000;
+    size_t grades = 50;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-c" ) == 0 && i+1 < argc )
+            clips = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-g" ) == 0 && i+1 < argc )
+            grades = atoi( argv[++i] );
+    }
+    if ( grades == 0 ) grades = 1;
+
+    ACES::ASC_CDL cdl;
+    cdl.slope( 1.1f, 0.95f, 0.9f );
+    cdl.offset( 0.01f, 0.0f, -0.01f );
+    cdl.power( 1.2f, 1.0f, 0.9f );
+    cdl.saturation( 0.8f );
+    ACES::CDLProcessor p( cdl );
+
+    std::cout << "lut: " << pixels << " RGB pixels, "
+              << ACES::simd_name( ACES::simd_level() ) << std::endl;
+
+    std::vector< float > in( pixels * 3 ), out( pixels * 3 ), 
+                         expected( pixels * 3 ), scalar( pixels * 3 );
+    srand( 1 );
+    for ( size_t i = 0; i < in.size(); ++i )
+        in[i] = rand() / (float) RAND_MAX;
+
+    // A few pixels off the table, for its clamps
+    const float edges[] = { -1.0f, 0.0f, 1.0f, 2.0f, NAN, INFINITY };
+    for ( size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i )
+        if ( i < in.size() ) in[i] = edges[i];
+
+    Counters c;
+    p.apply( &in[0], &expected[0], pixels, 3, ACES::kCDLPrecise );
+    c.reset();
+    p.apply( &in[0], &expected[0], pixels, 3, ACES::kCDLPrecise );
+    double cdl_seconds = c.seconds();
+    report( "CDLProcessor", c, pixels, "pixel" );
+
+    const ACES::CDLLut::Shape shapes[] = {
+    ACES::CDLLut::Shape( ACES::CDLLut::k1D, 1024 ),
+    ACES::CDLLut::Shape( ACES::CDLLut::k1D, 4096 ),
+    ACES::CDLLut::Shape( ACES::CDLLut::k3D, 17 ),
+    ACES::CDLLut::Shape( ACES::CDLLut::k3D, 33 ),
+    ACES::CDLLut::Shape( ACES::CDLLut::k3D, 65 ),
+    };
+    int failed = 0;
+    ACES::SIMDLevel best = ACES::simd_level();
+    for ( size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s )
+    {
+        const char* type = shapes[s].type == ACES::CDLLut::k1D ? "1D" : "3D";
+
+        c.reset();
+        ACES::CDLLut lut( cdl, shapes[s] );
+        double bake = c.seconds();
+
+        // Every instruction set must give the scalar results, bit for bit
+        double seconds = 0;
+        for ( int l = ACES::kSIMDScalar; l <= best; ++l )
+        {
+            lut.simd( (ACES::SIMDLevel) l );
+            if ( lut.simd() != l ) continue;
+
+            char name[32];
+            sprintf( name, "%s %-4u %-7s", type, shapes[s].size,
+                     ACES::simd_name( lut.simd() ) );
+
+            c.reset();
+            lut.apply( &in[0], &out[0], pixels );
+            seconds = c.seconds();
+            report( name, c, pixels, "pixel" );
+
+            if ( l == ACES::kSIMDScalar )
+                scalar = out;
+            else if ( memcmp( &out[0], &scalar[0], 
+                              out.size() * sizeof(float) ) != 0 )
+            {
+                std::cout << "    FAILED: differs from Scalar" << std::endl;
+                ++failed;
+            }
+        }
+
+        // Error on the table; the edges are clamped to it
+        double worst = 0;
+        for ( size_t i = sizeof(edges) / sizeof(edges[0]); i < out.size(); 
+              ++i )
+            worst = std::max( worst, fabs( (double) out[i] - expected[i] ) );
+        std::cout << "    baked in " << bake * 1000 << " ms, " 
+                  << lut.bytes() / 1024 << " KB, max error " << worst 
+                  << ", " << ( seconds > 0 ? cdl_seconds / seconds : 0 )
+                  << "x CDLProcessor" << std::endl;
+    }
+
+    // Many clips, few grades: all but the first clip of a grade hit
+    std::vector< ACES::ASC_CDL > looks( grades );
+    for ( size_t g = 0; g < grades; ++g )
+    {
+        float k = 1.0f + g * 0.01f;
+        looks[g].slope( k, 1.0f, 2.0f - k );
+        looks[g].power( 1.0f, k, 1.0f );
+    }
+
+    ACES::CDLLutCache cache( grades );
+    c.reset();
+    size_t bytes = 0;
+    for ( size_t i = 0; i < clips; ++i )
+        bytes += cache.get( looks[i % grades] )->bytes();
+    report( "CDLLutCache::get", c, clips, "clip" );
+    std::cout << "    " << cache.hits() << " hits, " << cache.misses() 
+              << " misses, " << cache.size() << " tables" << std::endl;
+
+    bool ok = cache.misses() == std::min( clips, grades ) && bytes > 0;
+    return ok && !failed ? 0 : -1;
+}
+
+
+//
+// depth: CDLBitDepthProcessor pixels/sec reading and writing 10i, 12i,
+// 16i and 16f pixels directly, against converting the frame to float,
+// applying CDLProcessor and converting it back
+//
+static int bench_depth( int argc, char** argv )
+{
+    typedef ACES::ACESclipMetadata M;
+    typedef ACES::CDLBitDepthProcessor Depth;
+
+    size_t pixels = 3840 * 2160;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+    }
+
+    ACES::ASC_CDL cdl;
+    cdl.slope( 1.1f, 0.95f, 0.9f );
+    cdl.offset( 0.01f, 0.0f, -0.01f );
+    cdl.power( 1.2f, 1.0f, 0.9f );
+    cdl.saturation( 0.8f );
+
+    std::cout << "depth: " << pixels << " RGB pixels" << std::endl;
+
+    static const char* names[] = { "10i", "12i", "16i", "16f", "32f" };
+    static const M::BitDepth pairs[][2] = {
+    { M::k10i, M::k10i }, { M::k12i, M::k12i }, { M::k16i, M::k16i },
+    { M::k16f, M::k16f }, { M::k10i, M::k16f }, { M::k16f, M::k10i },
+    { M::k16f, M::k32f }, { M::k32f, M::k16f },
+    };
+
+    // Pixels from 0 to 1, so converting through identity CDLs loses
+    // nothing but precision
+    std::vector< float > source( pixels * 3 ), frame( pixels * 3 );
+    srand( 1 );
+    for ( size_t i = 0; i < source.size(); ++i )
+        source[i] = rand() / (float) RAND_MAX;
+
+    int failed = 0;
+    for ( size_t p = 0; p < sizeof(pairs) / sizeof(pairs[0]); ++p )
+    {
+        M::BitDepth in_depth = pairs[p][0], out_depth = pairs[p][1];
+        size_t in_size = Depth::sample_size( in_depth );
+        size_t out_size = Depth::sample_size( out_depth );
+
+        std::vector< char > in( source.size() * in_size ), 
+                            out( source.size() * out_size ),
+                            expected( source.size() * out_size );
+        Depth( ACES::ASC_CDL(), M::k32f, in_depth ).apply( &source[0], 
+                                                           &in[0], pixels );
+
+        char name[32];
+        sprintf( name, "%s to %s, fused     ", names[in_depth], 
+                 names[out_depth] );
+        Counters c;
+        Depth( cdl, in_depth, out_depth ).apply( &in[0], &out[0], pixels );
+        report( name, c, pixels, "pixel" );
+
+        sprintf( name, "%s to %s, round trip", names[in_depth], 
+                 names[out_depth] );
+        c.reset();
+        Depth unpack( ACES::ASC_CDL(), in_depth, M::k32f );
+        Depth pack( ACES::ASC_CDL(), M::k32f, out_depth );
+        unpack.apply( &in[0], &frame[0], pixels );
+        ACES::CDLProcessor( cdl ).apply( &frame[0], pixels );
+        pack.apply( &frame[0], &expected[0], pixels );
+        report( name, c, pixels, "pixel" );
+
+        // Integer codes and halfs may round the other way, by one
+        size_t differ = 0;
+        for ( size_t i = 0; i < source.size(); ++i )
+        {
+            long a, b;
+            if ( out_size == 2 )
+            {
+                unsigned short x, y;
+                memcpy( &x, &out[i * 2], 2 );
+                memcpy( &y, &expected[i * 2], 2 );
+                a = x;  b = y;
+            }
+            else
+            {
+                float x, y;
+                memcpy( &x, &out[i * 4], 4 );
+                memcpy( &y, &expected[i * 4], 4 );
+                a = lround( x * 1e6f );  b = lround( y * 1e6f );
+            }
+            if ( labs( a - b ) > 1 ) ++differ;
+        }
+        if ( differ )
+        {
+            std::cerr << "  " << differ << " samples differ" << std::endl;
+            ++failed;
+        }
+    }
+
+    return failed ? -1 : 0;
+}
+
+
+//
+// pow: error of the power of CDLProcessor at each CDLPrecision, over
+// every float from 0 to 1 (or every step-th), against pow() in double,
+// and values/sec of each
+//
+static double ulp_of( double r )
+{
+    // Spacing of floats around r; 0 and subnormals have the smallest
+    if ( r < 1.17549435e-38 ) return 1.40129846e-45;
+    int e;
+    frexp( r, &e );
+    return ldexp( 1.0, e - 24 );
+}
+
+static int bench_pow( int argc, char** argv )
+{
+    unsigned step = 1;
+    std::vector< float > powers;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-s" ) == 0 && i+1 < argc )
+            step = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-p" ) == 0 && i+1 < argc )
+            powers.push_back( (float) atof( argv[++i] ) );
+    }
+    if ( step == 0 ) step = 1;
+    if ( powers.empty() )
+    {
+        powers.push_back( 1 / 2.2f );
+        powers.push_back( 1.2f );
+        powers.push_back( 2.2f );
+    }
+
+    static const char* names[] = { "exact", "precise", "fast", "fastest" };
+
+    // Bit patterns of the floats from 0 to 1
+    const unsigned one = 0x3f800000;
+    const size_t block = 4096;
+    std::cout << "pow: " << one / step + 1 << " floats from 0 to 1, " 
+              << ACES::simd_name( ACES::simd_level() ) << std::endl;
+
+    std::vector< float > x( block * 3 ), y( block * 3 );
+    std::vector< double > ref( block * 3 );
+    int failed = 0;
+    for ( size_t k = 0; k < powers.size(); ++k )
+    {
+        ACES::ASC_CDL cdl;
+        cdl.power( powers[k], powers[k], powers[k] );
+        ACES::CDLProcessor p( cdl );
+
+        double abs_err[ACES::kCDLPrecisions] = { 0 };
+        double rel_err[ACES::kCDLPrecisions] = { 0 };
+        double ulps[ACES::kCDLPrecisions] = { 0 };
+        double seconds[ACES::kCDLPrecisions] = { 0 };
+
+        unsigned long long bits = 0, count = 0;
+        while ( bits <= one )
+        {
+            size_t n = 0;
+            for ( ; n < block * 3 && bits <= one; ++n, bits += step )
+            {
+                unsigned u = (unsigned) bits;
+                memcpy( &x[n], &u, sizeof(float) );
+                ref[n] = pow( (double) x[n], (double) powers[k] );
+            }
+            count += n;
+
+            // The planes split the values in three
+            size_t third = ( n + 2 ) / 3;
+            for ( size_t i = n; i < third * 3; ++i ) x[i] = 0.0f;
+            for ( int q = 0; q < ACES::kCDLPrecisions; ++q )
+            {
+                y = x;
+                Counters c;
+                p.apply_planes( &y[0], &y[third], &y[third * 2], third,
+                                (ACES::CDLPrecision) q );
+                seconds[q] += c.seconds();
+
+                for ( size_t i = 0; i < n; ++i )
+                {
+                    double e = fabs( y[i] - ref[i] );
+                    if ( !( e <= abs_err[q] ) ) abs_err[q] = e;
+                    if ( ref[i] >= 1.17549435e-38 )
+                        rel_err[q] = std::max( rel_err[q], e / ref[i] );
+                    ulps[q] = std::max( ulps[q], e / ulp_of( ref[i] ) );
+                }
+            }
+        }
+
+        std::cout << "  power " << powers[k] << std::endl;
+        for ( int q = 0; q < ACES::kCDLPrecisions; ++q )
+        {
+            double bound = ACES::cdl_pow_error( (ACES::CDLPrecision) q );
+            char line[256];
+            snprintf( line, sizeof(line), "    %-8s %9.3g values/s, "
+                      "error %.3g (bound %.3g), relative %.3g, %.3g ulps",
+                      names[q], seconds[q] > 0 ? count / seconds[q] : 0,
+                      abs_err[q], bound, rel_err[q], ulps[q] );
+            std::cout << line << std::endl;
+            if ( !( abs_err[q] <= bound ) ) ++failed;
+        }
+    }
+
+    return failed ? -1 : 0;
+}
+
+//
+// invert: CDLInverse pixels/sec against CDLProcessor, and how well the
+// inverse undoes it: the largest error of inverse( forward( x ) ) as a
+// fraction of the range a channel keeps, and whether exactly the
+// clamped channels are flagged
+//
+static int bench_invert( int argc, char** argv )
+{
+    size_t pixels = 3840 * 2160;
+    int grades = 200;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-g" ) == 0 && i+1 < argc )
+            grades = atoi( argv[++i] );
+    }
+
+    std::cout << "invert: " << pixels << " RGB pixels, " << grades 
+              << " grades" << std::endl;
+
+    std::vector< ACES::ASC_CDL > cdls( grades );
+    srand( 1 );
+    for ( int i = 0; i < grades; ++i )
+    {
+        ACES::ASC_CDL& c = cdls[i];
+        c.slope( random_float( 0.5f, 2 ), random_float( 0.5f, 2 ), 
+                 random_float( 0.5f, 2 ) );
+        c.offset( random_float( -0.1f, 0.1f ), random_float( -0.1f, 0.1f ), 
+                  random_float( -0.1f, 0.1f ) );
+        c.power( random_float( 0.5f, 2 ), random_float( 0.5f, 2 ), 
+                 random_float( 0.5f, 2 ) );
+        c.saturation( random_float( 0.5f, 1.5f ) );
+    }
+
+    // Values from below to above the range of each channel; those
+    // within 2% of its ends are not checked, as the power squeezes
+    // them together
+    const size_t test = 4096;
+    const double margin = 0.02;
+    std::vector< float > in( test * 3 ), graded( test * 3 ), 
+                         back( test * 3 );
+    std::vector< unsigned char > flags( test );
+    std::vector< float > frame( pixels * 3, 0.18f );
+
+    int failed = 0;
+    ACES::SIMDLevel best = ACES::simd_level();
+    for ( int l = ACES::kSIMDScalar; l <= best; ++l )
+    {
+        ACES::CDLProcessor forward;
+        ACES::CDLInverse inverse;
+        forward.simd( (ACES::SIMDLevel) l );
+        inverse.simd( (ACES::SIMDLevel) l );
+        if ( inverse.simd() != l ) continue;
+
+        double worst = 0;
+        size_t missed = 0, wrong = 0;
+        for ( int g = 0; g < grades; ++g )
+        {
+            forward.cdl( cdls[g] );
+            inverse.cdl( cdls[g] );
+
+            float low[3], high[3];
+            for ( unsigned short k = 0; k < 3; ++k )
+            {
+                inverse.range( k, low[k], high[k] );
+                float width = high[k] - low[k];
+                for ( size_t i = 0; i < test; ++i )
+                    in[i*3+k] = random_float( low[k] - 0.2f * width,
+                                              high[k] + 0.2f * width );
+            }
+
+            forward.apply( &in[0], &graded[0], test );
+            size_t clamped = inverse.apply( &graded[0], &back[0], test, 3,
+                                            &flags[0] );
+
+            size_t flagged = 0;
+            for ( size_t i = 0; i < test; ++i )
+            {
+                flagged += flags[i] != 0;
+                for ( unsigned k = 0; k < 3; ++k )
+                {
+                    double width = high[k] - low[k];
+                    double t = ( in[i*3+k] - low[k] ) / width;
+                    // The slope may be negative, so either end is 0
+                    bool out_low  = in[i*3+k] < low[k];
+                    bool out_high = in[i*3+k] > high[k];
+                    unsigned bits = flags[i] >> k & ACES::kCDLLowR; 
+                    bits |= flags[i] >> ( k + 3 ) & ACES::kCDLLowR;
+                    if ( out_low || out_high )
+                    {
+                        if ( !bits ) ++missed;
+                    }
+                    else if ( t > margin && t < 1 - margin )
+                    {
+                        if ( bits ) ++wrong;
+                        double e = fabs( (double) back[i*3+k] - in[i*3+k] ) /
+                                   width;
+                        if ( !( e <= worst ) ) worst = e;
+                    }
+                }
+            }
+            if ( flagged != clamped ) ++wrong;
+        }
+
+        std::string name = ACES::simd_name( inverse.simd() );
+        name.resize( 7, ' ' );
+
+        ACES::ASC_CDL c;
+        c.slope( 1.1f, 0.95f, 0.9f );
+        c.offset( 0.01f, 0.0f, -0.01f );
+        c.power( 1.2f, 1.0f, 0.9f );
+        c.saturation( 0.8f );
+        forward.cdl( c );
+        inverse.cdl( c );
+
+        Counters fc;
+        forward.apply( &frame[0], pixels );
+        report( ( name + "forward" ).c_str(), fc, pixels, "pixel" );
+
+        Counters ic;
+        inverse.apply( &frame[0], pixels );
+        report( ( name + "inverse" ).c_str(), ic, pixels, "pixel" );
+
+        std::cout << "  " << name << "error " << worst 
+                  << " of the range, " << missed << " clamped values "
+                  << "missed, " << wrong << " flagged wrongly" << std::endl;
+        if ( !( worst <= 1e-5 ) || missed || wrong ) ++failed;
+    }
+
+    return failed ? -1 : 0;
+}
+
+//
+// workspace: CDLWorkSpaceProcessor pixels/sec grading ACES pixels in
+// ACEScc and ACEScct in one pass, against converting the frame,
+// applying CDLProcessor and converting it back in three, and its error
+// against CDLWorkSpaceProcessor::reference()
+//
+static int bench_workspace( int argc, char** argv )
+{
+    typedef ACES::CDLWorkSpaceProcessor Processor;
+
+    size_t pixels = 3840 * 2160;
+    int grades = 100;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-g" ) == 0 && i+1 < argc )
+            grades = atoi( argv[++i] );
+    }
+
+    int failed = 0;
+
+    // TransformIDs as ACESclipReader finds them in GradeRefs
+    static const struct
+    {
+        const char*     id;
+        ACES::WorkSpace from, to;
+    } ids[] = {
+    { "ACEScsc.ACES_to_ACEScct", ACES::kWorkSpaceACES, 
+      ACES::kWorkSpaceACEScct },
+    { "ACEScsc.ACEScc_to_ACES.a1.0.3", ACES::kWorkSpaceACEScc, 
+      ACES::kWorkSpaceACES },
+    { "urn:ampas:aces:transformId:v1.5:ACEScsc.Academy.ACEScct_to_ACES.a1.0.3",
+      ACES::kWorkSpaceACEScct, ACES::kWorkSpaceACES },
+    { "ACEScsc.ACES_to_ACEScg", ACES::kWorkSpaceACES, 
+      ACES::kWorkSpaceACEScg },
+    { "ACEScsc.ACES_to_ACESproxy10i", ACES::kWorkSpaceACES, 
+      ACES::kWorkSpaceUnknown },
+    { "IDT.ARRI.Alexa-v3-logC-EI800", ACES::kWorkSpaceUnknown, 
+      ACES::kWorkSpaceUnknown },
+    };
+    for ( size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); ++i )
+    {
+        ACES::WorkSpace from, to;
+        ACES::workspace_conversion( ids[i].id, from, to );
+        if ( from != ids[i].from || to != ids[i].to )
+        {
+            std::cerr << "  " << ids[i].id << " read as " 
+                      << ACES::workspace_name( from ) << " to " 
+                      << ACES::workspace_name( to ) << std::endl;
+            ++failed;
+        }
+    }
+
+    std::cout << "workspace: " << pixels << " RGB pixels, " 
+              << ACES::simd_name( ACES::simd_level() ) << std::endl;
+
+    // Scene linear values, with some at 0 and below
+    std::vector< float > frame( pixels * 3 ), fused( pixels * 3 ), 
+                         passes( pixels * 3 );
+    srand( 1 );
+    for ( size_t i = 0; i < frame.size(); ++i )
+        frame[i] = random_float( -0.01f, 1.0f ) * random_float( 0, 16 );
+
+    std::vector< ACES::ASC_CDL > cdls( grades );
+    for ( int i = 0; i < grades; ++i )
+    {
+        ACES::ASC_CDL& c = cdls[i];
+        c.slope( random_float( 0.8f, 1.2f ), random_float( 0.8f, 1.2f ), 
+                 random_float( 0.8f, 1.2f ) );
+        c.offset( random_float( -0.05f, 0.05f ), 
+                  random_float( -0.05f, 0.05f ), 
+                  random_float( -0.05f, 0.05f ) );
+        c.power( random_float( 0.8f, 1.2f ), random_float( 0.8f, 1.2f ), 
+                 random_float( 0.8f, 1.2f ) );
+        c.saturation( random_float( 0.7f, 1.3f ) );
+    }
+
+    static const ACES::WorkSpace spaces[] = { ACES::kWorkSpaceACEScc,
+                                              ACES::kWorkSpaceACEScct };
+    for ( unsigned s = 0; s < 2; ++s )
+    {
+        ACES::WorkSpace space = spaces[s];
+        std::string name = ACES::workspace_name( space );
+        name.resize( 8, ' ' );
+
+        // Worst error relative to the largest channel of the pixel, or
+        // to 2^-10 below it, as the matrices mix the channels
+        const size_t test = std::min( pixels, (size_t) 4096 );
+        double worst = 0;
+        ACES::SIMDLevel best = ACES::simd_level();
+        for ( int l = ACES::kSIMDScalar; l <= best; ++l )
+        {
+            Processor p;
+            p.simd( (ACES::SIMDLevel) l );
+            if ( p.simd() != l ) continue;
+            for ( int g = 0; g < grades; ++g )
+            {
+                p.set( cdls[g], ACES::kWorkSpaceACES, space, 
+                       ACES::kWorkSpaceACES );
+                p.apply( &frame[0], &fused[0], test );
+                for ( size_t i = 0; i < test; ++i )
+                {
+                    float r[3];
+                    Processor::reference( cdls[g], ACES::kWorkSpaceACES,
+                                          space, ACES::kWorkSpaceACES,
+                                          &frame[i*3], r );
+                    double scale = 1.0 / 1024;
+                    for ( unsigned k = 0; k < 3; ++k )
+                        scale = std::max( scale, fabs( (double) r[k] ) );
+                    for ( unsigned k = 0; k < 3; ++k )
+                    {
+                        double e = fabs( (double) fused[i*3+k] - r[k] ) /
+                                   scale;
+                        if ( !( e <= worst ) ) worst = e;
+                    }
+                }
+            }
+        }
+
+        const ACES::ASC_CDL& cdl = cdls[0];
+        Processor p( cdl, space );
+        Counters c;
+        p.apply( &frame[0], &fused[0], pixels );
+        report( ( name + "one pass   " ).c_str(), c, pixels, "pixel" );
+
+        ACES::CDLProcessor forward( cdl );
+        c.reset();
+        ACES::convert_workspace( &frame[0], &passes[0], pixels, 3,
+                                 ACES::kWorkSpaceACES, space );
+        forward.apply( &passes[0], pixels );
+        ACES::convert_workspace( &passes[0], &passes[0], pixels, 3, space,
+                                 ACES::kWorkSpaceACES );
+        report( ( name + "three passes" ).c_str(), c, pixels, "pixel" );
+
+        bool same = memcmp( &fused[0], &passes[0], 
+                            pixels * 3 * sizeof(float) ) == 0;
+        std::cout << "  " << name << "error " << worst << ", passes "
+                  << ( same ? "identical" : "differ" ) << std::endl;
+        if ( !( worst <= 2e-5 ) || !same ) ++failed;
+    }
+
+    return failed ? -1 : 0;
+}
+
+//
+// luma: CDLProcessor pixels/sec with the saturation weights of each
+// CDLLuma, built into the kernels and read at run time, their error
+// against CDLProcessor::reference(), and CDLInverse undoing each
+//
+static int bench_luma( int argc, char** argv )
+{
+    size_t pixels = 3840 * 2160;
+    int grades = 200;
+    for ( int i = 0; i < argc; ++i )
+    {
+        if ( strcmp( argv[i], "-n" ) == 0 && i+1 < argc )
+            pixels = atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-g" ) == 0 && i+1 < argc )
+            grades = atoi( argv[++i] );
+    }
+
+    std::cout << "luma: " << pixels << " RGB pixels, " 
+              << ACES::simd_name( ACES::simd_level() ) << std::endl;
+
+    const size_t test = 1021;
+    std::vector< float > in( test * 3 ), built( test * 3 ), 
+                         runtime( test * 3 );
+    srand( 1 );
+    for ( size_t i = 0; i < in.size(); ++i )
+        in[i] = random_float( -0.5f, 1.5f );
+
+    std::vector< ACES::ASC_CDL > cdls( grades );
+    for ( int i = 0; i < grades; ++i )
+    {
+        ACES::ASC_CDL& c = cdls[i];
+        c.slope( random_float( 0, 4 ), random_float( 0, 4 ), 
+                 random_float( 0, 4 ) );
+        c.offset( random_float( -1, 1 ), random_float( -1, 1 ), 
+                  random_float( -1, 1 ) );
+        c.power( random_float( 0.01f, 8 ), random_float( 0.01f, 8 ), 
+                 random_float( 0.01f, 8 ) );
+        c.saturation( random_float( 0, 4 ) );
+    }
+
+    // Inside 0..1 after a saturation of 1.3, so nothing is clamped
+    std::vector< float > plate( test * 3 ), graded( test * 3 );
+    for ( size_t i = 0; i < plate.size(); ++i )
+        plate[i] = random_float( 0.3f, 0.7f );
+    ACES::ASC_CDL sat;
+    sat.saturation( 1.3f );
+
+    // The weights of NTSC, and ones that sum to 0.9, whose luma the
+    // saturation does not keep
+    static const float ntsc[3] = { 0.3f, 0.59f, 0.11f };
+    static const float scaled[3] = { 0.25f, 0.5f, 0.15f };
+    static const struct
+    {
+        const char*   name;
+        ACES::CDLLuma luma;
+        const float*  custom;
+    } lumas[] = {
+    { "rec709", ACES::kCDLLumaRec709, NULL },
+    { "ap0   ", ACES::kCDLLumaAP0, NULL },
+    { "ap1   ", ACES::kCDLLumaAP1, NULL },
+    { "custom", ACES::kCDLLumaCustom, ntsc },
+    { "scaled", ACES::kCDLLumaCustom, scaled },
+    };
+
+    std::vector< float > frame( pixels * 3 );
+    for ( size_t i = 0; i < frame.size(); ++i )
+        frame[i] = random_float( 0, 1 );
+
+    int failed = 0;
+    ACES::SIMDLevel best = ACES::simd_level();
+    for ( unsigned n = 0; n < sizeof(lumas) / sizeof(lumas[0]); ++n )
+    {
+        const float* w = lumas[n].custom ? lumas[n].custom :
+                         ACES::cdl_luma_weights( lumas[n].luma );
+
+        // The same weights, built in and read at run time
+        ACES::CDLProcessor p, q;
+        if ( lumas[n].luma == ACES::kCDLLumaCustom )
+            p.luma( w[0], w[1], w[2] );
+        else
+            p.luma( lumas[n].luma );
+        q.luma( w[0], w[1], w[2] );
+
+        // Worst error in units of the documented tolerance, over
+        // every instruction set
+        double worst = 0;
+        bool same = true;
+        for ( int l = ACES::kSIMDScalar; l <= best; ++l )
+        {
+            p.simd( (ACES::SIMDLevel) l );
+            q.simd( (ACES::SIMDLevel) l );
+            if ( p.simd() != l ) continue;
+            for ( int g = 0; g < grades; ++g )
+            {
+                const ACES::ASC_CDL& c = cdls[g];
+                p.cdl( c );
+                q.cdl( c );
+                p.apply( &in[0], &built[0], test );
+                q.apply( &in[0], &runtime[0], test );
+                same = same && memcmp( &built[0], &runtime[0], 
+                                       built.size() * sizeof(float) ) == 0;
+
+                double tol = 2.5e-7 * ( 1.0 + fabs( c.saturation() ) );
+                for ( size_t i = 0; i < test; ++i )
+                {
+                    float r[3];
+                    ACES::CDLProcessor::reference( c, &in[i*3], r, w );
+                    for ( unsigned k = 0; k < 3; ++k )
+                    {
+                        double e = fabs( (double) built[i*3+k] - r[k] ) / 
+                                   tol;
+                        if ( !( e <= worst ) ) worst = e;
+                    }
+                }
+            }
+        }
+
+        // A saturation undone with the same weights
+        p.simd( best );
+        p.cdl( sat );
+        p.apply( &plate[0], &graded[0], test );
+        ACES::CDLInverse inverse( sat );
+        if ( lumas[n].luma == ACES::kCDLLumaCustom )
+            inverse.luma( w[0], w[1], w[2] );
+        else
+            inverse.luma( lumas[n].luma );
+        size_t clamped = inverse.apply( &graded[0], test );
+        double back = 0;
+        for ( size_t i = 0; i < plate.size(); ++i )
+            back = std::max( back, fabs( (double) graded[i] - plate[i] ) );
+
+        ACES::ASC_CDL c;
+        c.slope( 1.1f, 0.95f, 0.9f );
+        c.offset( 0.01f, 0.0f, -0.01f );
+        c.power( 1.2f, 1.0f, 0.9f );
+        c.saturation( 0.8f );
+        p.cdl( c );
+        q.cdl( c );
+        q.simd( best );
+
+        std::string name = lumas[n].name;
+        if ( lumas[n].luma != ACES::kCDLLumaCustom )
+        {
+            Counters k;
+            p.apply( &frame[0], pixels );
+            report( ( name + " built in" ).c_str(), k, pixels, "pixel" );
+        }
+        Counters r;
+        q.apply( &frame[0], pixels );
+        report( ( name + " run time" ).c_str(), r, pixels, "pixel" );
+
+        std::cout << "  " << name << " error " << worst 
+                  << " of the tolerance, built in and run time " 
+                  << ( same ? "identical" : "differ" ) 
+                  << ", inverse within " << back << ", " << clamped
+                  << " clamped" << std::endl;
+        if ( !( worst <= 1.0 ) || !same || !( back <= 1e-6 ) || clamped )
+            ++failed;
+    }
+
+    return failed ? -1 : 0;
+}
+
+
+struct Benchmark
+{
+    const char* name;
+    int (*run)( int argc, char** argv );
+    const char* help;
+};
+
+static const Benchmark kBenchmarks[] =
+{
+{ "load", bench_load, "reader files/sec and allocations, DOM vs mapped" },
+{ "probe", bench_probe, "reader files/sec, all sections vs ClipID + ITL" },
+{ "batch", bench_batch, "ACESclipBatch files/sec from 1 thread to all cores" },
+{ "parse_V3", bench_parse_V3, "Slope/Offset/Power triplets/sec, strtod vs parse_V3" },
+{ "reuse", bench_reuse, "reader/writer allocations, new per file vs ObjectPool" },
+{ "cache", bench_cache, "warm ACESclipCache loads/sec vs parsing the XML" },
+{ "catalog", bench_catalog, "ACESclipCatalog memory per clip and lookups/sec" },
+{ "write", bench_write, "files/sec, ACESclipWriter DOM vs ACESclipStreamWriter" },
+{ "template", bench_template, "sidecars/sec, a writer per clip vs ACESclipTemplate" },
+{ "commit", bench_commit, "sidecars saved/sec, in place vs ACESclipBatchWriter groups" },
+{ "patch", bench_patch, "files regraded/sec, reader + writer vs ACESclipPatch" },
+{ "save", bench_save, "writer output to a file, string, buffer and file descriptor" },
+{ "cdl", bench_cdl, "pixels/sec and error of CDLProcessor by instruction set" },
+{ "frames", bench_frames, "CDLExecutor 4K and 8K frames/sec from 1 thread to all cores" },
+{ "paths", bench_paths, "CDLProcessor pixels/sec, kernels without offset/power/saturation" },
+{ "lut", bench_lut, "CDLLut pixels/sec per SIMD level and error, and CDLLutCache hits" },
+{ "depth", bench_depth, "CDL on 10i/12i/16i/16f pixels/sec, fused vs float round trip" },
+{ "pow", bench_pow, "CDL power error over all floats 0..1 and speed by precision" },
+{ "invert", bench_invert, "CDLInverse pixels/sec and error of inverse( CDL( x ) )" },
+{ "workspace", bench_workspace, "CDL in ACEScc/ACEScct pixels/sec, one pass vs three" },
+{ "luma", bench_luma, "CDLProcessor pixels/sec and error with each CDLLuma" },
+{ "format", bench_format, "CDL floats written/sec, %g vs format_float, round trip" },
+{ "uuid", bench_uuid, "uuids/sec and ACESclipWriter constructions/sec by threads" },
+};
+
+int main( int argc, char** argv )
+{
+    size_t num = sizeof(kBenchmarks) / sizeof(Benchmark);
+    if ( argc >= 2 )
+    {
+        for ( size_t i = 0; i < num; ++i )
+        {
+            if ( strcmp( argv[1], kBenchmarks[i].name ) == 0 )
+                return kBenchmarks[i].run( argc - 2, argv + 2 );
+        }
+    }
+
+    std::cerr << argv[0] << " <mode> [arguments]" << std::endl
+              << std::endl
+              << "Modes:" << std::endl;
+    for ( size_t i = 0; i < num; ++i )
+        std::cerr << "  " << kBenchmarks[i].name << "\t"
+                  << kBenchmarks[i].help << std::endl;
+    return -1;
+}
@@ -0,0 +1,134 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLBitDepth_h
+#define ACESCDLBitDepth_h
+
+#include <stddef.h>
+
+#include "ACESCDLLut.h"
+#include "ACESCDLProcessor.h"
+#include "ACESclipMetadata.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * CDLBitDepthProcessor:  applies an ASC_CDL to pixels stored at the
+ * inBitDepth and outBitDepth of its GradeRef, without converting the
+ * whole image to float first.
+ *
+ * Samples of 10i, 12i and 16i images are unsigned 16 bit codes, from 0
+ * to 1023, 4095 and 65535, which stand for 0 to 1 as in CLF.  16f
+ * samples are IEEE halfs in 16 bits, and 32f samples are floats.
+ * Pixels are interleaved RGB or RGBA; alpha is converted to the
+ * output depth.
+ *
+ * Integer input looks the slope, offset, clamp and power of each code
+ * up in a table baked once per CDL, then applies the saturation.
+ * Float and half input are converted and run through the CDLProcessor
+ * kernels.  Either way the pixels go through a few hundred at a time
+ * in buffers that stay in the cache.  Integer output is rounded to the
+ * nearest code and clamped to its range.
+ *
+ * A processor is immutable while applying, so one can be shared by
+ * several threads.
+ */
+class ACES_EXPORT CDLBitDepthProcessor
+{
+  public:
+    typedef ACESclipMetadata::BitDepth BitDepth;
+
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param cdl        CDL to apply
+     * @param in_depth   depth of the pixels read
+     * @param out_depth  depth of the pixels written
+     */
+    CDLBitDepthProcessor( const ASC_CDL& cdl = ASC_CDL(),
+                          BitDepth in_depth = ACESclipMetadata::k32f,
+                          BitDepth out_depth = ACESclipMetadata::k32f );
+
+    /** 
+     * Constructor.  Takes the CDL and the depths of a GradeRef, as read
+     * by ACESclipReader; depths it did not find are taken as 32f.
+     */
+    explicit CDLBitDepthProcessor( const ACESclipMetadata& m );
+
+    /** 
+     * Change the CDL and the depths.
+     */
+    void set( const ASC_CDL& cdl, BitDepth in_depth, BitDepth out_depth );
+
+    const ASC_CDL& cdl() const { return _processor.cdl(); }
+    BitDepth in_depth() const  { return _in; }
+    BitDepth out_depth() const { return _out; }
+
+    /** 
+     * Weigh the luma of the saturation, as CDLProcessor::luma().
+     */
+    void luma( CDLLuma l ) { _processor.luma( l ); }
+    void luma( float r, float g, float b ) { _processor.luma( r, g, b ); }
+    CDLLuma luma() const { return _processor.luma(); }
+
+    /** 
+     * Apply the CDL.  in and out may be the same buffer if both depths
+     * have samples of the same size.
+     * 
+     * @param in        pixels to read, at in_depth()
+     * @param out       pixels to write, at out_depth()
+     * @param pixels    number of pixels
+     * @param channels  3 for RGB or 4 for RGBA
+     */
+    void apply( const void* in, void* out, size_t pixels,
+                unsigned channels = 3 ) const;
+
+    /** 
+     * @return bytes per sample of a depth: 2, or 4 for 32f.
+     */
+    static size_t sample_size( BitDepth d );
+
+    /** 
+     * @return the largest code of an integer depth, 1 for 16f and 32f.
+     */
+    static unsigned max_code( BitDepth d );
+
+  protected:
+    CDLProcessor _processor;
+    CDLLut       _codes;     ///< curve per code, for integer input
+    BitDepth     _in;
+    BitDepth     _out;
+};
+
+}  // namespace ACES
+
+#endif  // ACESCDLBitDepth_h
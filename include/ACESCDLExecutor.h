@@ -0,0 +1,145 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLExecutor_h
+#define ACESCDLExecutor_h
+
+#include <stddef.h>
+#include <functional>
+#include <future>
+
+#include "ACESCDLProcessor.h"
+#include "ACESThreadPool.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * A frame of interleaved float pixels, RGB or RGBA.  in and out may be
+ * the same.
+ */
+struct CDLFrame
+{
+    CDLFrame() : 
+    in( NULL ), out( NULL ), width( 0 ), height( 0 ), channels( 3 ),
+    in_stride( 0 ), out_stride( 0 ), precision( kCDLPrecise )
+    {
+    }
+
+    CDLFrame( const float* i, float* o, size_t w, size_t h, 
+              unsigned c = 3 ) : 
+    in( i ), out( o ), width( w ), height( h ), channels( c ),
+    in_stride( 0 ), out_stride( 0 ), precision( kCDLPrecise )
+    {
+    }
+
+    const float* in;
+    float*       out;
+    size_t       width;
+    size_t       height;
+    unsigned     channels;     ///< 3 or 4
+    size_t       in_stride;    ///< floats per row of in, 0 if packed
+    size_t       out_stride;   ///< floats per row of out, 0 if packed
+    CDLPrecision precision;    ///< of the power, kCDLPrecise by default
+};
+
+/**
+ * CDLExecutor:  applies a CDLProcessor to whole frames on a ThreadPool.
+ *
+ * A frame is cut into bands of whole rows, about band_bytes() of
+ * pixels each, so a band read and written stays in the cache of the
+ * core working on it.  The bands are queued on the pool, whose workers
+ * steal them from each other until the frame is done.
+ *
+ * apply() returns when the frame is done, and the calling thread works
+ * on it meanwhile.  apply_async() returns at once; the frame is
+ * finished when the future is ready or the callback is called, on the
+ * pool thread that did the last band.  Its buffers must stay alive
+ * until then.  The executor keeps a copy of the processor for each
+ * frame, so it may be changed while frames are in flight.
+ */
+class ACES_EXPORT CDLExecutor
+{
+  public:
+    typedef std::function< void() > Callback;
+
+    /** 
+     * Constructor
+     * 
+     * @param p     processor with the CDL to apply
+     * @param pool  pool to run on.  NULL uses ThreadPool::global().
+     */
+    CDLExecutor( const CDLProcessor& p = CDLProcessor(), 
+                 ThreadPool* pool = NULL );
+
+    /** 
+     * Change the processor, and with it the CDL.
+     */
+    void processor( const CDLProcessor& p ) { _processor = p; }
+    const CDLProcessor& processor() const { return _processor; }
+
+    /** 
+     * Bytes of pixels per band, 256 KB by default.  A band is at least
+     * one row.
+     */
+    void band_bytes( size_t bytes ) { _band_bytes = bytes; }
+    size_t band_bytes() const { return _band_bytes; }
+
+    /** 
+     * Rows per band for a frame.
+     */
+    size_t band_rows( const CDLFrame& f ) const;
+
+    /** 
+     * Apply the CDL to a frame and wait for it.
+     */
+    void apply( const CDLFrame& f ) const;
+
+    /** 
+     * Start applying the CDL to a frame.
+     * 
+     * @return a future that becomes ready when the frame is done.
+     */
+    std::future< void > apply_async( const CDLFrame& f ) const;
+
+    /** 
+     * Start applying the CDL to a frame, and call done when it is.
+     */
+    void apply_async( const CDLFrame& f, const Callback& done ) const;
+
+  protected:
+    CDLProcessor _processor;
+    ThreadPool*  _pool;
+    size_t       _band_bytes;
+};
+
+}  // namespace ACES
+
+#endif  // ACESCDLExecutor_h
@@ -0,0 +1,181 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLInverse_h
+#define ACESCDLInverse_h
+
+#include <stddef.h>
+
+#include "ACESCDLProcessor.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * Channels of a pixel that came out of a CDL's clamp, as
+ * CDLInverse::apply() reports them.  Any value the CDL clamped to 0
+ * (or 1) gives the same output, so their inverse is only a bound.
+ */
+enum CDLClamp
+{
+kCDLLowR  = 1 << 0,
+kCDLLowG  = 1 << 1,
+kCDLLowB  = 1 << 2,
+kCDLHighR = 1 << 3,
+kCDLHighG = 1 << 4,
+kCDLHighB = 1 << 5,
+kCDLLow   = kCDLLowR | kCDLLowG | kCDLLowB,      ///< clamped at 0
+kCDLHigh  = kCDLHighR | kCDLHighG | kCDLHighB    ///< clamped at 1
+};
+
+/**
+ * Parts of a CDL no inverse can undo, for any pixel.
+ */
+enum CDLSingular
+{
+kCDLZeroSlope      = 1 << 0,   ///< a channel comes out constant
+kCDLZeroPower      = 1 << 1,   ///< a channel comes out 1
+kCDLZeroSaturation = 1 << 2,   ///< only the luma is left
+kCDLZeroLuma       = 1 << 3    ///< the luma comes out 0
+};
+
+/**
+ * CDLInverse:  undoes an ASC_CDL, as the Convert_from_WorkSpace side
+ * of a GradeRef needs to un-grade a plate.
+ *
+ * For each pixel, in the reverse order of CDLProcessor:
+ *
+ *     luma = ( 0.2126 in.r + 0.7152 in.g + 0.0722 in.b ) / gain
+ *     v    = luma + ( in - luma ) / saturation
+ *     out  = ( clamp( v, 0, 1 ) ^ ( 1 / power ) - offset ) / slope
+ *
+ * The saturation multiplies the luma by gain = W + saturation ( 1 - W ),
+ * W the sum of the weights, so undoing it needs no other value.  The
+ * known weights sum to 1 and keep the luma; custom ones may not.  The
+ * weights must be those of the CDL undone (see luma()).
+ * The reciprocals are taken once per CDL, and the kernels are those of
+ * CDLProcessor run backwards, with the same instruction sets, CDLPath
+ * specializations and CDLPrecision.
+ *
+ * The clamp loses everything outside the range() of each channel.
+ * apply() counts the pixels that came out of it and can flag their
+ * channels with CDLClamp bits.  The parts of a CDL that lose whole
+ * channels are in singular(), and are left out of the inverse: zero
+ * slopes give 0, a zero power, zero saturation and a zero gain are
+ * taken as 1.
+ *
+ * An inverse is immutable while applying, so one can be shared by
+ * several threads.
+ */
+class ACES_EXPORT CDLInverse
+{
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param cdl  the CDL to undo
+     */
+    explicit CDLInverse( const ASC_CDL& cdl = ASC_CDL() );
+
+    /** 
+     * Change the CDL.
+     */
+    void cdl( const ASC_CDL& c );
+    const ASC_CDL& cdl() const { return _cdl; }
+
+    /** 
+     * Use the kernels of another instruction set, for testing.
+     */
+    void simd( SIMDLevel level );
+    SIMDLevel simd() const { return _level; }
+
+    /** 
+     * Weigh the luma as the CDLProcessor that applied the CDL did.
+     */
+    void luma( CDLLuma l );
+    void luma( float r, float g, float b );
+    CDLLuma luma() const { return _luma; }
+    const float* luma_weights() const { return _weights; }
+
+    /** 
+     * CDLSingular bits of the CDL, 0 if it can be undone away from
+     * its clamp.
+     */
+    unsigned singular() const { return _singular; }
+    bool invertible() const { return _singular == 0; }
+
+    /** 
+     * Inputs of a channel the CDL does not clamp, which its inverse
+     * gives back.
+     * 
+     * @return false if the slope of the channel is 0
+     */
+    bool range( unsigned short channel, float& low, float& high ) const;
+
+    /** 
+     * Undo the CDL.  in and out may be the same buffer.
+     * 
+     * @param in         pixels graded by the CDL
+     * @param out        pixels to write
+     * @param pixels     number of pixels
+     * @param channels   3 for RGB or 4 for RGBA
+     * @param flags      NULL, or one byte per pixel for its CDLClamp 
+     *                   bits
+     * @param precision  of the power
+     * 
+     * @return number of pixels the CDL clamped
+     */
+    size_t apply( const float* in, float* out, size_t pixels,
+                  unsigned channels = 3, unsigned char* flags = NULL,
+                  CDLPrecision precision = kCDLPrecise ) const;
+
+    /** 
+     * Undo the CDL in place.
+     */
+    size_t apply( float* pixels, size_t count, unsigned channels = 3,
+                  unsigned char* flags = NULL,
+                  CDLPrecision precision = kCDLPrecise ) const
+    {
+        return apply( pixels, pixels, count, channels, flags, precision );
+    }
+
+  protected:
+    ASC_CDL           _cdl;
+    SIMDLevel         _level;
+    const CDLKernels* _kernels;
+    unsigned          _paths;
+    unsigned          _singular;
+    CDLLuma           _luma;
+    float             _weights[3];
+};
+
+}  // namespace ACES
+
+#endif  // ACESCDLInverse_h
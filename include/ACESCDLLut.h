@@ -0,0 +1,235 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLLut_h
+#define ACESCDLLut_h
+
+#include <stddef.h>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ACESCDLProcessor.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * CDLLut:  an ASC_CDL baked into a lookup table.
+ *
+ * A 1D LUT holds the slope, offset, clamp and power of each channel as
+ * a curve; apply() interpolates the curves linearly and then applies
+ * the saturation as CDLProcessor does, with the luma of the shape.  It
+ * is exact up to the interpolation of the curves.  A 3D LUT holds the
+ * whole CDL, including saturation, on a lattice, and apply()
+ * interpolates it tetrahedrally.
+ *
+ * The tables cover inputs from low to high on each channel; inputs
+ * outside are clamped to it first, NaN to low.  Curves with a power
+ * below 1 bend sharply near 0 and need more points there than a
+ * lattice of 33 has.
+ *
+ * apply() runs on the best instruction set the CPU has, like
+ * CDLProcessor, gathering the points of the table with AVX2 and
+ * AVX-512.  All instruction sets give the same results.  A 1D table
+ * skips the pow() of the power and applies faster than the CDL itself;
+ * a 3D table applies about as fast up to 33 points, and slower once
+ * its lattice no longer fits the cache.
+ */
+class ACES_EXPORT CDLLut
+{
+  public:
+    enum Type
+    {
+    k1D,     ///< a curve per channel, then saturation
+    k3D      ///< the whole CDL on a size x size x size lattice
+    };
+
+    /**
+     * Type, size and input range of a table, and the luma weights of
+     * its saturation.  A size of 0 picks 4096 for k1D and 33 for k3D.
+     * high must be above low.  Only the known CDLLumas can be baked;
+     * kCDLLumaCustom is taken as Rec.709.
+     */
+    struct Shape
+    {
+        Shape( Type t = k3D, unsigned s = 0, float lo = 0.0f, 
+               float hi = 1.0f, CDLLuma l = kCDLLumaRec709 ) :
+        type( t ), size( s ), low( lo ), high( hi ), luma( l )
+        {
+        }
+
+        bool operator==( const Shape& b ) const
+        {
+            return type == b.type && size == b.size && low == b.low &&
+                   high == b.high && luma == b.luma;
+        }
+
+        Type     type;
+        unsigned size;   ///< points per channel
+        float    low;    ///< input of the first point
+        float    high;   ///< input of the last point
+        CDLLuma  luma;   ///< weights of the saturation
+    };
+
+  public:
+    CDLLut();
+
+    /** 
+     * Constructor.  Bakes a CDL.
+     */
+    CDLLut( const ASC_CDL& cdl, const Shape& shape = Shape() );
+
+    /** 
+     * Bake a CDL, replacing the table.
+     * 
+     * @param cdl    CDL to bake
+     * @param shape  type, size and input range of the table
+     */
+    void bake( const ASC_CDL& cdl, const Shape& shape = Shape() );
+
+    /** 
+     * Apply the table to interleaved RGB (channels 3) or RGBA
+     * (channels 4) floats.  Alpha is copied.  in and out may be the
+     * same.
+     */
+    void apply( const float* in, float* out, size_t pixels,
+                unsigned channels = 3 ) const;
+
+    /** 
+     * Use the kernels of another instruction set, for testing.
+     */
+    void simd( SIMDLevel level );
+    SIMDLevel simd() const { return _level; }
+
+    const ASC_CDL& cdl() const { return _cdl; }
+    const Shape& shape() const { return _shape; }
+
+    /** 
+     * The table, RGB triplets.  For k1D, shape().size points; for
+     * k3D, shape().size cubed, with red changing fastest and blue
+     * slowest.
+     */
+    const std::vector< float >& table() const { return _table; }
+
+    /// Memory of the table
+    size_t bytes() const { return _table.size() * sizeof(float); }
+
+  protected:
+    ASC_CDL           _cdl;
+    Shape             _shape;
+    float             _scale;     ///< ( size - 1 ) / ( high - low )
+    SIMDLevel         _level;
+    const CDLKernels* _kernels;
+    std::vector< float > _table;
+};
+
+/**
+ * CDLLutCache:  baked CDLLuts shared by every clip with the same grade.
+ *
+ * get() looks a table up by a hash of the CDL values and the shape,
+ * and bakes it on a miss.  When the cache holds more than capacity()
+ * tables, the least recently used one is dropped; clips still using it
+ * keep it alive through their shared_ptr.
+ *
+ * A cache can be shared by several threads.  Tables are baked outside
+ * the lock, so a slow bake does not hold up lookups of other grades.
+ */
+class ACES_EXPORT CDLLutCache
+{
+  public:
+    typedef std::shared_ptr< const CDLLut > Lut;
+
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param capacity  number of tables kept
+     */
+    CDLLutCache( size_t capacity = 64 );
+
+    /** 
+     * The table of a CDL, baked now if it is not in the cache.
+     * 
+     * @param cdl    CDL, as from ACESclipReader::GradeRef()
+     * @param shape  type, size and input range of the table
+     */
+    Lut get( const ASC_CDL& cdl, const CDLLut::Shape& shape = CDLLut::Shape() );
+
+    /// Number of tables kept
+    size_t size() const;
+
+    size_t capacity() const { return _capacity; }
+    void capacity( size_t n );
+
+    /// Drop all the tables
+    void clear();
+
+    size_t hits() const   { return _hits.load(); }
+    size_t misses() const { return _misses.load(); }
+    void clear_counters() { _hits = 0; _misses = 0; }
+
+    /// Cache shared by the library, created on first use.
+    static CDLLutCache& global();
+
+  private:
+    CDLLutCache( const CDLLutCache& );
+    CDLLutCache& operator=( const CDLLutCache& );
+
+  protected:
+    struct Entry
+    {
+        unsigned long long hash;
+        Lut lut;
+    };
+
+    typedef std::list< Entry > Entries;
+    typedef std::unordered_multimap< unsigned long long, 
+                                     Entries::iterator > Index;
+
+    Entries::iterator find( unsigned long long hash, const ASC_CDL& cdl,
+                            const CDLLut::Shape& shape );
+    void trim();
+
+  protected:
+    mutable std::mutex _mutex;
+    size_t      _capacity;
+    Entries     _entries;     ///< most recently used first
+    Index       _index;
+    std::atomic<size_t> _hits;
+    std::atomic<size_t> _misses;
+};
+
+}  // namespace ACES
+
+#endif  // ACESCDLLut_h
@@ -0,0 +1,320 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLProcessor_h
+#define ACESCDLProcessor_h
+
+#include <stddef.h>
+
+#include "ACES_ASC_CDL.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+struct CDLKernels;
+
+/**
+ * Vector instruction sets the pixel kernels are built for.
+ */
+enum SIMDLevel
+{
+kSIMDScalar,
+kSIMDSSE4,
+kSIMDAVX2,       ///< with FMA
+kSIMDAVX512
+};
+
+/** 
+ * Best instruction set both this CPU and this build of the library
+ * support.
+ */
+ACES_EXPORT SIMDLevel simd_level();
+
+/** 
+ * @return "scalar", "sse4", "avx2" or "avx512".
+ */
+ACES_EXPORT const char* simd_name( SIMDLevel level );
+
+/**
+ * Steps of the CDL a kernel can leave out, because the CDL makes them
+ * do nothing.  Each combination has a kernel of its own.
+ */
+enum CDLPath
+{
+kCDLFull         = 0,
+kCDLNoOffset     = 1 << 0,   ///< offsets all 0
+kCDLNoPower      = 1 << 1,   ///< powers all 1, no pow()
+kCDLNoSaturation = 1 << 2,   ///< saturation 1, no luma mix
+kCDLPaths        = 1 << 3    ///< number of combinations
+};
+
+/** 
+ * Steps a CDL with these values can leave out, as CDLPath bits.
+ * constexpr, so the path of a preset is known when compiling.
+ */
+constexpr unsigned cdl_paths( float offset_r, float offset_g, 
+                              float offset_b, float power_r, 
+                              float power_g, float power_b, 
+                              float saturation )
+{
+    return ( offset_r == 0.0f && offset_g == 0.0f && offset_b == 0.0f ?
+             (unsigned) kCDLNoOffset : 0u ) |
+           ( power_r == 1.0f && power_g == 1.0f && power_b == 1.0f ?
+             (unsigned) kCDLNoPower : 0u ) |
+           ( saturation == 1.0f ? (unsigned) kCDLNoSaturation : 0u );
+}
+
+ACES_EXPORT unsigned cdl_paths( const ASC_CDL& c );
+
+/**
+ * How exactly the kernels raise to the power of the CDL, picked on
+ * each apply(): the cheap ones for interactive review, kCDLExact for
+ * final renders.
+ */
+enum CDLPrecision
+{
+kCDLExact,       ///< pow() of the C library on each value
+kCDLPrecise,     ///< vector pow(), around 1 ulp (the default)
+kCDLFast,        ///< shorter polynomials, no division
+kCDLFastest,     ///< shortest polynomials, for 8 and 10 bit review
+kCDLPrecisions   ///< number of precisions
+};
+
+/** 
+ * Largest error of x^power at a precision, for any x in 0..1 and any
+ * power: 6e-8 (half an ulp of 1), 1.5e-7, 6e-6 and 3e-4.  Errors are
+ * absolute, as the results are in 0..1 too; a code of 10 bits is
+ * 9.8e-4 and one of 16 bits 1.5e-5.  Unknown precisions run as
+ * kCDLPrecise, and report its error.
+ */
+ACES_EXPORT double cdl_pow_error( CDLPrecision precision );
+
+/** 
+ * Cheapest precision whose cdl_pow_error() is within max_error, or
+ * kCDLExact if none is.
+ */
+ACES_EXPORT CDLPrecision cdl_precision( double max_error );
+
+/**
+ * Weights of the luma the saturation keeps.  The ASC CDL defines
+ * Rec.709's; a grade in an ACES space may weigh by its own primaries.
+ * The known sets have kernels with the weights built in, custom ones
+ * are read at run time.
+ */
+enum CDLLuma
+{
+kCDLLumaRec709,  ///< 0.2126, 0.7152, 0.0722, as in the ASC CDL (the default)
+kCDLLumaAP0,     ///< Y of the AP0 primaries, ACES2065-1
+kCDLLumaAP1,     ///< Y of the AP1 primaries, ACEScg, ACEScc and ACEScct
+kCDLLumaCustom,  ///< weights given at run time
+kCDLLumas        ///< number of kinds
+};
+
+/** 
+ * Red, green and blue weights of a known CDLLuma.  kCDLLumaCustom
+ * and unknown values give Rec.709's.
+ */
+ACES_EXPORT const float* cdl_luma_weights( CDLLuma luma );
+
+/**
+ * CDLPreset:  the values of a CDL as a literal type, for looks known
+ *             when compiling.
+ *
+ *     constexpr ACES::CDLPreset kWarm( 1.1f, 1.0f, 0.9f,  0, 0, 0,
+ *                                      1, 1, 1,  1 );
+ *     static_assert( kWarm.paths() == ( ACES::kCDLNoOffset |
+ *                                       ACES::kCDLNoPower |
+ *                                       ACES::kCDLNoSaturation ), "" );
+ */
+struct CDLPreset
+{
+    constexpr CDLPreset( float sr, float sg, float sb,
+                         float or_, float og, float ob,
+                         float pr, float pg, float pb, 
+                         float sat ) :
+    slope{ sr, sg, sb }, offset{ or_, og, ob }, power{ pr, pg, pb },
+    saturation( sat )
+    {
+    }
+
+    constexpr unsigned paths() const
+    {
+        return cdl_paths( offset[0], offset[1], offset[2], 
+                          power[0], power[1], power[2], saturation );
+    }
+
+    ASC_CDL cdl() const
+    {
+        ASC_CDL c;
+        c.slope( slope[0], slope[1], slope[2] );
+        c.offset( offset[0], offset[1], offset[2] );
+        c.power( power[0], power[1], power[2] );
+        c.saturation( saturation );
+        return c;
+    }
+
+    float slope[3];
+    float offset[3];
+    float power[3];
+    float saturation;
+};
+
+/**
+ * CDLProcessor:  applies an ASC_CDL to float pixels.
+ *
+ * For each pixel, as in the ASC CDL:
+ *
+ *     out  = clamp( in * slope + offset, 0, 1 ) ^ power
+ *     luma = 0.2126 out.r + 0.7152 out.g + 0.0722 out.b
+ *     out  = luma + saturation * ( out - luma )
+ *
+ * The luma weights can be changed with luma() (see CDLLuma).
+ *
+ * Pixels are interleaved RGB or RGBA floats; alpha is copied.  The
+ * kernels use the best instruction set the CPU has (simd_level()).
+ * All of them stay within 2.5e-7 * ( 1 + |saturation| ) of
+ * reference(), which rounds in * slope + offset to float like they do
+ * and computes the rest in double with pow().  NaN comes out as 0
+ * before saturation.
+ *
+ * At other precisions (see CDLPrecision) the error can grow by
+ * cdl_pow_error() * ( 1 + 2 |saturation| ).
+ *
+ * The kernel is picked when the CDL is set: CDLs with no offset, a
+ * power of 1 or a saturation of 1 run kernels without those steps
+ * (see CDLPath), which are also exact where the full one rounds.
+ *
+ * A processor is immutable while applying, so one can be shared by
+ * several threads.
+ */
+class ACES_EXPORT CDLProcessor
+{
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param cdl  the CDL to apply
+     */
+    explicit CDLProcessor( const ASC_CDL& cdl = ASC_CDL() );
+
+    /** 
+     * Constructor.  The path of a preset is known already.
+     */
+    explicit CDLProcessor( const CDLPreset& preset );
+
+    /** 
+     * Change the CDL.
+     */
+    void cdl( const ASC_CDL& c );
+    const ASC_CDL& cdl() const { return _cdl; }
+
+    /** 
+     * Use the kernels of another instruction set, for testing.  Levels
+     * the CPU or the build lack fall back to the best one below.
+     */
+    void simd( SIMDLevel level );
+    SIMDLevel simd() const { return _level; }
+
+    /** 
+     * Use the kernels specialized for the CDL (the default), or the
+     * full one always, for testing.
+     */
+    void specialize( bool on );
+
+    /** 
+     * Steps the kernel in use leaves out, as CDLPath bits.
+     */
+    unsigned paths() const { return _paths; }
+
+    /** 
+     * Weigh the luma of the saturation with a known set.
+     * kCDLLumaCustom keeps the weights but reads them at run time.
+     */
+    void luma( CDLLuma l );
+
+    /** 
+     * Weigh the luma with other weights, read at run time.
+     */
+    void luma( float r, float g, float b );
+
+    CDLLuma luma() const { return _luma; }
+    const float* luma_weights() const { return _weights; }
+
+    /** 
+     * Apply the CDL.  in and out may be the same buffer.
+     * 
+     * @param in        pixels to read
+     * @param out       pixels to write
+     * @param pixels    number of pixels
+     * @param channels  3 for RGB or 4 for RGBA
+     * @param precision of the power
+     */
+    void apply( const float* in, float* out, size_t pixels,
+                unsigned channels = 3, 
+                CDLPrecision precision = kCDLPrecise ) const;
+
+    /** 
+     * Apply the CDL in place.
+     */
+    void apply( float* pixels, size_t count, unsigned channels = 3,
+                CDLPrecision precision = kCDLPrecise ) const
+    {
+        apply( pixels, pixels, count, channels, precision );
+    }
+
+    /** 
+     * Apply the CDL in place to pixels stored as three planes, as in
+     * planar images or a block being converted from another format.
+     */
+    void apply_planes( float* r, float* g, float* b, size_t pixels,
+                       CDLPrecision precision = kCDLPrecise ) const;
+
+    /** 
+     * The CDL on one pixel, in double precision, to test the kernels
+     * against.
+     * 
+     * @param luma  weights of the saturation, NULL for Rec.709's
+     */
+    static void reference( const ASC_CDL& c, const float in[3], 
+                           float out[3], const float* luma = NULL );
+
+  protected:
+    ASC_CDL           _cdl;
+    SIMDLevel         _level;
+    const CDLKernels* _kernels;
+    unsigned          _paths;
+    bool              _specialize;
+    CDLLuma           _luma;
+    float             _weights[3];
+};
+
+}  // namespace ACES
+
+#endif  // ACESCDLProcessor_h
@@ -0,0 +1,204 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLWorkSpace_h
+#define ACESCDLWorkSpace_h
+
+#include <stddef.h>
+#include <string>
+
+#include "ACESCDLProcessor.h"
+#include "ACESclipMetadata.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * Spaces a GradeRef converts to and from around its CDL.
+ */
+enum WorkSpace
+{
+kWorkSpaceACES,      ///< ACES2065-1: AP0 primaries, linear
+kWorkSpaceACEScg,    ///< AP1 primaries, linear
+kWorkSpaceACEScc,    ///< AP1 primaries, logarithmic
+kWorkSpaceACEScct,   ///< AP1 primaries, logarithmic with a linear toe
+kWorkSpaceUnknown
+};
+
+/** 
+ * @return "ACES", "ACEScg", "ACEScc", "ACEScct" or "unknown".
+ */
+ACES_EXPORT const char* workspace_name( WorkSpace s );
+
+/** 
+ * Spaces an ACEScsc TransformID converts between, as in
+ * "ACEScsc.ACES_to_ACEScct" or, with the newer names,
+ * "urn:ampas:aces:transformId:v1.5:ACEScsc.Academy.ACEScct_to_ACES.a1.0.3".
+ * 
+ * @return false if the id is not a conversion between known spaces.
+ */
+ACES_EXPORT bool workspace_conversion( const std::string& transform_id,
+                                       WorkSpace& from, WorkSpace& to );
+
+/** 
+ * Convert RGB or RGBA floats between spaces, as the ACEScsc transforms
+ * do.  Alpha is copied.  in and out may be the same.
+ */
+ACES_EXPORT void convert_workspace( const float* in, float* out, 
+                                    size_t pixels, unsigned channels,
+                                    WorkSpace from, WorkSpace to,
+                                    CDLPrecision precision = kCDLPrecise );
+
+/**
+ * CDLWorkSpaceProcessor:  applies the CDL of a GradeRef in its working
+ * space.  The pixels are converted to the space of Convert_to_WorkSpace,
+ * graded, and converted back with Convert_from_WorkSpace, usually from
+ * ACES to ACEScct and back.
+ *
+ * The conversions and the CDL run together on blocks of a few hundred
+ * pixels that stay in the cache, so a frame is read and written once
+ * instead of three times.  They use the kernels of CDLProcessor and
+ * its CDLPrecision: the curves of ACEScc and ACEScct share its log2()
+ * and exp2().  The saturation weighs Rec.709 luma, as the ASC CDL
+ * does, unless luma() picks the AP1 weights of the working space.
+ *
+ * A processor is immutable while applying, so one can be shared by
+ * several threads.
+ */
+class ACES_EXPORT CDLWorkSpaceProcessor
+{
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param cdl     CDL to apply
+     * @param space   space the CDL grades in
+     * @param pixels  space of the pixels, in and out
+     */
+    CDLWorkSpaceProcessor( const ASC_CDL& cdl = ASC_CDL(), 
+                           WorkSpace space = kWorkSpaceACEScct,
+                           WorkSpace pixels = kWorkSpaceACES );
+
+    /** 
+     * Constructor.  Takes the CDL and the TransformIDs of a GradeRef,
+     * as read by ACESclipReader.
+     */
+    explicit CDLWorkSpaceProcessor( const ACESclipMetadata& m );
+
+    /** 
+     * Change the CDL and the spaces.
+     * 
+     * @param in     space of the pixels read
+     * @param space  space the CDL grades in
+     * @param out    space of the pixels written
+     */
+    void set( const ASC_CDL& cdl, WorkSpace in, WorkSpace space, 
+              WorkSpace out );
+
+    /** 
+     * Change the CDL and the spaces, by the TransformIDs of
+     * Convert_to_WorkSpace and Convert_from_WorkSpace.  If either is
+     * not known, or they do not meet in one space, the CDL is applied
+     * to the pixels as they are.
+     * 
+     * @return false if the TransformIDs were not used.
+     */
+    bool set( const ASC_CDL& cdl, const std::string& convert_to,
+              const std::string& convert_from );
+
+    const ASC_CDL& cdl() const { return _cdl; }
+    WorkSpace in_space() const { return _in; }
+    WorkSpace space() const { return _space; }
+    WorkSpace out_space() const { return _out; }
+
+    /** 
+     * Use the kernels of another instruction set, for testing.
+     */
+    void simd( SIMDLevel level );
+    SIMDLevel simd() const { return _level; }
+
+    /** 
+     * Weigh the luma of the saturation with a known set, or with other
+     * weights read at run time.
+     */
+    void luma( CDLLuma l );
+    void luma( float r, float g, float b );
+    CDLLuma luma() const { return _luma; }
+    const float* luma_weights() const { return _weights; }
+
+    /** 
+     * Convert, apply the CDL and convert back.  in and out may be the 
+     * same buffer.
+     * 
+     * @param in         pixels to read
+     * @param out        pixels to write
+     * @param pixels     number of pixels
+     * @param channels   3 for RGB or 4 for RGBA
+     * @param precision  of the power and the curves
+     */
+    void apply( const float* in, float* out, size_t pixels,
+                unsigned channels = 3,
+                CDLPrecision precision = kCDLPrecise ) const;
+
+    /** 
+     * Apply in place.
+     */
+    void apply( float* pixels, size_t count, unsigned channels = 3,
+                CDLPrecision precision = kCDLPrecise ) const
+    {
+        apply( pixels, pixels, count, channels, precision );
+    }
+
+    /** 
+     * One pixel in double precision, but for the CDL itself, which is
+     * CDLProcessor::reference(), to test the kernels against.
+     * 
+     * @param luma  weights of the saturation, NULL for Rec.709's
+     */
+    static void reference( const ASC_CDL& c, WorkSpace in, 
+                           WorkSpace space, WorkSpace out,
+                           const float rgb[3], float result[3],
+                           const float* luma = NULL );
+
+  protected:
+    ASC_CDL           _cdl;
+    WorkSpace         _in;
+    WorkSpace         _space;
+    WorkSpace         _out;
+    SIMDLevel         _level;
+    const CDLKernels* _kernels;
+    unsigned          _paths;
+    CDLLuma           _luma;
+    float             _weights[3];
+};
+
+}  // namespace ACES
+
+#endif  // ACESCDLWorkSpace_h
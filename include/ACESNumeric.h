@@ -0,0 +1,112 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESNumeric_h
+#define ACESNumeric_h
+
+#include <stddef.h>
+
+#include "ACESExport.h"
+
+namespace ACES {
+
+/** 
+ * Parse a decimal floating point number, in the style of
+ * std::from_chars.  Unlike strtod/atof it never looks at the C locale,
+ * so '.' is always the decimal point, and it allocates no memory.
+ * Leading whitespace is skipped.  The result is correctly rounded.
+ * 
+ * Accepted: [+-] digits [. digits] [(e|E) [+-] digits], inf, infinity
+ * and nan (any case).
+ * 
+ * @param first  start of the text
+ * @param last   end of the text
+ * @param value  number parsed.  Left untouched on failure.
+ * 
+ * @return pointer past the number, or first if there was no number.
+ */
+ACES_EXPORT const char* parse_float( const char* first, const char* last,
+                                     float& value );
+
+ACES_EXPORT const char* parse_double( const char* first, const char* last,
+                                      double& value );
+
+/** 
+ * Parse a vector of 3 float numbers separated by whitespace, as used by
+ * the Slope, Offset and Power of an ASC_CDL.  Missing or invalid
+ * numbers are returned as 0.
+ * 
+ * @param first  start of the text
+ * @param last   end of the text
+ * @param out    the 3 float numbers
+ * 
+ * @return pointer past the last number parsed.
+ */
+ACES_EXPORT const char* parse_V3( const char* first, const char* last,
+                                  float out[3] );
+
+// Room for format_float(), -1.2345678e-38 and its NUL
+static const size_t kFloatChars = 16;
+
+/** 
+ * Write the shortest decimal that parse_float() reads back as exactly
+ * the same float, so values survive any number of write and read
+ * cycles.  When several numbers of that length would do, the closest
+ * one is written.  Numbers from 1e-4 up to, but not including, 1e9
+ * are written in fixed notation and others as printf's %g would,
+ * 1.5e-07.  Never looks at the C locale.
+ * 
+ * @param value  number to write
+ * @param out    at least kFloatChars chars
+ * 
+ * @return pointer to the terminating NUL.
+ */
+ACES_EXPORT char* format_float( float value, char* out );
+
+/** 
+ * Write 3 floats separated by a space, as the Slope, Offset and Power
+ * of an ASC_CDL.
+ * 
+ * @param v    the 3 numbers
+ * @param out  at least 3 * kFloatChars chars
+ * 
+ * @return pointer to the terminating NUL.
+ */
+ACES_EXPORT char* format_V3( const float v[3], char* out );
+
+/** 
+ * Convenience versions for NUL terminated strings, returning 0 if there
+ * is no number (like atof).
+ */
+ACES_EXPORT float  to_float( const char* s );
+ACES_EXPORT double to_double( const char* s );
+
+}  // namespace ACES
+
+#endif  // ACESNumeric_h
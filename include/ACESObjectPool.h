@@ -0,0 +1,195 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESObjectPool_h
+#define ACESObjectPool_h
+
+#include <stddef.h>
+#include <mutex>
+#include <vector>
+
+
+namespace ACES {
+
+/**
+ * ObjectPool:  a thread safe pool of reusable objects, for
+ * ACESclipReader and ACESclipWriter.
+ *
+ * acquire() hands out an idle object, calling its reset() first, or a new
+ * one when there is none.  The object goes back to the pool when its
+ * Handle is destroyed.  Once the pool holds as many objects as there are
+ * users, checking them in and out does not allocate.
+ *
+ * T must be default constructible and have a reset() method.
+ */
+template< class T >
+class ObjectPool
+{
+  public:
+    /**
+     * Handle:  owns an object checked out of the pool and returns it
+     * when destroyed.  Handles can be moved but not copied.
+     */
+    class Handle
+    {
+      public:
+        Handle() : _pool( NULL ), _object( NULL ) {}
+
+        Handle( Handle&& b ) : _pool( b._pool ), _object( b._object )
+        {
+            b._object = NULL;
+        }
+
+        ~Handle() { release(); }
+
+        Handle& operator=( Handle&& b )
+        {
+            if ( this != &b )
+            {
+                release();
+                _pool = b._pool;
+                _object = b._object;
+                b._object = NULL;
+            }
+            return *this;
+        }
+
+        T* get() const        { return _object; }
+        T* operator->() const { return _object; }
+        T& operator*() const  { return *_object; }
+
+        /** 
+         * Return the object to the pool now.
+         */
+        void release()
+        {
+            if ( _object ) _pool->release( _object );
+            _object = NULL;
+        }
+
+      private:
+        friend class ObjectPool;
+
+        Handle( ObjectPool* pool, T* object ) : 
+        _pool( pool ), 
+        _object( object )
+        {
+        }
+
+        Handle( const Handle& );
+        Handle& operator=( const Handle& );
+
+        ObjectPool* _pool;
+        T*          _object;
+    };
+
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param max_idle  most objects kept when they are returned.  0 keeps
+     *                  them all.
+     */
+    explicit ObjectPool( size_t max_idle = 0 ) : _max_idle( max_idle ) {}
+
+    ~ObjectPool()
+    {
+        for ( size_t i = 0; i < _idle.size(); ++i )
+            delete _idle[i];
+    }
+
+    /** 
+     * Check an object out of the pool.
+     * 
+     * @return Handle to an object ready to be used.
+     */
+    Handle acquire()
+    {
+        T* object = NULL;
+        {
+            std::lock_guard< std::mutex > lock( _mutex );
+            if ( !_idle.empty() )
+            {
+                object = _idle.back();
+                _idle.pop_back();
+            }
+        }
+
+        if ( object ) object->reset();
+        else object = new T;
+        return Handle( this, object );
+    }
+
+    /** 
+     * Create objects up front so the first users don't allocate them.
+     * 
+     * @param n  number of idle objects to have in the pool
+     */
+    void reserve( size_t n )
+    {
+        std::lock_guard< std::mutex > lock( _mutex );
+        _idle.reserve( n );
+        while ( _idle.size() < n )
+            _idle.push_back( new T );
+    }
+
+    /** 
+     * @return number of objects waiting in the pool.
+     */
+    size_t idle() const
+    {
+        std::lock_guard< std::mutex > lock( _mutex );
+        return _idle.size();
+    }
+
+  private:
+    ObjectPool( const ObjectPool& );
+    ObjectPool& operator=( const ObjectPool& );
+
+    void release( T* object )
+    {
+        {
+            std::lock_guard< std::mutex > lock( _mutex );
+            if ( _max_idle == 0 || _idle.size() < _max_idle )
+            {
+                _idle.push_back( object );
+                return;
+            }
+        }
+        delete object;
+    }
+
+    mutable std::mutex _mutex;
+    std::vector< T* >  _idle;
+    size_t             _max_idle;
+};
+
+}  // namespace ACES
+
+#endif  // ACESObjectPool_h
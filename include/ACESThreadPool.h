@@ -0,0 +1,175 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESThreadPool_h
+#define ACESThreadPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ACESExport.h"
+
+namespace ACES {
+
+/**
+ * ThreadPool:  a persistent pool of worker threads with one task queue
+ *              per worker.  Workers run their own queue newest first and,
+ *              when it is empty, steal the oldest tasks of the others.
+ *
+ */
+class ACES_EXPORT ThreadPool
+{
+  public:
+    typedef std::function< void() > Task;
+
+    /** 
+     * Constructor
+     * 
+     * @param threads  number of workers.  0 uses one per hardware thread.
+     */
+    ThreadPool( unsigned threads = 0 );
+    ~ThreadPool();
+
+    /// Number of worker threads
+    unsigned size() const { return (unsigned) _workers.size(); }
+
+    /** 
+     * Queue a task.  Tasks queued from a worker go to that worker's
+     * own queue, others are spread over all the workers.
+     * 
+     * @param t task to run
+     */
+    void submit( const Task& t );
+
+    /** 
+     * Run one queued task on the calling thread, if there is any.
+     * 
+     * @return true if a task was run, false if all queues were empty.
+     */
+    bool run_one();
+
+    /** 
+     * Call fn( first, last ) over [begin, end) split into ranges of
+     * grain items, spread over the pool.  The calling thread helps and
+     * the call returns when all ranges are done.
+     * 
+     * @param begin  first index
+     * @param end    one past the last index
+     * @param grain  maximum number of indices per call
+     * @param fn     function to call for each range
+     */
+    void parallel_for( size_t begin, size_t end, size_t grain,
+                       const std::function< void( size_t, size_t ) >& fn );
+
+    /** 
+     * Index of the calling thread in this pool.
+     * 
+     * @return [0, size()) for the pool workers, size() for any other thread.
+     */
+    unsigned current_index() const;
+
+    /// Pool shared by the library, created on first use.
+    static ThreadPool& global();
+
+  protected:
+    struct Worker
+    {
+        std::mutex        mutex;
+        std::deque< Task > tasks;
+    };
+
+    bool find( unsigned self, Task& t );
+    void run( unsigned self );
+
+  private:
+    ThreadPool( const ThreadPool& );
+    ThreadPool& operator=( const ThreadPool& );
+
+  protected:
+    std::vector< std::unique_ptr< Worker > > _workers;
+    std::vector< std::thread > _threads;
+
+    std::mutex              _sleep_mutex;
+    std::condition_variable _wake;
+    std::atomic< size_t >   _queued;
+    std::atomic< unsigned > _next;
+    bool                    _stop;
+};
+
+/**
+ * TaskGroup:  a set of tasks run on a ThreadPool that can be waited for
+ *             as a whole.  The thread waiting runs queued tasks while
+ *             it waits.
+ *
+ */
+class ACES_EXPORT TaskGroup
+{
+  public:
+    TaskGroup( ThreadPool& pool );
+    ~TaskGroup();
+
+    /** 
+     * Queue a task in the group.
+     * 
+     * @param t task to run
+     */
+    void run( const ThreadPool::Task& t );
+
+    /** 
+     * Wait for all the tasks of the group.  If a task threw, the first
+     * exception is rethrown here.
+     * 
+     */
+    void wait();
+
+    /// True once all tasks queued so far are done.
+    bool done() const { return _pending == 0; }
+
+  private:
+    TaskGroup( const TaskGroup& );
+    TaskGroup& operator=( const TaskGroup& );
+
+  protected:
+    ThreadPool&             _pool;
+    std::atomic< size_t >   _pending;
+    std::mutex              _mutex;
+    std::condition_variable _done;
+    std::exception_ptr      _error;
+};
+
+}  // namespace ACES
+
+#endif  // ACESThreadPool_h
@@ -67,6 +67,16 @@ class ACES_EXPORT Transform
 
     ~Transform() {}
 
+    /** 
+     * Empty the transform, keeping the memory of its strings.
+     */
+    void reset()
+    {
+        name.clear();
+        link_transform.clear();
+        status = kLastStatus;
+    }
+
     Transform( const Transform& b ) :
     name( b.name ),
     link_transform( b.link_transform ),
@@ -74,6 +84,14 @@ class ACES_EXPORT Transform
     {
     }
 
+    Transform& operator=( const Transform& b )
+    {
+        name = b.name;
+        link_transform = b.link_transform;
+        status = b.status;
+        return *this;
+    }
+
     friend std::ostream& operator<<( std::ostream& o, const Transform& t )
     {
         o << t.name << " status: ";
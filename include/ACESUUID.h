@@ -0,0 +1,143 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESUUID_h
+#define ACESUUID_h
+
+#include <stddef.h>
+#include <string>
+
+#include "ACESExport.h"
+
+namespace ACES {
+
+/**
+ * UUIDValue:  the 16 bytes of a UUID.
+ *
+ */
+struct ACES_EXPORT UUIDValue
+{
+    unsigned char bytes[16];
+
+    /** 
+     * Write the usual text form, 8-4-4-4-12 lowercase hex digits, and a
+     * terminating NUL.
+     * 
+     * @param out  at least 37 chars.
+     */
+    void format( char* out ) const;
+
+    /// Text form as a string.
+    std::string str() const;
+};
+
+/**
+ * UUIDSource:  where the writers get the UUID of each document from.
+ *              Replace it with set_current() to use another generator,
+ *              for example a deterministic one for reproducible output.
+ *
+ */
+class ACES_EXPORT UUIDSource
+{
+  public:
+    virtual ~UUIDSource();
+
+    /** 
+     * Fill a block of UUIDs.  May be called from several threads at
+     * once.  Callers hand UUIDs out of the block one by one, so a source
+     * with a lock or a system call pays for it once per block.
+     * 
+     * @param out    where to write them
+     * @param count  number of UUIDs to write
+     */
+    virtual void generate( UUIDValue* out, size_t count ) = 0;
+
+    /// Source the writers use.  RandomUUIDSource::instance() by default.
+    static UUIDSource& current();
+
+    /** 
+     * Change the source the writers use.  The source is not owned and
+     * must outlive its use.
+     * 
+     * @param s  new source, or NULL for the default one.
+     */
+    static void set_current( UUIDSource* s );
+};
+
+/**
+ * RandomUUIDSource:  random (version 4) UUIDs from a generator per
+ *                    thread, seeded once from std::random_device when
+ *                    the thread first asks, and again in the child
+ *                    after a fork.
+ *
+ */
+class ACES_EXPORT RandomUUIDSource : public UUIDSource
+{
+  public:
+    virtual void generate( UUIDValue* out, size_t count );
+
+    /// The one instance.
+    static RandomUUIDSource& instance();
+};
+
+/**
+ * UUIDBlock:  hands out UUIDs one at a time, asking its source for a
+ *             block of them whenever it runs out.  What is left of a
+ *             block is dropped after set_current() or a fork.  Not
+ *             thread safe; use one per thread.
+ *
+ */
+class ACES_EXPORT UUIDBlock
+{
+  public:
+    static const size_t kSize = 64;
+
+    UUIDBlock( UUIDSource& source = UUIDSource::current() );
+
+    /// Next UUID.
+    const UUIDValue& next();
+
+  protected:
+    UUIDSource& _source;
+    unsigned    _generation;
+    size_t      _next;
+    UUIDValue   _block[kSize];
+};
+
+/** 
+ * Next UUID from the current source, in its text form, through a block
+ * per thread.  This is what the writers use.
+ * 
+ * @param out  at least 37 chars.
+ */
+ACES_EXPORT void new_uuid( char* out );
+
+}  // namespace ACES
+
+#endif  // ACESUUID_h
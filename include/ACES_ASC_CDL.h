@@ -27,6 +27,29 @@ class ASC_CDL
         }
     }
 
+    ASC_CDL& operator=( const ASC_CDL& b )
+    {
+        for ( unsigned short i = 0; i < 3; ++i )
+        {
+            _slope[i] = b.slope(i);
+            _offset[i] = b.offset(i);
+            _power[i] = b.power(i);
+        }
+        _saturation = b.saturation();
+        return *this;
+    }
+
+    /** 
+     * Set the identity values again.
+     */
+    void reset()
+    {
+        _slope[0]  = _slope[1]  = _slope[2]  = 1.0f;
+        _offset[0] = _offset[1] = _offset[2] = 0.0f;
+        _power[0]  = _power[1]  = _power[2]  = 1.0f;
+        _saturation = 1.0f;
+    }
+
     void slope( const float x, const float y, const float z )
     {
         _slope[0] = x;
@@ -0,0 +1,133 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipBatch_h
+#define ACESclipBatch_h
+
+#include <string>
+#include <vector>
+
+#include "ACESclipReader.h"
+#include "ACESObjectPool.h"
+#include "ACESThreadPool.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipBatch:  load many ACESclip files in parallel.
+ *
+ * Files are spread over a ThreadPool.  Workers check ACESclipReaders
+ * out of an ObjectPool and reuse them for all the files they load.
+ * Results come back in the same order as the input.  Passing the same
+ * Results to each load() reuses their memory too, so once warm a batch
+ * only allocates for values that grew.
+ *
+ * A batch runs one load at a time; use one ACESclipBatch per thread
+ * calling load().
+ */
+class ACES_EXPORT ACESclipBatch
+{
+  public:
+    struct Result
+    {
+        Result() : error( ACESclipReader::kLastError ) {}
+
+        std::string               filename;
+        ACESclipReader::ACESError error;
+        ACESclipMetadata          metadata;
+    };
+
+    typedef std::vector< Result > Results;
+
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param pool  pool to run the loads on.  NULL uses ThreadPool::global().
+     */
+    ACESclipBatch( ThreadPool* pool = NULL );
+    ~ACESclipBatch();
+
+    /** 
+     * Sections to read from each file.  The default, kAllSections,
+     * reads each file in full like ACESclipReader::load_mapped().
+     * Anything else probes the files with ACESclipReader::probe().
+     * 
+     * @param s ACESclipReader::Section flags
+     */
+    void sections( unsigned s ) { _sections = s; }
+    unsigned sections() const   { return _sections; }
+
+    /** 
+     * Load a list of files.
+     * 
+     * @param files    files to load
+     * @param results  one result per file, in the same order.  Results
+     *                 already in it are reused.
+     */
+    void load( const std::vector< std::string >& files, Results& results );
+
+    /** 
+     * Load all the .xml files under a directory, recursively.
+     * 
+     * @param root     directory to look into
+     * @param results  one result per file, sorted by filename
+     * 
+     * @return false if root could not be read, true otherwise.
+     */
+    bool load_directory( const std::string& root, Results& results );
+
+    /** 
+     * List the files under a directory, recursively, sorted by name.
+     * 
+     * @param root   directory to look into
+     * @param files  files found are appended here
+     * @param ext    only keep files ending in ext (case insensitive)
+     * 
+     * @return false if root could not be read, true otherwise.
+     */
+    static bool find_files( const std::string& root, 
+                            std::vector< std::string >& files,
+                            const char* ext = ".xml" );
+
+  private:
+    ACESclipBatch( const ACESclipBatch& );
+    ACESclipBatch& operator=( const ACESclipBatch& );
+
+  protected:
+    ThreadPool* _pool;
+    unsigned    _sections;
+    ObjectPool< ACESclipReader > _readers;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipBatch_h
@@ -0,0 +1,179 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipBatchWriter_h
+#define ACESclipBatchWriter_h
+
+#include <string>
+#include <vector>
+
+#include "ACESThreadPool.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipBatchWriter:  save many documents safely, in groups.
+ *
+ * Documents are queued with add() and written when commit() is called,
+ * or when a group is full.  Each one goes to a temporary file in the
+ * same directory that is then renamed over the final name, so a reader
+ * or a crash never sees half a file: there is either the old file or
+ * the new one.
+ *
+ * With kDurable, each temporary file is also synced before the rename,
+ * and once all the files of a group are renamed, each directory they
+ * went into is synced once.  A file is only reported saved after that,
+ * when it will survive a power loss.  The files of a group are written
+ * in parallel on a ThreadPool, so on network filesystems the round
+ * trips of their syncs overlap instead of adding up.
+ *
+ * Failures are reported per file in results(), in the order the files
+ * were added; a file that fails does not stop the rest of its group.
+ *
+ * A batch writer must be used from one thread at a time.
+ */
+class ACES_EXPORT ACESclipBatchWriter
+{
+  public:
+    enum Durability
+    {
+    kAtomic,      ///< temporary file and rename, no syncs
+    kDurable      ///< and sync files and directories, once per group
+    };
+
+    struct Result
+    {
+        Result() : ok( false ), error( 0 ) {}
+
+        std::string filename;
+        bool        ok;
+        int         error;     ///< errno of the failure, if not ok
+    };
+
+    typedef std::vector< Result > Results;
+
+    /**
+     * Counters of the commits so far.  Throughput is files / seconds,
+     * latency of a commit last_seconds or max_seconds.
+     */
+    struct Stats
+    {
+        Stats() { clear(); }
+        void clear();
+
+        size_t commits;       ///< groups written
+        size_t files;         ///< files saved
+        size_t failed;        ///< files not saved
+        size_t bytes;         ///< bytes saved
+        double seconds;       ///< time spent in all commits
+        double last_seconds;  ///< time of the last commit
+        double max_seconds;   ///< time of the slowest commit
+    };
+
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param durability  kAtomic or kDurable
+     * @param group_size  files queued before add() commits by itself
+     * @param pool        pool to write on.  NULL uses ThreadPool::global().
+     */
+    ACESclipBatchWriter( Durability durability = kDurable,
+                         size_t group_size = 256,
+                         ThreadPool* pool = NULL );
+
+    /** 
+     * Destructor.  Commits what is still queued.
+     */
+    ~ACESclipBatchWriter();
+
+    /** 
+     * Queue a document, committing the group if it is full.
+     * 
+     * @param filename  file to save the document to
+     * @param document  contents of the file, as from save_to_string()
+     *                  or ACESclipTemplate::stamp()
+     */
+    void add( const std::string& filename, const std::string& document );
+    void add( const char* filename, const char* document, size_t size );
+
+    /** 
+     * Write all the documents queued.
+     * 
+     * @return true if all of them were saved.
+     */
+    bool commit();
+
+    /// Documents queued and not committed yet.
+    size_t queued() const { return _queued; }
+
+    /** 
+     * Outcome of every file committed since the last clear_results(),
+     * in the order they were added.
+     */
+    const Results& results() const { return _results; }
+    void clear_results() { _results.clear(); }
+
+    const Stats& stats() const { return _stats; }
+    void clear_stats() { _stats.clear(); }
+
+    Durability durability() const { return _durability; }
+    size_t group_size() const     { return _group_size; }
+
+  private:
+    ACESclipBatchWriter( const ACESclipBatchWriter& );
+    ACESclipBatchWriter& operator=( const ACESclipBatchWriter& );
+
+  protected:
+    struct Pending
+    {
+        std::string filename;
+        std::string document;
+        std::string temporary;
+        int         error;
+    };
+
+    void write( Pending& p );
+    void sync_directories( size_t count );
+
+  protected:
+    ThreadPool*            _pool;
+    Durability             _durability;
+    size_t                 _group_size;
+    std::vector< Pending > _pending;   // first _queued in use, rest kept
+    size_t                 _queued;
+    Results                _results;
+    Stats                  _stats;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipBatchWriter_h
@@ -0,0 +1,151 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipCache_h
+#define ACESclipCache_h
+
+#include <atomic>
+#include <string>
+
+#include "ACESclipReader.h"
+#include "ACESObjectPool.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipCache:  on-disk cache of the metadata read from ACESclip files.
+ *
+ * Each file read through the cache is stored as a compact binary
+ * record in the cache directory, named after a hash of its path.  The
+ * next load() of the same file maps the record and copies the values
+ * out, instead of parsing the XML again.
+ *
+ * A record is only used if the file has not changed since it was
+ * written, which is checked by modification time and size
+ * (kPathTimeSize) or by hashing the file contents (kContentHash, slower
+ * but immune to touched or copied files).  Records are written to a
+ * temporary file and renamed into place, so readers never see half a
+ * record, and they carry a checksum, so a damaged one is just a miss.
+ *
+ * A cache can be shared by several threads.  Paths are used as given;
+ * pass them the same way each time to get hits.
+ */
+class ACES_EXPORT ACESclipCache
+{
+  public:
+    enum Validation
+    {
+    kPathTimeSize,
+    kContentHash
+    };
+
+  public:
+    /** 
+     * Constructor
+     * 
+     * @param directory   directory for the records.  It is created if
+     *                    missing (but not its parents).
+     * @param validation  how to check a record is still valid
+     */
+    ACESclipCache( const std::string& directory,
+                   Validation validation = kPathTimeSize );
+    ~ACESclipCache();
+
+    /** 
+     * Load the metadata of an ACESclip file, from the cache if possible.
+     * On a miss the file is read like ACESclipReader::load_mapped() and
+     * the result stored for next time.  Errors are cached too.
+     * 
+     * @param filename  ACESclip file
+     * @param metadata  metadata read.  Its memory is reused.
+     * 
+     * @return ACESError of loading the file.
+     */
+    ACESclipReader::ACESError load( const char* filename,
+                                    ACESclipMetadata& metadata );
+
+    /** 
+     * Look a file up without reading it on a miss.
+     * 
+     * @param filename  ACESclip file
+     * @param metadata  metadata stored for the file
+     * @param error     error stored for the file
+     * 
+     * @return true on a hit, false if there is no valid record.
+     */
+    bool find( const char* filename, ACESclipMetadata& metadata,
+               ACESclipReader::ACESError& error );
+
+    /** 
+     * Store the metadata of a file, replacing any record for it.
+     * 
+     * @param filename  ACESclip file the metadata was read from
+     * @param metadata  metadata to store
+     * @param error     error returned when reading it
+     * 
+     * @return true on success, false if the file or the record could
+     *         not be written.
+     */
+    bool store( const char* filename, const ACESclipMetadata& metadata,
+                ACESclipReader::ACESError error = ACESclipReader::kAllOK );
+
+    /** 
+     * Forget the record of a file.
+     * 
+     * @return true if there was one.
+     */
+    bool remove( const char* filename );
+
+    const std::string& directory() const { return _directory; }
+    Validation validation() const        { return _validation; }
+
+    size_t hits() const   { return _hits.load(); }
+    size_t misses() const { return _misses.load(); }
+    void clear_counters() { _hits = 0; _misses = 0; }
+
+  private:
+    ACESclipCache( const ACESclipCache& );
+    ACESclipCache& operator=( const ACESclipCache& );
+
+  protected:
+    std::string record_path( const char* filename ) const;
+
+  protected:
+    std::string _directory;
+    Validation  _validation;
+    std::atomic<size_t> _hits;
+    std::atomic<size_t> _misses;
+    ObjectPool< ACESclipReader > _readers;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipCache_h
@@ -0,0 +1,257 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipCatalog_h
+#define ACESclipCatalog_h
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ACESclipBatch.h"
+#include "ACESclipMetadata.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipCatalog:  compact, queryable store of many clips' metadata.
+ *
+ * Clips are added from readers or from ACESclipBatch results and get
+ * consecutive ids.  Each field is kept in a column of 32-bit ids into
+ * string dictionaries, so repeated names (IDTs, ODTs, LMTs) are stored
+ * once.  Lookups by IDT, ODT, RRT, RRTODT, Source_MediaID (exact or by
+ * prefix) and LMT go through indexes instead of scanning all clips.
+ *
+ * Indexes are built on the first query after clips are added, or by
+ * calling index().  Once indexed, queries can be run from many threads
+ * at the same time; adding clips must not overlap with queries.
+ */
+class ACES_EXPORT ACESclipCatalog
+{
+  public:
+    typedef unsigned int ClipId;
+    typedef std::vector< ClipId > Clips;
+
+    /**
+     * Clips matching a query, sorted by id.  Points into the catalog,
+     * and is valid until the next clip is added.
+     */
+    struct Range
+    {
+        Range() : first( NULL ), last( NULL ) {}
+        Range( const ClipId* f, const ClipId* l ) : first( f ), last( l ) {}
+
+        const ClipId* begin() const { return first; }
+        const ClipId* end() const   { return last; }
+        size_t size() const         { return last - first; }
+        bool empty() const          { return first == last; }
+        ClipId operator[]( size_t i ) const { return first[i]; }
+
+        const ClipId* first;
+        const ClipId* last;
+    };
+
+  protected:
+    /**
+     * Dictionary of strings, each stored once and given a dense id.
+     * Id 0 is the empty string.
+     */
+    class Strings
+    {
+      public:
+        Strings();
+
+        unsigned intern( const std::string& s );
+        bool find( const char* s, size_t len, unsigned& id ) const;
+        const char* str( unsigned id ) const { return &_chars[_offsets[id]]; }
+        size_t length( unsigned id ) const
+        {
+            size_t end = id + 1 < _offsets.size() ? _offsets[id + 1] : 
+                         _chars.size();
+            return end - _offsets[id] - 1;
+        }
+        size_t size() const { return _offsets.size(); }
+        size_t memory() const;
+        void clear();
+
+      protected:
+        void grow();
+
+        std::vector< char >     _chars;    // NUL terminated strings
+        std::vector< unsigned > _offsets;  // id -> offset in _chars
+        std::vector< unsigned > _table;    // open addressing, id + 1
+    };
+
+    /**
+     * Clips per value of a column, in compressed sparse row form.
+     */
+    struct Index
+    {
+        Range find( unsigned value ) const;
+        size_t memory() const;
+        void clear();
+
+        std::vector< unsigned > offsets;  // value -> first clip
+        Clips clips;
+    };
+
+  public:
+    ACESclipCatalog();
+    ~ACESclipCatalog();
+
+    /** 
+     * Add a clip.
+     * 
+     * @param filename  file the metadata came from
+     * @param m         metadata of the clip
+     * @param error     error found when loading it
+     * 
+     * @return id of the clip
+     */
+    ClipId add( const std::string& filename, const ACESclipMetadata& m,
+                ACESclipReader::ACESError error = ACESclipReader::kAllOK );
+
+    /** 
+     * Add all the results of a batch, in order.
+     */
+    void add( const ACESclipBatch::Results& results );
+
+    /** 
+     * Reserve memory for a number of clips.
+     */
+    void reserve( size_t clips );
+
+    /** 
+     * Remove all clips.
+     */
+    void clear();
+
+    size_t size() const { return _filename.size(); }
+
+    /** 
+     * Build the indexes now instead of on the first query.
+     */
+    void index() const;
+
+    // Exact lookups
+    Range with_IDT( const std::string& name ) const;
+    Range with_ODT( const std::string& name ) const;
+    Range with_RRT( const std::string& name ) const;
+    Range with_RRTODT( const std::string& name ) const;
+    Range with_media_id( const std::string& media_id ) const;
+
+    /** 
+     * Clips whose PTL has a certain LMT, in any position.
+     */
+    Range with_LMT( const std::string& name ) const;
+
+    /** 
+     * Clips whose Source_MediaID starts with a prefix.
+     * 
+     * @param prefix  start of the media id
+     * @param clips   matching clips, sorted by id
+     */
+    void with_media_id_prefix( const std::string& prefix, 
+                               Clips& clips ) const;
+
+    /** 
+     * Clips in both of two sorted lists, to combine queries.
+     */
+    static void intersect( const Range& a, const Range& b, Clips& out );
+
+    // Values of a clip.  The strings are valid until the next add().
+    const char* filename( ClipId id ) const  { return _paths.str( _filename[id] ); }
+    const char* clip_name( ClipId id ) const { return _paths.str( _clip_name[id] ); }
+    const char* clip_date( ClipId id ) const { return _paths.str( _clip_date[id] ); }
+    const char* media_id( ClipId id ) const  { return _media.str( _media_id[id] ); }
+    const char* IDT( ClipId id ) const       { return _transforms.str( _IDT[id] ); }
+    const char* RRT( ClipId id ) const       { return _transforms.str( _RRT[id] ); }
+    const char* RRTODT( ClipId id ) const    { return _transforms.str( _RRTODT[id] ); }
+    const char* ODT( ClipId id ) const       { return _transforms.str( _ODT[id] ); }
+
+    size_t LMT_count( ClipId id ) const
+    { 
+        return _LMT_offsets[id+1] - _LMT_offsets[id];
+    }
+    const char* LMT( ClipId id, size_t i ) const
+    {
+        return _transforms.str( _LMT[ _LMT_offsets[id] + i ] );
+    }
+
+    ACESclipReader::ACESError error( ClipId id ) const
+    {
+        return ACESclipReader::ACESError( _error[id] );
+    }
+
+    /** 
+     * @return bytes of memory used by the columns, dictionaries and
+     *         indexes.
+     */
+    size_t memory() const;
+
+  private:
+    ACESclipCatalog( const ACESclipCatalog& );
+    ACESclipCatalog& operator=( const ACESclipCatalog& );
+
+  protected:
+    Range find( const Strings& dict, const Index& idx,
+                const std::string& name ) const;
+    void build_index( Index& idx, const Strings& dict,
+                      const std::vector< unsigned >& column ) const;
+    void build_indexes();
+
+  protected:
+    // Dictionaries
+    Strings _paths;        // filename, clip_name, clip_date
+    Strings _media;        // Source_MediaID
+    Strings _transforms;   // IDT, LMT, RRT, RRTODT and ODT names
+
+    // Columns, one entry per clip
+    std::vector< unsigned > _filename, _clip_name, _clip_date, _media_id;
+    std::vector< unsigned > _IDT, _RRT, _RRTODT, _ODT;
+    std::vector< unsigned char > _error;
+
+    // LMTs of clip i are _LMT[ _LMT_offsets[i] .. _LMT_offsets[i+1] )
+    std::vector< unsigned > _LMT_offsets;
+    std::vector< unsigned > _LMT;
+
+    // Indexes, rebuilt when clips were added
+    Index _by_IDT, _by_ODT, _by_RRT, _by_RRTODT, _by_media_id, _by_LMT;
+    std::vector< unsigned > _media_sorted;   // media ids sorted by string
+
+    mutable std::atomic<bool> _indexed;
+    mutable std::mutex        _index_mutex;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipCatalog_h
@@ -0,0 +1,132 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipMetadata_h
+#define ACESclipMetadata_h
+
+#include <string>
+#include <vector>
+
+#include "ACES_ASC_CDL.h"
+#include "ACESTransform.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipMetadata:  the values read from an ACESclip.xml file.
+ *
+ * ACESclipReader fills them in.  They are kept apart from the reader so
+ * they can be copied, stored and passed around on their own.
+ */
+struct ACES_EXPORT ACESclipMetadata
+{
+   enum BitDepth
+   {
+   k10i,
+   k12i,
+   k16i,
+   k16f,
+   k32f,
+   kLastBitDepth
+   };
+
+/**
+ * Look Modification Transforms is a list
+ */
+    typedef std::vector< Transform > LMTransforms;
+    typedef std::vector< std::string > GradeRefs;
+
+    ACESclipMetadata() :
+    graderef_status( kLastStatus ),
+    in_bit_depth( kLastBitDepth ),
+    out_bit_depth( kLastBitDepth )
+    {
+    }
+
+    /** 
+     * Empty all the values so the metadata can be filled again.  Strings
+     * and lists keep the memory they had, so refilling them with values
+     * of a similar size does not allocate.
+     */
+    void reset()
+    {
+        application.clear();
+        version.clear();
+        comment.clear();
+        clip_name.clear();
+        media_id.clear();
+        clip_date.clear();
+        timestamp.clear();
+        graderef_status = kLastStatus;
+        convert_to.clear();
+        convert_from.clear();
+        in_bit_depth = out_bit_depth = kLastBitDepth;
+        grade_refs.clear();
+        sops.reset();
+        IDT.reset();
+        LMT.clear();
+        RRTODT.reset();
+        RRT.reset();
+        ODT.reset();
+        link_ITL.clear();
+        link_PTL.clear();
+    }
+
+    // aces:Info
+    std::string application;
+    std::string version;
+    std::string comment;
+
+    // aces:clipID
+    std::string clip_name;
+    std::string media_id;
+    std::string clip_date;
+
+    // aces:Config
+    std::string timestamp;
+
+    // aces::GradeRef
+    TransformStatus graderef_status;
+    std::string convert_to, convert_from;
+    BitDepth in_bit_depth, out_bit_depth;
+    GradeRefs grade_refs;
+    ASC_CDL  sops;
+
+    Transform IDT;
+    LMTransforms LMT;
+    Transform RRTODT, RRT, ODT;
+    std::string link_ITL;
+    std::string link_PTL;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipMetadata_h
@@ -0,0 +1,190 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipPatch_h
+#define ACESclipPatch_h
+
+#include <string>
+#include <vector>
+
+#include "ACESclipReader.h"
+#include "ACES_ASC_CDL.h"
+#include "ACESExport.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipPatch:  change a few values of existing ACESclip files.
+ *
+ * A patch is a list of element texts and attribute values to replace.
+ * apply() scans the original bytes in place, like
+ * ACESclipReader::load_mapped(), and copies them through unchanged but
+ * for the text or attribute values of the elements the patch names.
+ * Everything else in the file, including elements and attributes the
+ * library does not know about, comments and layout, is kept as it was.
+ *
+ * Elements are found by name anywhere in the document.  A text is only
+ * replaced in elements that hold no other elements.  An attribute that
+ * is missing is added.
+ *
+ *     ACES::ACESclipPatch p;
+ *     p.cdl( grade );
+ *     p.ODT( "ODT.Academy.P3D60_48nits.a1.0.3" );
+ *     for ( ... )
+ *         p.patch_file( filename );
+ *
+ * A patch can be applied from several threads at once.
+ */
+class ACES_EXPORT ACESclipPatch
+{
+  public:
+    typedef ACESclipReader::ACESError ACESError;
+
+    /// Occurrence that stands for all the elements with a name
+    static const int kAll = -1;
+
+  public:
+    ACESclipPatch();
+
+    /** 
+     * Remove all the changes.
+     */
+    void clear();
+
+    /** 
+     * Replace the text of an element.
+     * 
+     * @param element     element name, like "ClipName"
+     * @param text        new text, not escaped
+     * @param occurrence  which element with that name, from 0, or kAll
+     */
+    void set_text( const std::string& element, const std::string& text,
+                   int occurrence = kAll );
+
+    /** 
+     * Replace, or add, an attribute of an element.
+     * 
+     * @param element     element name, like "aces:ODTref"
+     * @param attribute   attribute name, like "TransformID"
+     * @param value       new value, not escaped
+     * @param occurrence  which element with that name, from 0, or kAll
+     */
+    void set_attribute( const std::string& element, 
+                        const std::string& attribute,
+                        const std::string& value,
+                        int occurrence = kAll );
+
+    /** 
+     * Slope, Offset, Power and Saturation of every ASC_CDL, written as
+     * the writers write them.
+     */
+    void cdl( const ASC_CDL& c );
+
+    /// TransformID of the Convert_to_WorkSpace of every GradeRef
+    void convert_to( const std::string& name );
+    /// TransformID of the Convert_from_WorkSpace of every GradeRef
+    void convert_from( const std::string& name );
+
+    /// TransformID of the IDT
+    void IDT( const std::string& name );
+    /// TransformID of an LMT of the PTL, by position from 0
+    void LMT( int index, const std::string& name );
+    /// TransformID of the RRT
+    void RRT( const std::string& name );
+    /// TransformID of the combined RRT and ODT
+    void RRTODT( const std::string& name );
+    /// TransformID of the ODT
+    void ODT( const std::string& name );
+
+    /** 
+     * Set ModificationTime to the time of each apply(), as a writer
+     * would.  On by default.
+     */
+    void touch( bool t ) { _touch = t; }
+    bool touch() const   { return _touch; }
+
+    /** 
+     * Patch a document in memory.
+     * 
+     * @param data     the document
+     * @param size     its size in bytes
+     * @param out      patched document.  Its memory is reused.
+     * @param changed  if not NULL, set to the number of values replaced
+     * 
+     * @return kAllOK, kNotAnAcesFile or kErrorParsingElement.  out is
+     *         only valid on kAllOK.
+     */
+    ACESError apply( const char* data, size_t size, std::string& out,
+                     size_t* changed = NULL ) const;
+
+    /** 
+     * Patch a file into memory.  The file is mapped, not read.
+     * 
+     * @return as above, or kFileError if the file could not be opened.
+     */
+    ACESError apply( const char* filename, std::string& out,
+                     size_t* changed = NULL ) const;
+
+    /** 
+     * Patch a file and replace it atomically with the result.  Files
+     * where nothing would change are not rewritten.  The new file is
+     * synced before it is renamed over the old one, and its directory
+     * after, so a crash leaves one or the other, never a torn file.
+     * The file keeps its permissions and, where allowed, its owner.  A
+     * symlink is followed, and the file it points to is patched.
+     * 
+     * @return as above, or kFileError if the file could not be opened
+     *         or written.
+     */
+    ACESError patch_file( const char* filename, 
+                          size_t* changed = NULL ) const;
+
+  protected:
+    struct Change
+    {
+        std::string element;
+        std::string attribute;   // empty to replace the text
+        std::string value;       // escaped
+        int         occurrence;
+    };
+
+    typedef std::vector< Change > Changes;
+
+    void add( const std::string& element, const std::string& attribute,
+              const std::string& value, int occurrence );
+
+  protected:
+    Changes _changes;
+    bool    _touch;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipPatch_h
@@ -30,20 +30,11 @@ either expressed or implied, of the FreeBSD Project.
 #ifndef ACESclipReader_h
 #define ACESclipReader_h
 
-#include <tinyxml2.h>
-
-#include <locale.h>
-
-#ifdef _WIN32
-#include <stdlib.h>
-#define locale_t _locale_t
-#else
-#include <xlocale.h>
-#endif
+#include <iosfwd>
 
+#include <tinyxml2.h>
 
-#include "ACES_ASC_CDL.h"
-#include "ACESTransform.h"
+#include "ACESclipMetadata.h"
 #include "ACESExport.h"
 
 
@@ -56,7 +47,7 @@ using namespace tinyxml2;
  *
  */
  
-class ACES_EXPORT ACESclipReader
+class ACES_EXPORT ACESclipReader : public ACESclipMetadata
 {
   public:
     enum ACESError
@@ -75,27 +66,30 @@ class ACES_EXPORT ACESclipReader
     kLastError
     };
 
-   enum BitDepth
+   /**
+    * Sections that probe() can be asked for.  The header
+    * (ContainerFormatVersion) is always read.
+    */
+   enum Section
    {
-   k10i,
-   k12i,
-   k16i,
-   k16f,
-   k32f,
-   kLastBitDepth
+   kSectionInfo     = 1 << 0,   // application, version, comment
+   kSectionClipID   = 1 << 1,   // clip_name, media_id, clip_date
+   kSectionConfig   = 1 << 2,   // ACESrelease_Version check, timestamp
+   kSectionITL      = 1 << 3,   // IDT, link_ITL
+   kSectionGradeRef = 1 << 4,   // GradeRef and its ASC_CDL
+   kSectionPTL      = 1 << 5,   // LMT, RRTODT, RRT, ODT, link_PTL
+   kAllSections     = ( 1 << 6 ) - 1
    };
 
-/**
- * Look Modification Transforms is a list
- */
-    typedef std::vector< Transform > LMTransforms;
-    typedef std::vector< std::string > GradeRefs;
-
   protected:
     std::string     date_time( const char* dt );
+    void            date_time( const char* dt, std::string& out );
     TransformStatus get_status( const std::string& s );
     BitDepth        get_bit_depth( const std::string& s );
     void parse_V3( const char* s, float out[3] );
+    ACESError scan( const char* begin, const char* end,
+                    unsigned sections = kAllSections );
+    ACESError parse();
 
   public:
     ACESclipReader();
@@ -103,6 +97,14 @@ class ACES_EXPORT ACESclipReader
 
     const char* error_name( ACESError err ) const;
 
+    /** 
+     * Empty the reader so it can load another file.  The metadata
+     * strings and lists keep their capacity, so refilling them does not
+     * allocate.  The XML document is cleared and allocates again for
+     * each file it parses.  Every load() and probe() calls it first.
+     */
+    void reset();
+
     ACESError header();
     ACESError info();
     ACESError clip_id();
@@ -120,38 +122,66 @@ class ACES_EXPORT ACESclipReader
      */
     ACESError load( const char* filename );
 
-  public:
-    // aces:Info
-    std::string application;
-    std::string version;
-    std::string comment;
-
-    // aces:clipID
-    std::string clip_name;
-    std::string media_id;
-    std::string clip_date;
-
-    // aces:Config
-    std::string timestamp;
-
-    // aces::GradeRef
-    TransformStatus graderef_status;
-    std::string convert_to, convert_from;
-    BitDepth in_bit_depth, out_bit_depth;
-    GradeRefs grade_refs;
-    ASC_CDL  sops;
-
-    Transform IDT;
-    LMTransforms LMT;
-    Transform RRTODT, RRT, ODT;
-    std::string link_ITL;
-    std::string link_PTL;
+    /** 
+     * Load the XML data from a memory buffer.
+     * 
+     * @param data  XML contents (need not be NUL terminated)
+     * @param len   size of data, in bytes.
+     * 
+     * @return ACESError.
+     */
+    ACESError load( const char* data, size_t len );
+
+    /** 
+     * Load the XML data from a stream, read until its end.
+     * 
+     * @param in  stream to read the XML contents from.
+     * 
+     * @return ACESError.
+     */
+    ACESError load( std::istream& in );
+
+    /** 
+     * Load the XML file by mapping it in memory and scanning it in
+     * place, without building a tinyxml2 document.  Values are only
+     * copied out of the mapping when they are stored in the fields
+     * below, which end up the same as with load().
+     * 
+     * @param filename  file to load xml from.
+     * 
+     * @return ACESError.
+     */
+    ACESError load_mapped( const char* filename );
+
+    /** 
+     * Read only some sections of the XML file.  The file is scanned
+     * without building a tinyxml2 document and scanning stops as soon
+     * as all the requested sections have been read, so the rest of
+     * the file is neither read nor checked for errors.  Fields of
+     * sections not asked for are left untouched.
+     * 
+     * @param filename  file to load xml from.
+     * @param sections  Section flags or'ed together.
+     * 
+     * @return ACESError for the requested sections.
+     */
+    ACESError probe( const char* filename, unsigned sections );
+
+    /** 
+     * Same as above, on XML data already in memory.
+     * 
+     * @param data      XML contents (need not be NUL terminated)
+     * @param len       size of data, in bytes.
+     * @param sections  Section flags or'ed together.
+     * 
+     * @return ACESError for the requested sections.
+     */
+    ACESError probe( const char* data, size_t len, unsigned sections );
 
   protected:
     tinyxml2::XMLDocument doc;
     XMLElement* element;
     XMLNode* root, *root2, *root3, *root4;
-    locale_t loc;
 };
 
 
@@ -0,0 +1,233 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipStreamWriter_h
+#define ACESclipStreamWriter_h
+
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "ACESExport.h"
+#include "ACESTransform.h"
+#include "ACES_ASC_CDL.h"
+#include "ACESclipWriter.h"
+
+namespace ACES {
+
+class XMLStream;
+
+/**
+ * ACESclipStreamWriter:  writes an ACESclip.xml file without a DOM.
+ *
+ * It takes the same calls as ACESclipWriter and produces the same bytes,
+ * but each call appends its XML straight to a buffer, or to a file
+ * descriptor, instead of building tinyxml2 nodes first.
+ *
+ * As nothing is kept in memory, the calls must come in document order,
+ * as in the examples: info(), clip_id(), config(), then the ITL (with
+ * any GradeRef) and the PTL.  Elements are closed as soon as a call
+ * moves past them and cannot be added to afterwards.
+ */
+class ACES_EXPORT ACESclipStreamWriter
+{
+  protected:
+/**
+ * Look Modification Transforms is a list
+ */
+    typedef std::vector< Transform > LMTransforms;
+
+  public:
+    /**
+     * Text that changes from document to document, which
+     * ACESclipTemplate fills in for each clip.
+     */
+    enum Field
+    {
+        kUUID,
+        kModificationTime,
+        kClipName,
+        kSourceMediaID,
+        kClipDate,
+        kTimestamp,
+        kSlope,
+        kOffset,
+        kPower,
+        kSaturation,
+        kFieldCount
+    };
+
+  public:
+    /** 
+     * Write into an internal buffer, read with data() and size() or
+     * written out with save().
+     */
+    ACESclipStreamWriter();
+
+    /** 
+     * Write to a file descriptor (a file, pipe or socket), in chunks as
+     * the buffer fills up, and the rest on finish().  The descriptor is
+     * not closed.
+     * 
+     * @param fd  file descriptor open for writing
+     */
+    explicit ACESclipStreamWriter( int fd );
+
+    ~ACESclipStreamWriter();
+
+    /** 
+     * Start a new document, with a new UUID and ModificationTime.  The
+     * buffer keeps its memory.
+     */
+    void reset();
+
+    void info( const std::string application = "ACESclipLib",
+               const std::string version = kLibVersion,
+               const std::string comment = "" );
+
+    void clip_id( const std::string clip_name,
+                  const std::string media_id,
+                  const time_t clip_date = time(0) );
+
+    void config( const time_t xml_date = time(0) );
+
+    void gradeRef_start( const std::string convert_to,
+                         const TransformStatus status = kPreview,
+                         ACESclipMetadata::BitDepth in_depth = 
+                         ACESclipMetadata::k32f,
+                         ACESclipMetadata::BitDepth out_depth = 
+                         ACESclipMetadata::k32f );
+    void gradeRef_SOPNode( const ASC_CDL& c );
+    void gradeRef_SatNode( const ASC_CDL& c );
+    void gradeRef_end( const std::string convert_from );
+
+    void ITL_start( TransformStatus status = kPreview );
+    void add_IDT( const std::string name, 
+                  TransformStatus status = kPreview );
+    void ITL_end( const std::string it = "" );
+
+    void PTL_start();
+    void add_LMT( const std::string name, 
+                  TransformStatus status = kPreview,
+                  const std::string link_transform = "" );
+    void add_RRT( const std::string name, 
+                  TransformStatus status = kPreview );
+    void add_ODT( const std::string name, 
+                  TransformStatus status = kPreview,
+                  const std::string link_transform = "" );
+    void add_RRTODT( const std::string name, 
+                     TransformStatus status = kPreview );
+    void PTL_end( const std::string t = "" );
+
+    /** 
+     * Close all the elements still open, ending the document, and send
+     * what is left to the file descriptor, if any.
+     * 
+     * @return false if writing to the file descriptor failed.
+     */
+    bool finish();
+
+    /** 
+     * The document written so far.  Call finish() first for a complete
+     * one.  Empty when writing to a file descriptor.
+     */
+    const char* data() const { return _buffer.data(); }
+    size_t      size() const { return _buffer.size(); }
+
+    /** 
+     * Finish the document and save it to a file.
+     * 
+     * @param filename  file to save xml into.
+     * 
+     * @return true if success, false if not.
+     */
+    bool save( const char* filename );
+
+    /** 
+     * Finish the document and copy it to a string.
+     * 
+     * @param out  the document.  Its memory is reused.
+     */
+    void save_to_string( std::string& out );
+
+    /** 
+     * Finish the document and copy it to a buffer, if it fits.  It is
+     * NUL terminated if there is room for it.
+     * 
+     * @param buffer  where to copy the document, or NULL.
+     * @param size    size of buffer, in bytes.
+     * 
+     * @return size of the document in bytes, without a NUL.  If larger
+     *         than size, nothing was copied.
+     */
+    size_t save_to_buffer( char* buffer, size_t size );
+
+    /** 
+     * Finish the document and write it to a file descriptor (a file,
+     * pipe or socket).  The descriptor is not closed.
+     * 
+     * @return true on success, false on error or if the writer was
+     *         built on a file descriptor itself.
+     */
+    bool save_to_fd( int fd );
+
+  private:
+    ACESclipStreamWriter( const ACESclipStreamWriter& );
+    ACESclipStreamWriter& operator=( const ACESclipStreamWriter& );
+
+  protected:
+    /**
+     * Where the text of a Field was written in the buffer.
+     */
+    struct Slot
+    {
+        Field  field;
+        size_t begin, end;
+    };
+    typedef std::vector< Slot > Slots;
+
+    void header();
+    void field( Field f, const char* name, const char* text );
+    void transform( const char* element, const Transform& t );
+    void flush( bool all );
+
+  protected:
+    std::string _buffer;
+    XMLStream*  _xml;
+    Slots*      _slots;   // where field() records Slots, if not NULL
+    int         _fd;
+    bool        _ok;
+
+    LMTransforms LMT;
+    Transform IDT, RRT, RRTODT, ODT;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipStreamWriter_h
@@ -0,0 +1,123 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipTemplate_h
+#define ACESclipTemplate_h
+
+#include <time.h>
+#include <string>
+
+#include "ACESExport.h"
+#include "ACES_ASC_CDL.h"
+#include "ACESclipStreamWriter.h"
+
+
+namespace ACES {
+
+/**
+ * ACESclipTemplate:  writes many documents that differ only in a few
+ * fields, such as the sidecars of every clip of a show.
+ *
+ * The template is written once with the ACESclipStreamWriter calls, in
+ * the same order, which records where the text of each Field went.
+ * stamp() then copies the bytes around those fields and fills in the
+ * ones of each clip: a new UUID and ModificationTime always, and the
+ * ClipName, Source_MediaID, dates and CDL given in a Clip.  Fields the
+ * template did not write (no GradeRef, for example) are ignored.
+ *
+ * The output is the same as writing the clip with ACESclipStreamWriter
+ * or ACESclipWriter.  Call finish() before stamping; after that, stamp()
+ * can be called from several threads at once.  reset() starts a new
+ * template.
+ *
+ *     ACES::ACESclipTemplate t;
+ *     t.info( "mrViewer", "v2.6.9" );
+ *     t.clip_id( "", "" );
+ *     ...
+ *     t.finish();
+ *
+ *     ACES::ACESclipTemplate::Clip c;
+ *     c.clip_name = "A001C003.exr";
+ *     c.media_id = "A001";
+ *     t.stamp_to_file( "A001C003.xml", c );
+ */
+class ACES_EXPORT ACESclipTemplate : public ACESclipStreamWriter
+{
+  public:
+    /**
+     * The fields of one document.
+     */
+    struct ACES_EXPORT Clip
+    {
+        Clip();
+
+        const char* clip_name;   ///< ClipName, or NULL to keep the template's
+        const char* media_id;    ///< Source_MediaID, or NULL to keep it
+        time_t clip_date;        ///< ClipDate, now by default
+        time_t xml_date;         ///< Timestamp, now by default
+        const ASC_CDL* cdl;      ///< Slope to Saturation, or NULL to keep them
+    };
+
+  public:
+    ACESclipTemplate();
+
+    /** 
+     * Write one document.
+     * 
+     * @param c    fields of the document
+     * @param out  the document.  Its memory is reused.
+     */
+    void stamp( const Clip& c, std::string& out ) const;
+
+    /** 
+     * Write one document to a file.
+     * 
+     * @return true if success, false if not.
+     */
+    bool stamp_to_file( const char* filename, const Clip& c ) const;
+
+    /** 
+     * Write one document to a file descriptor (a file, pipe or socket).
+     * The descriptor is not closed.
+     * 
+     * @return true on success, false on failure.
+     */
+    bool stamp_to_fd( int fd, const Clip& c ) const;
+
+  private:
+    ACESclipTemplate( const ACESclipTemplate& );
+    ACESclipTemplate& operator=( const ACESclipTemplate& );
+
+  protected:
+    Slots _fields;
+};
+
+}  // namespace ACES
+
+#endif  // ACESclipTemplate_h
@@ -37,6 +37,7 @@ either expressed or implied, of the FreeBSD Project.
 #include "ACESExport.h"
 #include "ACESTransform.h"
 #include "ACES_ASC_CDL.h"
+#include "ACESclipMetadata.h"
 
 namespace ACES {
 
@@ -62,11 +63,19 @@ class ACES_EXPORT ACESclipWriter
   protected:
     std::string date_time( const time_t& t ) const;
     void set_status( TransformStatus s );
+    void header();
 
   public:
     ACESclipWriter();
     ~ACESclipWriter() {};
 
+    /** 
+     * Start a new document, with a new UUID and ModificationTime, as if
+     * the writer had just been constructed.  The XML document is
+     * cleared, so the next one allocates its nodes again.
+     */
+    void reset();
+
     /** 
      * aces:Info section
      * 
@@ -97,8 +106,20 @@ class ACES_EXPORT ACESclipWriter
     void config( const time_t xml_date = time(0) );
 
 
+    /** 
+     * aces:GradeRef section beginning.
+     * 
+     * @param convert_to  TransformID of the conversion to the workspace
+     * @param status      status of the grade (preview or applied)
+     * @param in_depth    inBitDepth of the ASC_CDL
+     * @param out_depth   outBitDepth of the ASC_CDL
+     */
     void gradeRef_start( const std::string convert_to,
-                         const TransformStatus status = kPreview );
+                         const TransformStatus status = kPreview,
+                         ACESclipMetadata::BitDepth in_depth = 
+                         ACESclipMetadata::k32f,
+                         ACESclipMetadata::BitDepth out_depth = 
+                         ACESclipMetadata::k32f );
     void gradeRef_SOPNode( const ASC_CDL& c );
     void gradeRef_SatNode( const ASC_CDL& c );
     void gradeRef_end( const std::string convert_from );
@@ -192,6 +213,33 @@ class ACES_EXPORT ACESclipWriter
      */
     bool save( const char* filename );
 
+    /** 
+     * Print the XML file into a string.
+     * 
+     * @param out  the XML file.  Its memory is reused.
+     */
+    void save_to_string( std::string& out ) const;
+
+    /** 
+     * Print the XML file into a buffer, if it fits.  It is NUL
+     * terminated if there is room for it.
+     * 
+     * @param buffer  where to print the XML file, or NULL.
+     * @param size    size of buffer, in bytes.
+     * 
+     * @return size of the XML file in bytes, without a NUL.  If larger
+     *         than size, nothing was copied.
+     */
+    size_t save_to_buffer( char* buffer, size_t size ) const;
+
+    /** 
+     * Write the XML file to a file descriptor (a file, pipe or socket).
+     * The descriptor is not closed.
+     * 
+     * @return true on success, false on failure.
+     */
+    bool save_to_fd( int fd ) const;
+
   protected:
     XMLDocument doc;
     XMLElement* element;
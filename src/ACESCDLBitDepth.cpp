@@ -0,0 +1,239 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <stdint.h>
+
+#include "ACESCDLBitDepth.h"
+#include "ACESCDLKernels.h"
+#include "ACESHalf.h"
+
+
+namespace ACES {
+
+// Pixels converted at a time
+static const size_t kDepthBlock = 256;
+
+static bool is_integer( ACESclipMetadata::BitDepth d )
+{
+    return d == ACESclipMetadata::k10i || d == ACESclipMetadata::k12i ||
+           d == ACESclipMetadata::k16i;
+}
+
+static ACESclipMetadata::BitDepth known( ACESclipMetadata::BitDepth d )
+{
+    return d < ACESclipMetadata::kLastBitDepth ? d : ACESclipMetadata::k32f;
+}
+
+/** 
+ * A block of pixels as floats, one plane per channel.
+ */
+struct DepthBlock
+{
+    float r[kDepthBlock], g[kDepthBlock], b[kDepthBlock], a[kDepthBlock];
+};
+
+/** 
+ * Read n samples of one channel, every channels samples, as floats
+ * from 0 to 1 for integer depths.
+ */
+static void read_channel( ACESclipMetadata::BitDepth d, const void* in,
+                          unsigned channels, size_t n, float* out )
+{
+    if ( d == ACESclipMetadata::k32f )
+    {
+        const float* s = (const float*) in;
+        for ( size_t k = 0; k < n; ++k )
+            out[k] = s[k * channels];
+    }
+    else if ( d == ACESclipMetadata::k16f )
+    {
+        const uint16_t* s = (const uint16_t*) in;
+        for ( size_t k = 0; k < n; ++k )
+            out[k] = half_to_float( s[k * channels] );
+    }
+    else
+    {
+        const uint16_t* s = (const uint16_t*) in;
+        unsigned top = CDLBitDepthProcessor::max_code( d );
+        float scale = 1.0f / top;
+        for ( size_t k = 0; k < n; ++k )
+        {
+            unsigned c = s[k * channels];
+            out[k] = ( c < top ? c : top ) * scale;
+        }
+    }
+}
+
+/** 
+ * Write n floats as samples of one channel, every channels samples.
+ */
+static void write_channel( ACESclipMetadata::BitDepth d, const float* in,
+                           unsigned channels, size_t n, void* out )
+{
+    if ( d == ACESclipMetadata::k32f )
+    {
+        float* s = (float*) out;
+        for ( size_t k = 0; k < n; ++k )
+            s[k * channels] = in[k];
+    }
+    else if ( d == ACESclipMetadata::k16f )
+    {
+        uint16_t* s = (uint16_t*) out;
+        for ( size_t k = 0; k < n; ++k )
+            s[k * channels] = float_to_half( in[k] );
+    }
+    else
+    {
+        uint16_t* s = (uint16_t*) out;
+        float top = (float) CDLBitDepthProcessor::max_code( d );
+        for ( size_t k = 0; k < n; ++k )
+        {
+            float v = in[k] * top + 0.5f;
+            if ( !( v > 0.0f ) ) v = 0.0f;     // NaN too
+            if ( v > top ) v = top;
+            s[k * channels] = (uint16_t) v;
+        }
+    }
+}
+
+
+CDLBitDepthProcessor::CDLBitDepthProcessor( const ASC_CDL& cdl,
+                                            BitDepth in_depth, 
+                                            BitDepth out_depth )
+{
+    set( cdl, in_depth, out_depth );
+}
+
+CDLBitDepthProcessor::CDLBitDepthProcessor( const ACESclipMetadata& m )
+{
+    set( m.sops, m.in_bit_depth, m.out_bit_depth );
+}
+
+void CDLBitDepthProcessor::set( const ASC_CDL& cdl, BitDepth in_depth,
+                                BitDepth out_depth )
+{
+    _processor.cdl( cdl );
+    _in = known( in_depth );
+    _out = known( out_depth );
+
+    // Point i of a 1D table from 0 to 1 with max_code + 1 points is
+    // code i
+    if ( is_integer( _in ) )
+        _codes.bake( cdl, CDLLut::Shape( CDLLut::k1D, max_code( _in ) + 1 ) );
+    else
+        _codes = CDLLut();
+}
+
+size_t CDLBitDepthProcessor::sample_size( BitDepth d )
+{
+    return known( d ) == ACESclipMetadata::k32f ? 4 : 2;
+}
+
+unsigned CDLBitDepthProcessor::max_code( BitDepth d )
+{
+    switch( d )
+    {
+        case ACESclipMetadata::k10i:
+            return 1023;
+        case ACESclipMetadata::k12i:
+            return 4095;
+        case ACESclipMetadata::k16i:
+            return 65535;
+        default:
+            return 1;
+    }
+}
+
+void CDLBitDepthProcessor::apply( const void* in, void* out, size_t pixels,
+                                  unsigned channels ) const
+{
+    if ( channels != 4 ) channels = 3;
+
+    // Same depth, float: nothing to convert
+    if ( _in == ACESclipMetadata::k32f && _out == ACESclipMetadata::k32f )
+    {
+        _processor.apply( (const float*) in, (float*) out, pixels, 
+                          channels );
+        return;
+    }
+
+    const size_t in_size = sample_size( _in ), out_size = sample_size( _out );
+    const char* src = (const char*) in;
+    char* dst = (char*) out;
+    const float sat = _processor.cdl().saturation();
+    const float* luma = _processor.luma_weights();
+
+    DepthBlock block;
+    for ( size_t done = 0; done < pixels; done += kDepthBlock )
+    {
+        size_t n = pixels - done;
+        if ( n > kDepthBlock ) n = kDepthBlock;
+        const char* s = src + done * channels * in_size;
+        char* d = dst + done * channels * out_size;
+
+        if ( is_integer( _in ) )
+        {
+            // Each code straight to its curve value, then saturation
+            const uint16_t* codes = (const uint16_t*) s;
+            const float* t = &_codes.table()[0];
+            const unsigned top = max_code( _in );
+            for ( size_t k = 0; k < n; ++k )
+            {
+                const uint16_t* p = codes + k * channels;
+                unsigned cr = p[0] < top ? p[0] : top;
+                unsigned cg = p[1] < top ? p[1] : top;
+                unsigned cb = p[2] < top ? p[2] : top;
+                float r = t[cr * 3], g = t[cg * 3 + 1], b = t[cb * 3 + 2];
+                cdl_saturate( luma, sat, r, g, b );
+                block.r[k] = r;
+                block.g[k] = g;
+                block.b[k] = b;
+            }
+        }
+        else
+        {
+            read_channel( _in, s, channels, n, block.r );
+            read_channel( _in, s + in_size, channels, n, block.g );
+            read_channel( _in, s + 2 * in_size, channels, n, block.b );
+            _processor.apply_planes( block.r, block.g, block.b, n );
+        }
+
+        // Alpha is read before anything is written, in case in == out
+        if ( channels == 4 )
+            read_channel( _in, s + 3 * in_size, 4, n, block.a );
+
+        write_channel( _out, block.r, channels, n, d );
+        write_channel( _out, block.g, channels, n, d + out_size );
+        write_channel( _out, block.b, channels, n, d + 2 * out_size );
+        if ( channels == 4 )
+            write_channel( _out, block.a, 4, n, d + 3 * out_size );
+    }
+}
+
+}  // namespace ACES
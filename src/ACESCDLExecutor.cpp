@@ -0,0 +1,142 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <atomic>
+#include <memory>
+
+#include "ACESCDLExecutor.h"
+
+
+namespace ACES {
+
+// Fits a band read and written in the L2 cache of most cores
+static const size_t kBandBytes = 256 * 1024;
+
+/** 
+ * Apply a processor to rows [first, last) of a frame.
+ */
+static void apply_rows( const CDLProcessor& p, const CDLFrame& f,
+                        size_t first, size_t last )
+{
+    size_t row = f.width * f.channels;
+    size_t in_stride  = f.in_stride  ? f.in_stride  : row;
+    size_t out_stride = f.out_stride ? f.out_stride : row;
+
+    if ( in_stride == row && out_stride == row )
+    {
+        p.apply( f.in + first * row, f.out + first * row, 
+                 ( last - first ) * f.width, f.channels, f.precision );
+        return;
+    }
+
+    for ( size_t y = first; y < last; ++y )
+        p.apply( f.in + y * in_stride, f.out + y * out_stride, f.width, 
+                 f.channels, f.precision );
+}
+
+/**
+ * A frame being applied asynchronously, shared by its bands.  The last
+ * band to finish calls done.
+ */
+struct CDLJob
+{
+    CDLProcessor          processor;
+    CDLFrame              frame;
+    size_t                rows;
+    std::atomic< size_t > remaining;
+    CDLExecutor::Callback done;
+};
+
+static void run_band( const std::shared_ptr< CDLJob >& job, size_t first )
+{
+    size_t last = first + job->rows;
+    if ( last > job->frame.height ) last = job->frame.height;
+    apply_rows( job->processor, job->frame, first, last );
+
+    if ( job->remaining.fetch_sub( 1 ) == 1 && job->done ) job->done();
+}
+
+
+CDLExecutor::CDLExecutor( const CDLProcessor& p, ThreadPool* pool ) :
+_processor( p ),
+_pool( pool ? pool : &ThreadPool::global() ),
+_band_bytes( kBandBytes )
+{
+}
+
+size_t CDLExecutor::band_rows( const CDLFrame& f ) const
+{
+    size_t row_bytes = f.width * f.channels * sizeof(float);
+    if ( row_bytes == 0 ) return 1;
+    size_t rows = _band_bytes / row_bytes;
+    return rows ? rows : 1;
+}
+
+void CDLExecutor::apply( const CDLFrame& f ) const
+{
+    if ( f.width == 0 || f.height == 0 ) return;
+
+    const CDLProcessor& p = _processor;
+    _pool->parallel_for( 0, f.height, band_rows( f ),
+                         [&p, &f]( size_t first, size_t last ) {
+                             apply_rows( p, f, first, last );
+                         } );
+}
+
+std::future< void > CDLExecutor::apply_async( const CDLFrame& f ) const
+{
+    std::shared_ptr< std::promise< void > > 
+    promise( new std::promise< void > );
+    std::future< void > future = promise->get_future();
+    apply_async( f, [promise]() { promise->set_value(); } );
+    return future;
+}
+
+void CDLExecutor::apply_async( const CDLFrame& f, 
+                               const Callback& done ) const
+{
+    if ( f.width == 0 || f.height == 0 )
+    {
+        if ( done ) done();
+        return;
+    }
+
+    std::shared_ptr< CDLJob > job( new CDLJob );
+    job->processor = _processor;
+    job->frame = f;
+    job->rows = band_rows( f );
+    job->done = done;
+
+    size_t bands = ( f.height + job->rows - 1 ) / job->rows;
+    job->remaining = bands;
+    for ( size_t first = 0; first < f.height; first += job->rows )
+        _pool->submit( [job, first]() { run_band( job, first ); } );
+}
+
+}  // namespace ACES
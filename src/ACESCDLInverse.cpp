@@ -0,0 +1,157 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include "ACESCDLInverse.h"
+#include "ACESCDLKernels.h"
+
+
+namespace ACES {
+
+/** 
+ * What the saturation of a CDL multiplies the luma by: W + saturation 
+ * ( 1 - W ), W the sum of the weights.  1 when they sum to 1.
+ */
+static double luma_gain( const ASC_CDL& c, const float luma[3] )
+{
+    double w = (double) luma[0] + luma[1] + luma[2];
+    return w + c.saturation() * ( 1.0 - w );
+}
+
+/** 
+ * The parameters of the inverse kernels: 1 / slope, -offset, 1 / power
+ * and 1 / saturation, with what cannot be undone left out.  The luma
+ * weights are divided by luma_gain(), so the kernels weigh the luma
+ * from before the saturation.
+ */
+static void make_inverse( const ASC_CDL& c, const float luma[3], 
+                          CDLParams& p )
+{
+    double gain = luma_gain( c, luma );
+    if ( gain == 0.0 ) gain = 1.0;
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        float s = c.slope(i);
+        p.slope[i]  = s != 0.0f ? 1.0f / s : 0.0f;
+        p.offset[i] = -c.offset(i);
+        p.power[i]  = c.power(i) != 0.0f ? 1.0f / c.power(i) : 1.0f;
+        p.luma[i]   = (float) ( luma[i] / gain );
+    }
+    float sat = c.saturation();
+    p.saturation = sat != 0.0f ? 1.0f / sat : 1.0f;
+}
+
+static unsigned singular_bits( const ASC_CDL& c, const float luma[3] )
+{
+    unsigned bits = 0;
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        if ( c.slope(i) == 0.0f ) bits |= kCDLZeroSlope;
+        if ( c.power(i) == 0.0f ) bits |= kCDLZeroPower;
+    }
+    if ( c.saturation() == 0.0f ) bits |= kCDLZeroSaturation;
+    else if ( luma_gain( c, luma ) == 0.0 ) bits |= kCDLZeroLuma;
+    return bits;
+}
+
+
+CDLInverse::CDLInverse( const ASC_CDL& c )
+{
+    luma( kCDLLumaRec709 );
+    cdl( c );
+    simd( simd_level() );
+}
+
+void CDLInverse::cdl( const ASC_CDL& c )
+{
+    _cdl = c;
+    _singular = singular_bits( c, _weights );
+
+    // Steps whose inverse does nothing either
+    CDLParams p;
+    make_inverse( c, _weights, p );
+    _paths = cdl_paths( p.offset[0], p.offset[1], p.offset[2],
+                        p.power[0], p.power[1], p.power[2], 
+                        p.saturation );
+}
+
+void CDLInverse::luma( CDLLuma l )
+{
+    _luma = set_luma( l, _weights );
+    _singular = singular_bits( _cdl, _weights );
+}
+
+void CDLInverse::luma( float r, float g, float b )
+{
+    _luma = kCDLLumaCustom;
+    _weights[0] = r;
+    _weights[1] = g;
+    _weights[2] = b;
+    _singular = singular_bits( _cdl, _weights );
+}
+
+void CDLInverse::simd( SIMDLevel level )
+{
+    SIMDLevel best = simd_level();
+    if ( level > best ) level = best;
+
+    int l = level;
+    while ( l > kSIMDScalar && !cdl_kernels( (SIMDLevel) l ) )
+        --l;
+    _level = (SIMDLevel) l;
+    _kernels = cdl_kernels( _level );
+}
+
+bool CDLInverse::range( unsigned short channel, float& low, 
+                        float& high ) const
+{
+    double s = _cdl.slope( channel ), o = _cdl.offset( channel );
+    if ( s == 0.0 )
+    {
+        low = high = 0.0f;
+        return false;
+    }
+
+    // in * slope + offset from 0 to 1; + 0.0 makes -0 a 0
+    double a = -o / s + 0.0, b = ( 1.0 - o ) / s + 0.0;
+    low  = (float) ( a < b ? a : b );
+    high = (float) ( a < b ? b : a );
+    return true;
+}
+
+size_t CDLInverse::apply( const float* in, float* out, size_t pixels,
+                          unsigned channels, unsigned char* flags,
+                          CDLPrecision precision ) const
+{
+    CDLParams p;
+    make_inverse( _cdl, _weights, p );
+    return _kernels->inverse[known_precision( precision )][_luma][_paths]( 
+        p, in, out, pixels, channels == 4 ? 4 : 3, flags );
+}
+
+}  // namespace ACES
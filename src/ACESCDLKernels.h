@@ -0,0 +1,202 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLKernels_h
+#define ACESCDLKernels_h
+
+#include <stddef.h>
+
+#include "ACESCDLProcessor.h"
+
+namespace ACES {
+
+// Weights of the known CDLLumas: Rec.709, as in the SatNode of the ASC
+// CDL, and the Y row of the AP0 and AP1 to XYZ matrices
+const float kCDLLumaWeights[kCDLLumaCustom][3] = {
+{ 0.2126f, 0.7152f, 0.0722f },
+{ 0.3439664498f, 0.7281660966f, -0.0721325464f },
+{ 0.2722287168f, 0.6740817658f, 0.0536895174f }
+};
+
+/** 
+ * Copy the weights of a known CDLLuma to w.  kCDLLumaCustom keeps w.
+ * 
+ * @return l, or kCDLLumaRec709 if l is unknown
+ */
+CDLLuma set_luma( CDLLuma l, float w[3] );
+
+/** 
+ * The precision the kernels run for q: q itself, or kCDLPrecise if q is
+ * unknown.  Whatever picks a kernel or reports its error goes through
+ * it, so the two agree.
+ */
+inline CDLPrecision known_precision( CDLPrecision q )
+{
+    return (unsigned) q < (unsigned) kCDLPrecisions ? q : kCDLPrecise;
+}
+
+/** 
+ * The SatNode on one pixel, for code that applies it outside the
+ * kernels.
+ */
+inline void cdl_saturate( const float luma[3], float sat, float& r, 
+                          float& g, float& b )
+{
+    float l = luma[0] * r + luma[1] * g + luma[2] * b;
+    r = l + sat * ( r - l );
+    g = l + sat * ( g - l );
+    b = l + sat * ( b - l );
+}
+
+/**
+ * What a CDLProcessor hands its kernels: the CDL and the luma weights
+ * of its SatNode, as plain floats.
+ */
+struct CDLParams
+{
+    float slope[3];
+    float offset[3];
+    float power[3];
+    float saturation;
+    float luma[3];
+};
+
+/** 
+ * The parameters of a CDL for the kernels that apply it, with the
+ * luma weights of its saturation.
+ */
+void cdl_params( const ASC_CDL& c, const float luma[3], CDLParams& p );
+
+/**
+ * Curves of the ACES spaces, applied on top of their primaries.
+ */
+enum CDLCurve
+{
+kCurveLinear,
+kCurveACEScc,
+kCurveACEScct,
+kCurves
+};
+
+/**
+ * A conversion between two ACES spaces, as the kernels run it: decode
+ * one curve to linear, change primaries with a matrix if they differ,
+ * and encode the other curve.
+ */
+struct CDLConvert
+{
+    unsigned decode;     ///< CDLCurve
+    unsigned encode;     ///< CDLCurve
+    bool     matrix;     ///< false to keep the primaries
+    float    m[9];       ///< row major, applied to column RGB
+};
+
+/**
+ * A baked CDLLut, as its kernels read it.
+ */
+struct CDLLutParams
+{
+    const float* table;       ///< RGB triplets, red fastest in 3D
+    unsigned     size;        ///< points per channel
+    float        low;         ///< input of the first point
+    float        scale;       ///< ( size - 1 ) / ( high - low )
+    float        saturation;  ///< 1D only, applied after the curves
+    float        luma[3];     ///< 1D only, weights of the saturation
+};
+
+/**
+ * Kernels of one instruction set, one of each kind per CDLPrecision,
+ * CDLLuma and combination of CDLPath bits.
+ */
+struct CDLKernels
+{
+    /** 
+     * Apply a CDL to interleaved RGB (channels 3) or RGBA (channels 4)
+     * floats.  Alpha is copied.  in and out may be the same.
+     */
+    void (*apply[kCDLPrecisions][kCDLLumas][kCDLPaths])( 
+        const CDLParams& p, const float* in, float* out, size_t pixels,
+        unsigned channels );
+
+    /** 
+     * Apply a CDL in place to pixels in three planes.
+     */
+    void (*planes[kCDLPrecisions][kCDLLumas][kCDLPaths])( 
+        const CDLParams& p, float* r, float* g, float* b, size_t pixels );
+
+    /** 
+     * Undo a CDL on interleaved floats, with the parameters CDLInverse
+     * makes.  Sets flags[i], unless flags is NULL, to the CDLClamp bits
+     * of pixel i.
+     * 
+     * @return pixels with any CDLClamp bit
+     */
+    size_t (*inverse[kCDLPrecisions][kCDLLumas][kCDLPaths])( 
+        const CDLParams& p, const float* in, float* out, size_t pixels,
+        unsigned channels, unsigned char* flags );
+
+    /** 
+     * Convert interleaved floats between ACES spaces.
+     */
+    void (*convert[kCDLPrecisions])( const CDLConvert& c, const float* in,
+                                     float* out, size_t pixels,
+                                     unsigned channels );
+
+    /** 
+     * Convert interleaved floats to the space of the CDL, apply it and
+     * convert them back, a block at a time in one pass.
+     */
+    void (*workspace[kCDLPrecisions][kCDLLumas][kCDLPaths])( 
+        const CDLParams& p, const CDLConvert& to, const CDLConvert& from,
+        const float* in, float* out, size_t pixels, unsigned channels );
+
+    /** 
+     * Apply a CDLLut to interleaved floats: its 1D curves, interpolated
+     * linearly, and then the saturation, or its 3D lattice,
+     * interpolated tetrahedrally.
+     */
+    void (*lut_1D)( const CDLLutParams& p, const float* in, float* out,
+                    size_t pixels, unsigned channels );
+    void (*lut_3D)( const CDLLutParams& p, const float* in, float* out,
+                    size_t pixels, unsigned channels );
+};
+
+// Kernels of each instruction set, or NULL if the library was built
+// without it.
+const CDLKernels* cdl_kernels_scalar();
+const CDLKernels* cdl_kernels_sse4();
+const CDLKernels* cdl_kernels_avx2();
+const CDLKernels* cdl_kernels_avx512();
+
+// The same, by SIMDLevel
+const CDLKernels* cdl_kernels( SIMDLevel level );
+
+}  // namespace ACES
+
+#endif  // ACESCDLKernels_h
@@ -0,0 +1,790 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESCDLKernelsImpl_h
+#define ACESCDLKernelsImpl_h
+
+//
+// The CDL kernels, written once over the wrappers of ACESSimd.h.  Only
+// the ACESCDLKernels_*.cpp files include this, each compiled for its
+// own instruction set.
+//
+
+#include "ACESSimd.h"
+#include "ACESCDLKernels.h"
+
+namespace ACES {
+namespace {
+
+// Pixels deinterleaved at a time
+static const size_t kCDLBlock = 256;
+
+static_assert( (int) kCDLExact == (int) kMathExact &&
+               (int) kCDLPrecise == (int) kMathPrecise &&
+               (int) kCDLFast == (int) kMathFast &&
+               (int) kCDLFastest == (int) kMathFastest,
+               "a CDLPrecision is the MathQuality of its pow()" );
+
+/** 
+ * Precision of the kernel for CDLPath bits P at precision Q.  Kernels
+ * without pow() are the same at every precision, so they share one.
+ */
+constexpr unsigned cdl_quality( unsigned P, unsigned Q )
+{
+    return P & kCDLNoPower ? (unsigned) kCDLPrecise : Q;
+}
+
+/** 
+ * CDLLuma of the kernel for CDLPath bits P with luma L.  Kernels
+ * without saturation weigh nothing, so they share one.
+ */
+constexpr unsigned cdl_luma( unsigned P, unsigned L )
+{
+    return P & kCDLNoSaturation ? (unsigned) kCDLLumaRec709 : L;
+}
+
+/** 
+ * Luma weights of CDLLuma L.  Those of the known sets are constants
+ * the kernels build in; kCDLLumaCustom reads the parameters.
+ */
+template< unsigned L >
+struct LumaWeights
+{
+    static const float* of( const CDLParams& ) { return kCDLLumaWeights[L]; }
+};
+
+template<>
+struct LumaWeights< kCDLLumaCustom >
+{
+    static const float* of( const CDLParams& p ) { return p.luma; }
+};
+
+/** 
+ * Apply a CDL to n pixels in planes, n a multiple of V::N, leaving out
+ * the steps in the CDLPath bits P, with the pow() of CDLPrecision Q
+ * and the luma weights of CDLLuma L.  The tests of P, Q and L are
+ * constant, so each kernel keeps only the steps it needs.
+ */
+template< class V, unsigned P, unsigned Q, unsigned L >
+void cdl_planes( const CDLParams& p, float* r, float* g, float* b, 
+                 size_t n )
+{
+    typedef typename V::F F;
+
+    const F sr = V::set1( p.slope[0] ), sg = V::set1( p.slope[1] ),
+            sb = V::set1( p.slope[2] );
+    const F or_ = V::set1( p.offset[0] ), og = V::set1( p.offset[1] ),
+            ob = V::set1( p.offset[2] );
+    const F pr = V::set1( p.power[0] ), pg = V::set1( p.power[1] ),
+            pb = V::set1( p.power[2] );
+    const float* w = LumaWeights< L >::of( p );
+    const F lr = V::set1( w[0] ), lg = V::set1( w[1] ), lb = V::set1( w[2] );
+    const F sat = V::set1( p.saturation );
+
+    for ( size_t i = 0; i < n; i += V::N )
+    {
+        // Not fused, so every instruction set rounds the same here.
+        // Small powers make the clamp very sensitive near 0.
+        F x = V::mul( V::load( r + i ), sr );
+        F y = V::mul( V::load( g + i ), sg );
+        F z = V::mul( V::load( b + i ), sb );
+        if ( !( P & kCDLNoOffset ) )
+        {
+            x = V::add( x, or_ );
+            y = V::add( y, og );
+            z = V::add( z, ob );
+        }
+        x = clamp01<V>( x );
+        y = clamp01<V>( y );
+        z = clamp01<V>( z );
+
+        if ( !( P & kCDLNoPower ) )
+        {
+            x = pow< V, Q >( x, pr );
+            y = pow< V, Q >( y, pg );
+            z = pow< V, Q >( z, pb );
+        }
+
+        if ( !( P & kCDLNoSaturation ) )
+        {
+            F luma = V::fmadd( x, lr, V::fmadd( y, lg, V::mul( z, lb ) ) );
+            x = V::fmadd( sat, V::sub( x, luma ), luma );
+            y = V::fmadd( sat, V::sub( y, luma ), luma );
+            z = V::fmadd( sat, V::sub( z, luma ), luma );
+        }
+
+        V::store( r + i, x );
+        V::store( g + i, y );
+        V::store( b + i, z );
+    }
+}
+
+/** 
+ * Apply a CDL to n pixels in planes, any n.  The last partial vector
+ * goes through a copy, so the planes need no padding.
+ */
+template< class V, unsigned P, unsigned Q, unsigned L >
+void cdl_planes_any( const CDLParams& p, float* r, float* g, float* b, 
+                     size_t n )
+{
+    size_t whole = n / V::N * V::N;
+    cdl_planes< V, P, Q, L >( p, r, g, b, whole );
+    if ( whole == n ) return;
+
+    float tr[V::N], tg[V::N], tb[V::N];
+    size_t rest = n - whole;
+    for ( size_t k = 0; k < (size_t) V::N; ++k )
+    {
+        tr[k] = k < rest ? r[whole + k] : 0.0f;
+        tg[k] = k < rest ? g[whole + k] : 0.0f;
+        tb[k] = k < rest ? b[whole + k] : 0.0f;
+    }
+    cdl_planes< V, P, Q, L >( p, tr, tg, tb, V::N );
+    for ( size_t k = 0; k < rest; ++k )
+    {
+        r[whole + k] = tr[k];
+        g[whole + k] = tg[k];
+        b[whole + k] = tb[k];
+    }
+}
+
+/** 
+ * Deinterleave n pixels of a block into planes, padded with 0 to
+ * whole vectors of N lanes.
+ * 
+ * @return the padded count
+ */
+inline size_t deinterleave( const float* s, size_t n, unsigned channels,
+                            size_t N, float* r, float* g, float* b )
+{
+    for ( size_t k = 0; k < n; ++k )
+    {
+        r[k] = s[k * channels];
+        g[k] = s[k * channels + 1];
+        b[k] = s[k * channels + 2];
+    }
+    size_t padded = ( n + N - 1 ) / N * N;
+    for ( size_t k = n; k < padded; ++k )
+        r[k] = g[k] = b[k] = 0.0f;
+    return padded;
+}
+
+/** 
+ * Interleave n pixels of planes back, with the alpha of s.  s and d
+ * may be the same.
+ */
+inline void interleave( const float* r, const float* g, const float* b,
+                        size_t n, unsigned channels, const float* s, 
+                        float* d )
+{
+    if ( channels == 4 )
+    {
+        for ( size_t k = 0; k < n; ++k )
+        {
+            float a = s[k * 4 + 3];
+            d[k * 4]     = r[k];
+            d[k * 4 + 1] = g[k];
+            d[k * 4 + 2] = b[k];
+            d[k * 4 + 3] = a;
+        }
+    }
+    else
+    {
+        for ( size_t k = 0; k < n; ++k )
+        {
+            d[k * 3]     = r[k];
+            d[k * 3 + 1] = g[k];
+            d[k * 3 + 2] = b[k];
+        }
+    }
+}
+
+/** 
+ * Apply a CDL to interleaved pixels, a block at a time: deinterleave
+ * into planes, padded to whole vectors, run the planes and interleave
+ * back.
+ */
+template< class V, unsigned P, unsigned Q, unsigned L >
+void cdl_apply( const CDLParams& p, const float* in, float* out,
+                size_t pixels, unsigned channels )
+{
+    float r[kCDLBlock], g[kCDLBlock], b[kCDLBlock];
+
+    for ( size_t done = 0; done < pixels; done += kCDLBlock )
+    {
+        size_t n = pixels - done;
+        if ( n > kCDLBlock ) n = kCDLBlock;
+        const float* s = in + done * channels;
+        float* d = out + done * channels;
+
+        size_t padded = deinterleave( s, n, channels, V::N, r, g, b );
+        cdl_planes< V, P, Q, L >( p, r, g, b, padded );
+        interleave( r, g, b, n, channels, s, d );
+    }
+}
+
+/** 
+ * Undo a CDL on n pixels in planes, n a multiple of V::N, and set
+ * flags[i] to the CDLClamp bits of pixel i.  p holds the parameters of
+ * the inverse: 1 / slope, -offset, 1 / power and 1 / saturation, so
+ * the CDLPath bits P are those of the CDL.
+ */
+template< class V, unsigned P, unsigned Q, unsigned L >
+void cdl_inverse_planes( const CDLParams& p, float* r, float* g, 
+                         float* b, unsigned char* flags, size_t n )
+{
+    typedef typename V::F F;
+
+    const F sr = V::set1( p.slope[0] ), sg = V::set1( p.slope[1] ),
+            sb = V::set1( p.slope[2] );
+    const F or_ = V::set1( p.offset[0] ), og = V::set1( p.offset[1] ),
+            ob = V::set1( p.offset[2] );
+    const F pr = V::set1( p.power[0] ), pg = V::set1( p.power[1] ),
+            pb = V::set1( p.power[2] );
+    const float* w = LumaWeights< L >::of( p );
+    const F lr = V::set1( w[0] ), lg = V::set1( w[1] ), lb = V::set1( w[2] );
+    const F sat = V::set1( p.saturation );
+
+    // Undoing the saturation rounds, so values that close to 0 or 1
+    // are taken as clamped.  Without it they are exact.
+    float tol = ( P & kCDLNoSaturation ) ? 0.0f :
+                1e-6f * ( 1.0f + fabsf( p.saturation ) );
+    const F low  = V::set1( tol > 0.0f ? tol : 1.40129846e-45f );
+    const F high = V::set1( tol > 0.0f ? 1.0f - tol : 0.99999994f );
+
+    for ( size_t i = 0; i < n; i += V::N )
+    {
+        F x = V::load( r + i );
+        F y = V::load( g + i );
+        F z = V::load( b + i );
+
+        // The weights of p are scaled so this is the luma before the
+        // saturation, which only keeps it when they sum to 1
+        if ( !( P & kCDLNoSaturation ) )
+        {
+            F luma = V::fmadd( x, lr, V::fmadd( y, lg, V::mul( z, lb ) ) );
+            x = V::fmadd( sat, V::sub( x, luma ), luma );
+            y = V::fmadd( sat, V::sub( y, luma ), luma );
+            z = V::fmadd( sat, V::sub( z, luma ), luma );
+        }
+
+        // One bit per lane for each CDLClamp bit
+        const unsigned bits[6] = {
+        V::bits( V::lt( x, low ) ),  V::bits( V::lt( y, low ) ),
+        V::bits( V::lt( z, low ) ),  V::bits( V::gt( x, high ) ),
+        V::bits( V::gt( y, high ) ), V::bits( V::gt( z, high ) )
+        };
+        unsigned any = bits[0] | bits[1] | bits[2] | 
+                       bits[3] | bits[4] | bits[5];
+        for ( unsigned k = 0; k < (unsigned) V::N; ++k )
+        {
+            unsigned f = 0;
+            if ( any )
+            {
+                for ( unsigned c = 0; c < 6; ++c )
+                    f |= ( ( bits[c] >> k ) & 1u ) << c;
+            }
+            flags[i + k] = (unsigned char) f;
+        }
+
+        x = clamp01<V>( x );
+        y = clamp01<V>( y );
+        z = clamp01<V>( z );
+
+        if ( !( P & kCDLNoPower ) )
+        {
+            x = pow< V, Q >( x, pr );
+            y = pow< V, Q >( y, pg );
+            z = pow< V, Q >( z, pb );
+        }
+
+        if ( !( P & kCDLNoOffset ) )
+        {
+            x = V::add( x, or_ );
+            y = V::add( y, og );
+            z = V::add( z, ob );
+        }
+        V::store( r + i, V::mul( x, sr ) );
+        V::store( g + i, V::mul( y, sg ) );
+        V::store( b + i, V::mul( z, sb ) );
+    }
+}
+
+/** 
+ * Undo a CDL on interleaved pixels, a block at a time as cdl_apply()
+ * does.  flags may be NULL.
+ * 
+ * @return pixels with any CDLClamp bit
+ */
+template< class V, unsigned P, unsigned Q, unsigned L >
+size_t cdl_inverse( const CDLParams& p, const float* in, float* out,
+                    size_t pixels, unsigned channels, 
+                    unsigned char* flags )
+{
+    float r[kCDLBlock], g[kCDLBlock], b[kCDLBlock];
+    unsigned char f[kCDLBlock];
+    size_t clamped = 0;
+
+    for ( size_t done = 0; done < pixels; done += kCDLBlock )
+    {
+        size_t n = pixels - done;
+        if ( n > kCDLBlock ) n = kCDLBlock;
+        const float* s = in + done * channels;
+        float* d = out + done * channels;
+
+        size_t padded = deinterleave( s, n, channels, V::N, r, g, b );
+        cdl_inverse_planes< V, P, Q, L >( p, r, g, b, f, padded );
+        interleave( r, g, b, n, channels, s, d );
+
+        // Not the padding
+        for ( size_t k = 0; k < n; ++k )
+            clamped += f[k] != 0;
+        if ( flags ) memcpy( flags + done, f, n );
+    }
+    return clamped;
+}
+
+/** 
+ * Linear from curve D, as in ACEScsc.ACEScc_to_ACES and
+ * ACEScsc.ACEScct_to_ACES.  Both top out at 65504, the largest half.
+ */
+template< class V, unsigned Q, unsigned D >
+inline typename V::F decode( typename V::F x )
+{
+    typedef typename V::F F;
+
+    if ( D == kCurveLinear ) return x;
+
+    F lin = exp2< V, Q >( V::fmadd( x, V::set1( 17.52f ), 
+                                    V::set1( -9.72f ) ) );
+    if ( D == kCurveACEScc )
+    {
+        // Below (9.72 - 15) / 17.52, the inverse of log2( 2^-16 + lin / 2 )
+        F toe = V::mul( V::sub( lin, V::set1( 1.52587891e-5f ) ), 
+                        V::set1( 2.0f ) );
+        lin = V::select( V::lt( x, V::set1( -0.301369863f ) ), toe, lin );
+    }
+    else
+    {
+        // A straight line up to 0.155251141
+        F toe = V::mul( V::sub( x, V::set1( 0.0729055342f ) ), 
+                        V::set1( 0.0948745203f ) );
+        lin = V::select( V::gt( x, V::set1( 0.155251142f ) ), lin, toe );
+    }
+    return V::select( V::lt( x, V::set1( 1.46799631f ) ), lin, 
+                      V::set1( 65504.0f ) );
+}
+
+/** 
+ * Curve E of linear values, as in ACEScsc.ACES_to_ACEScc and
+ * ACEScsc.ACES_to_ACEScct.
+ */
+template< class V, unsigned Q, unsigned E >
+inline typename V::F encode( typename V::F lin )
+{
+    typedef typename V::F F;
+    typedef typename V::M M;
+
+    if ( E == kCurveLinear ) return lin;
+
+    // ( log2( lin ) + 9.72 ) / 17.52
+    const F scale = V::set1( 0.0570776256f ), shift = V::set1( 0.554794521f );
+    if ( E == kCurveACEScc )
+    {
+        // max first, so NaN and negatives take the bottom of the curve,
+        // log2( 2^-16 )
+        F l = V::max( lin, V::set1( 0.0f ) );
+        F arg = V::select( V::lt( l, V::set1( 3.05175781e-5f ) ),
+                           V::fmadd( l, V::set1( 0.5f ), 
+                                     V::set1( 1.52587891e-5f ) ), l );
+        return V::fmadd( log2< V, Q >( arg ), scale, shift );
+    }
+
+    // A straight line up to 0.0078125
+    M curve = V::gt( lin, V::set1( 0.0078125f ) );
+    F log = V::fmadd( log2< V, Q >( V::select( curve, lin, 
+                                               V::set1( 1.0f ) ) ), 
+                      scale, shift );
+    F toe = V::fmadd( lin, V::set1( 10.5402377f ), 
+                      V::set1( 0.0729055342f ) );
+    return V::select( curve, log, toe );
+}
+
+/** 
+ * Convert n pixels in planes, n a multiple of V::N: decode curve D,
+ * change primaries if c asks to, encode curve E.
+ */
+template< class V, unsigned Q, unsigned D, unsigned E >
+void convert_planes( const CDLConvert& c, float* r, float* g, float* b, 
+                     size_t n )
+{
+    typedef typename V::F F;
+
+    const F m0 = V::set1( c.m[0] ), m1 = V::set1( c.m[1] ), 
+            m2 = V::set1( c.m[2] ), m3 = V::set1( c.m[3] ), 
+            m4 = V::set1( c.m[4] ), m5 = V::set1( c.m[5] ), 
+            m6 = V::set1( c.m[6] ), m7 = V::set1( c.m[7] ), 
+            m8 = V::set1( c.m[8] );
+
+    for ( size_t i = 0; i < n; i += V::N )
+    {
+        F x = decode< V, Q, D >( V::load( r + i ) );
+        F y = decode< V, Q, D >( V::load( g + i ) );
+        F z = decode< V, Q, D >( V::load( b + i ) );
+
+        if ( c.matrix )
+        {
+            F x2 = V::fmadd( x, m0, V::fmadd( y, m1, V::mul( z, m2 ) ) );
+            F y2 = V::fmadd( x, m3, V::fmadd( y, m4, V::mul( z, m5 ) ) );
+            F z2 = V::fmadd( x, m6, V::fmadd( y, m7, V::mul( z, m8 ) ) );
+            x = x2;
+            y = y2;
+            z = z2;
+        }
+
+        V::store( r + i, encode< V, Q, E >( x ) );
+        V::store( g + i, encode< V, Q, E >( y ) );
+        V::store( b + i, encode< V, Q, E >( z ) );
+    }
+}
+
+/** 
+ * Convert n pixels in planes, n a multiple of V::N, with the kernel of
+ * the curves of c.
+ */
+template< class V, unsigned Q >
+void convert_any( const CDLConvert& c, float* r, float* g, float* b, 
+                  size_t n )
+{
+    if ( c.decode == c.encode && !c.matrix ) return;
+
+    switch( c.decode * kCurves + c.encode )
+    {
+#define ACES_CDL_CONVERT( D, E )                                        \
+        case D * kCurves + E:                                           \
+            convert_planes< V, Q, D, E >( c, r, g, b, n );              \
+            break;
+        ACES_CDL_CONVERT( kCurveLinear, kCurveLinear )
+        ACES_CDL_CONVERT( kCurveLinear, kCurveACEScc )
+        ACES_CDL_CONVERT( kCurveLinear, kCurveACEScct )
+        ACES_CDL_CONVERT( kCurveACEScc, kCurveLinear )
+        ACES_CDL_CONVERT( kCurveACEScc, kCurveACEScc )
+        ACES_CDL_CONVERT( kCurveACEScc, kCurveACEScct )
+        ACES_CDL_CONVERT( kCurveACEScct, kCurveLinear )
+        ACES_CDL_CONVERT( kCurveACEScct, kCurveACEScc )
+        ACES_CDL_CONVERT( kCurveACEScct, kCurveACEScct )
+#undef ACES_CDL_CONVERT
+        default:
+            break;
+    }
+}
+
+/** 
+ * Convert interleaved pixels between ACES spaces, a block at a time.
+ */
+template< class V, unsigned Q >
+void cdl_convert( const CDLConvert& c, const float* in, float* out,
+                  size_t pixels, unsigned channels )
+{
+    float r[kCDLBlock], g[kCDLBlock], b[kCDLBlock];
+
+    for ( size_t done = 0; done < pixels; done += kCDLBlock )
+    {
+        size_t n = pixels - done;
+        if ( n > kCDLBlock ) n = kCDLBlock;
+        const float* s = in + done * channels;
+        float* d = out + done * channels;
+
+        size_t padded = deinterleave( s, n, channels, V::N, r, g, b );
+        convert_any< V, Q >( c, r, g, b, padded );
+        interleave( r, g, b, n, channels, s, d );
+    }
+}
+
+/** 
+ * Convert interleaved pixels to the space of a CDL, apply it and
+ * convert them back.  Each block goes through all three while it is
+ * in the cache, so the pixels are read and written once.
+ */
+template< class V, unsigned P, unsigned Q, unsigned L >
+void cdl_workspace( const CDLParams& p, const CDLConvert& to, 
+                    const CDLConvert& from, const float* in, float* out,
+                    size_t pixels, unsigned channels )
+{
+    float r[kCDLBlock], g[kCDLBlock], b[kCDLBlock];
+
+    for ( size_t done = 0; done < pixels; done += kCDLBlock )
+    {
+        size_t n = pixels - done;
+        if ( n > kCDLBlock ) n = kCDLBlock;
+        const float* s = in + done * channels;
+        float* d = out + done * channels;
+
+        size_t padded = deinterleave( s, n, channels, V::N, r, g, b );
+        convert_any< V, Q >( to, r, g, b, padded );
+        cdl_planes< V, P, Q, L >( p, r, g, b, padded );
+        convert_any< V, Q >( from, r, g, b, padded );
+        interleave( r, g, b, n, channels, s, d );
+    }
+}
+
+/** 
+ * Where inputs x fall on a CDLLut: k, the point below, and the
+ * fraction past it.  Inputs outside the table go to its ends, NaN to
+ * low.  Rounds as the scalar lookup always did.
+ */
+template< class V >
+inline typename V::F lut_fraction( typename V::F x, typename V::F low,
+                                   typename V::F scale, 
+                                   typename V::F last, 
+                                   typename V::F below, 
+                                   typename V::F& k )
+{
+    // max first, so NaN becomes 0
+    typename V::F f = V::min( V::max( V::mul( V::sub( x, low ), scale ),
+                                      V::set1( 0.0f ) ), last );
+    k = V::min( V::floor( f ), below );
+    return V::sub( f, k );
+}
+
+/** 
+ * Apply the 1D curves of a CDLLut and its saturation to n pixels in
+ * planes, n a multiple of V::N.
+ */
+template< class V >
+void cdl_lut_1D_planes( const CDLLutParams& p, float* r, float* g, 
+                        float* b, size_t n )
+{
+    typedef typename V::F F;
+    typedef typename V::I I;
+
+    const float* t = p.table;
+    const F low = V::set1( p.low ), scale = V::set1( p.scale );
+    const F last = V::set1( (float)( p.size - 1 ) );
+    const F below = V::set1( (float)( p.size - 2 ) );
+    const I three = V::iset1( 3 );
+    const F lr = V::set1( p.luma[0] ), lg = V::set1( p.luma[1] ), 
+            lb = V::set1( p.luma[2] );
+    const F sat = V::set1( p.saturation );
+
+    for ( size_t i = 0; i < n; i += V::N )
+    {
+        F kr, kg, kb;
+        F dr = lut_fraction<V>( V::load( r + i ), low, scale, last, below, 
+                                kr );
+        F dg = lut_fraction<V>( V::load( g + i ), low, scale, last, below, 
+                                kg );
+        F db = lut_fraction<V>( V::load( b + i ), low, scale, last, below, 
+                                kb );
+        I ir = V::imul( V::to_int( kr ), three );
+        I ig = V::imul( V::to_int( kg ), three );
+        I ib = V::imul( V::to_int( kb ), three );
+
+        // Each channel between its point and the next, 3 floats on
+        F x0 = V::gather( t, ir ), x1 = V::gather( t + 3, ir );
+        F y0 = V::gather( t + 1, ig ), y1 = V::gather( t + 4, ig );
+        F z0 = V::gather( t + 2, ib ), z1 = V::gather( t + 5, ib );
+        F x = V::add( x0, V::mul( dr, V::sub( x1, x0 ) ) );
+        F y = V::add( y0, V::mul( dg, V::sub( y1, y0 ) ) );
+        F z = V::add( z0, V::mul( db, V::sub( z1, z0 ) ) );
+
+        // The saturation, as cdl_saturate() does it
+        F l = V::add( V::add( V::mul( lr, x ), V::mul( lg, y ) ), 
+                      V::mul( lb, z ) );
+        V::store( r + i, V::add( l, V::mul( sat, V::sub( x, l ) ) ) );
+        V::store( g + i, V::add( l, V::mul( sat, V::sub( y, l ) ) ) );
+        V::store( b + i, V::add( l, V::mul( sat, V::sub( z, l ) ) ) );
+    }
+}
+
+/** 
+ * One of six values by the order of the fractions x, y and z, for the
+ * tetrahedra xyz, xzy, zxy, zyx, yzx and yxz.  m holds x < y, y < z,
+ * x < z, z < y and z < x, and ties pick as the scalar lookup did.
+ */
+template< class V >
+inline typename V::F by_order( const typename V::M m[5],
+                               typename V::F xyz, typename V::F xzy,
+                               typename V::F zxy, typename V::F zyx,
+                               typename V::F yzx, typename V::F yxz )
+{
+    return V::select( m[0],
+                      V::select( m[3], V::select( m[4], yxz, yzx ), zyx ),
+                      V::select( m[1], V::select( m[2], zxy, xzy ), xyz ) );
+}
+
+/** 
+ * Apply the 3D lattice of a CDLLut to n pixels in planes, n a multiple
+ * of V::N, interpolating in the tetrahedron of its cube each pixel is
+ * in.
+ */
+template< class V >
+void cdl_lut_3D_planes( const CDLLutParams& p, float* r, float* g, 
+                        float* b, size_t n )
+{
+    typedef typename V::F F;
+    typedef typename V::I I;
+    typedef typename V::M M;
+
+    const float* t = p.table;
+    const unsigned size = p.size;
+    const F low = V::set1( p.low ), scale = V::set1( p.scale );
+    const F last = V::set1( (float)( size - 1 ) );
+    const F below = V::set1( (float)( size - 2 ) );
+
+    // Offsets of the next point along each axis, and of the far corner
+    const unsigned sr = 3, sg = size * 3, sb = size * size * 3;
+    const I ir3 = V::iset1( (int) sr ), ig3 = V::iset1( (int) sg ), 
+            ib3 = V::iset1( (int) sb );
+    const I far = V::iset1( (int)( sr + sg + sb ) );
+    const F dr = V::set1( (float) sr ), dg = V::set1( (float) sg ),
+            db = V::set1( (float) sb );
+    const F drg = V::set1( (float)( sr + sg ) ), 
+            drb = V::set1( (float)( sr + sb ) ),
+            dgb = V::set1( (float)( sg + sb ) );
+    const F one = V::set1( 1.0f );
+
+    for ( size_t i = 0; i < n; i += V::N )
+    {
+        F kr, kg, kb;
+        F x = lut_fraction<V>( V::load( r + i ), low, scale, last, below, 
+                               kr );
+        F y = lut_fraction<V>( V::load( g + i ), low, scale, last, below, 
+                               kg );
+        F z = lut_fraction<V>( V::load( b + i ), low, scale, last, below, 
+                               kb );
+        I c000 = V::iadd( V::iadd( V::imul( V::to_int( kr ), ir3 ),
+                                   V::imul( V::to_int( kg ), ig3 ) ),
+                          V::imul( V::to_int( kb ), ib3 ) );
+
+        const M m[5] = { V::lt( x, y ), V::lt( y, z ), V::lt( x, z ),
+                         V::lt( z, y ), V::lt( z, x ) };
+        I c1 = V::iadd( c000, V::to_int( by_order<V>( m, dr, dr, db, db, 
+                                                      dg, dg ) ) );
+        I c2 = V::iadd( c000, V::to_int( by_order<V>( m, drg, drb, drb, 
+                                                      dgb, dgb, drg ) ) );
+        I c111 = V::iadd( c000, far );
+        F w1 = by_order<V>( m, V::sub( x, y ), V::sub( x, z ), 
+                            V::sub( z, x ), V::sub( z, y ), 
+                            V::sub( y, z ), V::sub( y, x ) );
+        F w2 = by_order<V>( m, V::sub( y, z ), V::sub( z, y ), 
+                            V::sub( x, y ), V::sub( y, x ), 
+                            V::sub( z, x ), V::sub( x, z ) );
+        F w3 = by_order<V>( m, z, y, y, x, x, z );
+        F w0 = V::sub( one, V::add( V::add( w1, w2 ), w3 ) );
+
+        float* planes[3] = { r, g, b };
+        for ( unsigned c = 0; c < 3; ++c )
+        {
+            F v = V::add( V::add( V::add( 
+                          V::mul( w0, V::gather( t + c, c000 ) ),
+                          V::mul( w1, V::gather( t + c, c1 ) ) ),
+                          V::mul( w2, V::gather( t + c, c2 ) ) ),
+                          V::mul( w3, V::gather( t + c, c111 ) ) );
+            V::store( planes[c] + i, v );
+        }
+    }
+}
+
+/** 
+ * Apply a CDLLut of D dimensions to interleaved pixels, a block at a
+ * time as cdl_apply() does.
+ */
+template< class V, unsigned D >
+void cdl_lut( const CDLLutParams& p, const float* in, float* out,
+              size_t pixels, unsigned channels )
+{
+    float r[kCDLBlock], g[kCDLBlock], b[kCDLBlock];
+
+    for ( size_t done = 0; done < pixels; done += kCDLBlock )
+    {
+        size_t n = pixels - done;
+        if ( n > kCDLBlock ) n = kCDLBlock;
+        const float* s = in + done * channels;
+        float* d = out + done * channels;
+
+        size_t padded = deinterleave( s, n, channels, V::N, r, g, b );
+        if ( D == 1 )
+            cdl_lut_1D_planes< V >( p, r, g, b, padded );
+        else
+            cdl_lut_3D_planes< V >( p, r, g, b, padded );
+        interleave( r, g, b, n, channels, s, d );
+    }
+}
+
+}  // namespace
+}  // namespace ACES
+
+// Kernels K of wrapper V at precision Q and luma L, for every CDLPath
+// combination
+#define ACES_CDL_PATHS( K, V, Q, L )                                    \
+    { &K< V, 0, cdl_quality( 0, Q ), cdl_luma( 0, L ) >,                \
+      &K< V, 1, cdl_quality( 1, Q ), cdl_luma( 1, L ) >,                \
+      &K< V, 2, cdl_quality( 2, Q ), cdl_luma( 2, L ) >,                \
+      &K< V, 3, cdl_quality( 3, Q ), cdl_luma( 3, L ) >,                \
+      &K< V, 4, cdl_quality( 4, Q ), cdl_luma( 4, L ) >,                \
+      &K< V, 5, cdl_quality( 5, Q ), cdl_luma( 5, L ) >,                \
+      &K< V, 6, cdl_quality( 6, Q ), cdl_luma( 6, L ) >,                \
+      &K< V, 7, cdl_quality( 7, Q ), cdl_luma( 7, L ) > }
+
+// The same for kernels that use Q without a power too
+#define ACES_CDL_PATHS_AT( K, V, Q, L )                                 \
+    { &K< V, 0, Q, cdl_luma( 0, L ) >, &K< V, 1, Q, cdl_luma( 1, L ) >, \
+      &K< V, 2, Q, cdl_luma( 2, L ) >, &K< V, 3, Q, cdl_luma( 3, L ) >, \
+      &K< V, 4, Q, cdl_luma( 4, L ) >, &K< V, 5, Q, cdl_luma( 5, L ) >, \
+      &K< V, 6, Q, cdl_luma( 6, L ) >, &K< V, 7, Q, cdl_luma( 7, L ) > }
+
+#define ACES_CDL_LUMAS( PATHS, K, V, Q )                                \
+    { PATHS( K, V, Q, kCDLLumaRec709 ),                                 \
+      PATHS( K, V, Q, kCDLLumaAP0 ),                                    \
+      PATHS( K, V, Q, kCDLLumaAP1 ),                                    \
+      PATHS( K, V, Q, kCDLLumaCustom ) }
+
+#define ACES_CDL_PRECISIONS( PATHS, K, V )                              \
+    { ACES_CDL_LUMAS( PATHS, K, V, kCDLExact ),                         \
+      ACES_CDL_LUMAS( PATHS, K, V, kCDLPrecise ),                       \
+      ACES_CDL_LUMAS( PATHS, K, V, kCDLFast ),                          \
+      ACES_CDL_LUMAS( PATHS, K, V, kCDLFastest ) }
+
+// The kernels of wrapper V
+#define ACES_CDL_KERNELS( V )                                           \
+{                                                                       \
+    ACES_CDL_PRECISIONS( ACES_CDL_PATHS, cdl_apply, V ),                \
+    ACES_CDL_PRECISIONS( ACES_CDL_PATHS, cdl_planes_any, V ),           \
+    ACES_CDL_PRECISIONS( ACES_CDL_PATHS, cdl_inverse, V ),              \
+    { &cdl_convert< V, kCDLExact >,                                     \
+      &cdl_convert< V, kCDLPrecise >,                                   \
+      &cdl_convert< V, kCDLFast >,                                      \
+      &cdl_convert< V, kCDLFastest > },                                 \
+    ACES_CDL_PRECISIONS( ACES_CDL_PATHS_AT, cdl_workspace, V ),         \
+    &cdl_lut< V, 1 >,                                                   \
+    &cdl_lut< V, 3 >                                                    \
+}
+
+#endif  // ACESCDLKernelsImpl_h
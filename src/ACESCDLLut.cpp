@@ -0,0 +1,301 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <string.h>
+
+#include "ACESCDLLut.h"
+#include "ACESCDLKernels.h"
+#include "ACESHash.h"
+
+
+namespace ACES {
+
+static const unsigned kDefault1DSize = 4096;
+static const unsigned kDefault3DSize = 33;
+
+/** 
+ * A shape with its default size filled in and a usable range.
+ */
+static CDLLut::Shape resolve( const CDLLut::Shape& s )
+{
+    CDLLut::Shape r = s;
+    if ( r.size == 0 )
+        r.size = r.type == CDLLut::k1D ? kDefault1DSize : kDefault3DSize;
+    if ( r.size < 2 ) r.size = 2;
+    if ( !( r.high > r.low ) ) r.high = r.low + 1.0f;
+    if ( (unsigned) r.luma >= (unsigned) kCDLLumaCustom ) 
+        r.luma = kCDLLumaRec709;
+    return r;
+}
+
+CDLLut::CDLLut() :
+_scale( 1.0f )
+{
+    simd( simd_level() );
+}
+
+CDLLut::CDLLut( const ASC_CDL& cdl, const Shape& shape ) :
+_scale( 1.0f )
+{
+    simd( simd_level() );
+    bake( cdl, shape );
+}
+
+void CDLLut::simd( SIMDLevel level )
+{
+    SIMDLevel best = simd_level();
+    if ( level > best ) level = best;
+
+    int l = level;
+    while ( l > kSIMDScalar && !cdl_kernels( (SIMDLevel) l ) )
+        --l;
+    _level = (SIMDLevel) l;
+    _kernels = cdl_kernels( _level );
+}
+
+void CDLLut::bake( const ASC_CDL& cdl, const Shape& shape )
+{
+    _cdl = cdl;
+    _shape = resolve( shape );
+
+    const unsigned n = _shape.size;
+    const float low = _shape.low;
+    const float step = ( _shape.high - low ) / ( n - 1 );
+    _scale = ( n - 1 ) / ( _shape.high - low );
+
+    // The points go through a CDLProcessor, so the table matches it
+    if ( _shape.type == k1D )
+    {
+        _table.resize( n * 3 );
+        for ( unsigned i = 0; i < n; ++i )
+        {
+            float x = i == n - 1 ? _shape.high : low + step * i;
+            _table[i * 3] = _table[i * 3 + 1] = _table[i * 3 + 2] = x;
+        }
+
+        // The curves only; apply() does the saturation
+        ASC_CDL sop( cdl );
+        sop.saturation( 1.0f );
+        CDLProcessor( sop ).apply( &_table[0], n );
+        return;
+    }
+
+    _table.resize( (size_t) n * n * n * 3 );
+    std::vector< float > axis( n );
+    for ( unsigned i = 0; i < n; ++i )
+        axis[i] = i == n - 1 ? _shape.high : low + step * i;
+
+    float* p = &_table[0];
+    for ( unsigned b = 0; b < n; ++b )
+    {
+        for ( unsigned g = 0; g < n; ++g )
+        {
+            for ( unsigned r = 0; r < n; ++r, p += 3 )
+            {
+                p[0] = axis[r];
+                p[1] = axis[g];
+                p[2] = axis[b];
+            }
+        }
+    }
+    CDLProcessor processor( cdl );
+    processor.luma( _shape.luma );
+    processor.apply( &_table[0], (size_t) n * n * n );
+}
+
+void CDLLut::apply( const float* in, float* out, size_t pixels,
+                    unsigned channels ) const
+{
+    if ( _table.empty() )
+    {
+        CDLProcessor processor( _cdl );
+        processor.luma( _shape.luma );
+        processor.apply( in, out, pixels, channels );
+        return;
+    }
+
+    CDLLutParams p;
+    p.table = &_table[0];
+    p.size = _shape.size;
+    p.low = _shape.low;
+    p.scale = _scale;
+    p.saturation = _cdl.saturation();
+    const float* luma = cdl_luma_weights( _shape.luma );
+    for ( unsigned i = 0; i < 3; ++i )
+        p.luma[i] = luma[i];
+
+    if ( channels != 4 ) channels = 3;
+    if ( _shape.type == k1D )
+        _kernels->lut_1D( p, in, out, pixels, channels );
+    else
+        _kernels->lut_3D( p, in, out, pixels, channels );
+}
+
+
+/** 
+ * Hash of a CDL and a table shape.
+ */
+static HashValue lut_hash( const ASC_CDL& cdl, const CDLLut::Shape& s )
+{
+    float v[14];
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        v[i]     = cdl.slope(i);
+        v[i + 3] = cdl.offset(i);
+        v[i + 6] = cdl.power(i);
+    }
+    v[9]  = cdl.saturation();
+    v[10] = s.low;
+    v[11] = s.high;
+    v[12] = (float) s.size;
+    v[13] = (float) s.luma;
+    return fnv1a( &s.type, sizeof(s.type), fnv1a( v, sizeof(v) ) );
+}
+
+static bool same_cdl( const ASC_CDL& a, const ASC_CDL& b )
+{
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        if ( a.slope(i) != b.slope(i) || a.offset(i) != b.offset(i) ||
+             a.power(i) != b.power(i) )
+            return false;
+    }
+    return a.saturation() == b.saturation();
+}
+
+
+CDLLutCache::CDLLutCache( size_t capacity ) :
+_capacity( capacity ),
+_hits( 0 ),
+_misses( 0 )
+{
+}
+
+CDLLutCache::Entries::iterator 
+CDLLutCache::find( unsigned long long hash, const ASC_CDL& cdl,
+                   const CDLLut::Shape& shape )
+{
+    std::pair< Index::iterator, Index::iterator > r = 
+    _index.equal_range( hash );
+    for ( Index::iterator i = r.first; i != r.second; ++i )
+    {
+        const CDLLut& lut = *i->second->lut;
+        if ( lut.shape() == shape && same_cdl( lut.cdl(), cdl ) )
+            return i->second;
+    }
+    return _entries.end();
+}
+
+void CDLLutCache::trim()
+{
+    while ( _entries.size() > _capacity )
+    {
+        Entries::iterator last = --_entries.end();
+        std::pair< Index::iterator, Index::iterator > r = 
+        _index.equal_range( last->hash );
+        for ( Index::iterator i = r.first; i != r.second; ++i )
+        {
+            if ( i->second == last )
+            {
+                _index.erase( i );
+                break;
+            }
+        }
+        _entries.erase( last );
+    }
+}
+
+CDLLutCache::Lut CDLLutCache::get( const ASC_CDL& cdl, 
+                                   const CDLLut::Shape& s )
+{
+    CDLLut::Shape shape = resolve( s );
+    HashValue hash = lut_hash( cdl, shape );
+
+    {
+        std::lock_guard< std::mutex > lock( _mutex );
+        Entries::iterator i = find( hash, cdl, shape );
+        if ( i != _entries.end() )
+        {
+            _entries.splice( _entries.begin(), _entries, i );
+            ++_hits;
+            return i->lut;
+        }
+    }
+
+    ++_misses;
+    Lut lut( new CDLLut( cdl, shape ) );
+
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    // Another thread may have baked the same table meanwhile
+    Entries::iterator i = find( hash, cdl, shape );
+    if ( i != _entries.end() )
+    {
+        _entries.splice( _entries.begin(), _entries, i );
+        return i->lut;
+    }
+
+    if ( _capacity == 0 ) return lut;
+
+    Entry e;
+    e.hash = hash;
+    e.lut = lut;
+    _entries.push_front( e );
+    _index.insert( Index::value_type( hash, _entries.begin() ) );
+    trim();
+    return lut;
+}
+
+size_t CDLLutCache::size() const
+{
+    std::lock_guard< std::mutex > lock( _mutex );
+    return _entries.size();
+}
+
+void CDLLutCache::capacity( size_t n )
+{
+    std::lock_guard< std::mutex > lock( _mutex );
+    _capacity = n;
+    trim();
+}
+
+void CDLLutCache::clear()
+{
+    std::lock_guard< std::mutex > lock( _mutex );
+    _index.clear();
+    _entries.clear();
+}
+
+CDLLutCache& CDLLutCache::global()
+{
+    static CDLLutCache cache;
+    return cache;
+}
+
+}  // namespace ACES
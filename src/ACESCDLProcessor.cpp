@@ -0,0 +1,277 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_IX86) )
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#include "ACESCDLProcessor.h"
+#include "ACESCDLKernelsImpl.h"
+
+
+namespace ACES {
+
+const CDLKernels* cdl_kernels_scalar()
+{
+    static const CDLKernels k = ACES_CDL_KERNELS( Scalar );
+    return &k;
+}
+
+static SIMDLevel detect_simd()
+{
+#if ( defined(__GNUC__) || defined(__clang__) ) && \
+    ( defined(__x86_64__) || defined(__i386__) )
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx512f" ) ) return kSIMDAVX512;
+    if ( __builtin_cpu_supports( "avx2" ) && 
+         __builtin_cpu_supports( "fma" ) ) return kSIMDAVX2;
+    if ( __builtin_cpu_supports( "sse4.1" ) ) return kSIMDSSE4;
+#elif defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_IX86) )
+    int r[4];
+    __cpuid( r, 0 );
+    int top = r[0];
+    if ( top < 1 ) return kSIMDScalar;
+
+    __cpuid( r, 1 );
+    bool sse4 = ( r[2] & ( 1 << 19 ) ) != 0;
+    bool fma  = ( r[2] & ( 1 << 12 ) ) != 0;
+    bool osxsave = ( r[2] & ( 1 << 27 ) ) != 0;
+    if ( !sse4 ) return kSIMDScalar;
+    if ( !osxsave || top < 7 ) return kSIMDSSE4;
+
+    // The OS must save the ymm (and zmm) registers too
+    unsigned long long xcr0 = _xgetbv( 0 );
+    if ( ( xcr0 & 6 ) != 6 ) return kSIMDSSE4;
+
+    __cpuidex( r, 7, 0 );
+    bool avx2    = ( r[1] & ( 1 << 5 ) ) != 0;
+    bool avx512f = ( r[1] & ( 1 << 16 ) ) != 0;
+    if ( avx512f && ( xcr0 & 0xe6 ) == 0xe6 ) return kSIMDAVX512;
+    if ( avx2 && fma ) return kSIMDAVX2;
+    return kSIMDSSE4;
+#endif
+    return kSIMDScalar;
+}
+
+const CDLKernels* cdl_kernels( SIMDLevel level )
+{
+    switch( level )
+    {
+        case kSIMDAVX512:
+            return cdl_kernels_avx512();
+        case kSIMDAVX2:
+            return cdl_kernels_avx2();
+        case kSIMDSSE4:
+            return cdl_kernels_sse4();
+        default:
+            return cdl_kernels_scalar();
+    }
+}
+
+SIMDLevel simd_level()
+{
+    static const SIMDLevel cpu = detect_simd();
+
+    int level = cpu;
+    while ( level > kSIMDScalar && !cdl_kernels( (SIMDLevel) level ) )
+        --level;
+    return (SIMDLevel) level;
+}
+
+const char* simd_name( SIMDLevel level )
+{
+    switch( level )
+    {
+        case kSIMDAVX512:
+            return "avx512";
+        case kSIMDAVX2:
+            return "avx2";
+        case kSIMDSSE4:
+            return "sse4";
+        default:
+            return "scalar";
+    }
+}
+
+
+unsigned cdl_paths( const ASC_CDL& c )
+{
+    return cdl_paths( c.offset(0), c.offset(1), c.offset(2), 
+                      c.power(0), c.power(1), c.power(2), 
+                      c.saturation() );
+}
+
+// Measured over every float in 0..1 by the pow mode of ACESclipBench,
+// with some room
+static const double kPowError[kCDLPrecisions] = { 6e-8, 1.5e-7, 6e-6, 3e-4 };
+
+double cdl_pow_error( CDLPrecision precision )
+{
+    return kPowError[known_precision( precision )];
+}
+
+CDLPrecision cdl_precision( double max_error )
+{
+    for ( int q = kCDLFastest; q > kCDLExact; --q )
+    {
+        if ( kPowError[q] <= max_error ) return (CDLPrecision) q;
+    }
+    return kCDLExact;
+}
+
+const float* cdl_luma_weights( CDLLuma luma )
+{
+    if ( (unsigned) luma >= (unsigned) kCDLLumaCustom ) 
+        luma = kCDLLumaRec709;
+    return kCDLLumaWeights[luma];
+}
+
+CDLLuma set_luma( CDLLuma l, float w[3] )
+{
+    if ( l == kCDLLumaCustom ) return l;
+    if ( (unsigned) l > (unsigned) kCDLLumaCustom ) l = kCDLLumaRec709;
+    memcpy( w, kCDLLumaWeights[l], 3 * sizeof(float) );
+    return l;
+}
+
+
+CDLProcessor::CDLProcessor( const ASC_CDL& c ) :
+_cdl( c ),
+_specialize( true )
+{
+    _paths = cdl_paths( c );
+    luma( kCDLLumaRec709 );
+    simd( simd_level() );
+}
+
+CDLProcessor::CDLProcessor( const CDLPreset& preset ) :
+_cdl( preset.cdl() ),
+_paths( preset.paths() ),
+_specialize( true )
+{
+    luma( kCDLLumaRec709 );
+    simd( simd_level() );
+}
+
+void CDLProcessor::cdl( const ASC_CDL& c )
+{
+    _cdl = c;
+    _paths = _specialize ? cdl_paths( c ) : (unsigned) kCDLFull;
+}
+
+void CDLProcessor::specialize( bool on )
+{
+    _specialize = on;
+    _paths = on ? cdl_paths( _cdl ) : (unsigned) kCDLFull;
+}
+
+void CDLProcessor::luma( CDLLuma l )
+{
+    _luma = set_luma( l, _weights );
+}
+
+void CDLProcessor::luma( float r, float g, float b )
+{
+    _luma = kCDLLumaCustom;
+    _weights[0] = r;
+    _weights[1] = g;
+    _weights[2] = b;
+}
+
+void CDLProcessor::simd( SIMDLevel level )
+{
+    SIMDLevel best = simd_level();
+    if ( level > best ) level = best;
+
+    int l = level;
+    while ( l > kSIMDScalar && !cdl_kernels( (SIMDLevel) l ) )
+        --l;
+    _level = (SIMDLevel) l;
+    _kernels = cdl_kernels( _level );
+}
+
+void cdl_params( const ASC_CDL& c, const float luma[3], CDLParams& p )
+{
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        p.slope[i]  = c.slope(i);
+        p.offset[i] = c.offset(i);
+        p.power[i]  = c.power(i);
+        p.luma[i]   = luma[i];
+    }
+    p.saturation = c.saturation();
+}
+
+void CDLProcessor::apply( const float* in, float* out, size_t pixels,
+                          unsigned channels, CDLPrecision precision ) const
+{
+    CDLParams p;
+    cdl_params( _cdl, _weights, p );
+    _kernels->apply[known_precision( precision )][_luma][_paths]( 
+        p, in, out, pixels, channels == 4 ? 4 : 3 );
+}
+
+void CDLProcessor::apply_planes( float* r, float* g, float* b,
+                                 size_t pixels, 
+                                 CDLPrecision precision ) const
+{
+    CDLParams p;
+    cdl_params( _cdl, _weights, p );
+    _kernels->planes[known_precision( precision )][_luma][_paths]( 
+        p, r, g, b, pixels );
+}
+
+void CDLProcessor::reference( const ASC_CDL& c, const float in[3],
+                              float out[3], const float* luma )
+{
+    if ( !luma ) luma = kCDLLumaWeights[kCDLLumaRec709];
+
+    double v[3];
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        // in * slope + offset rounded to float as the kernels do; in
+        // double each step is exact before the rounding.
+        float m = (float)( (double) in[i] * c.slope(i) );
+        double x = (float)( (double) m + c.offset(i) );
+        if ( !( x > 0.0 ) ) x = 0.0;   // NaN too
+        if ( x > 1.0 ) x = 1.0;
+        v[i] = ::pow( x, (double) c.power(i) );
+    }
+
+    double l = (double) luma[0] * v[0] + (double) luma[1] * v[1] + 
+               (double) luma[2] * v[2];
+    for ( unsigned short i = 0; i < 3; ++i )
+        out[i] = (float)( l + c.saturation() * ( v[i] - l ) );
+}
+
+}  // namespace ACES
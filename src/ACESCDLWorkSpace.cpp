@@ -0,0 +1,299 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <math.h>
+#include <string.h>
+
+#include "ACESCDLWorkSpace.h"
+#include "ACESCDLKernels.h"
+
+
+namespace ACES {
+
+// ACES2065-1 to ACEScg primaries and back, row major
+static const float kAP0toAP1[9] = {
+ 1.4514393161f, -0.2365107469f, -0.2149285693f,
+-0.0765537734f,  1.1762296998f, -0.0996759264f,
+ 0.0083161484f, -0.0060324498f,  0.9977163014f
+};
+
+static const float kAP1toAP0[9] = {
+ 0.6954522414f,  0.1406786965f,  0.1638690622f,
+ 0.0447945634f,  0.8596711185f,  0.0955343182f,
+-0.0055258826f,  0.0040252103f,  1.0015006723f
+};
+
+static unsigned curve_of( WorkSpace s )
+{
+    switch( s )
+    {
+        case kWorkSpaceACEScc:
+            return kCurveACEScc;
+        case kWorkSpaceACEScct:
+            return kCurveACEScct;
+        default:
+            return kCurveLinear;
+    }
+}
+
+static bool known( WorkSpace s )
+{
+    return (unsigned) s < (unsigned) kWorkSpaceUnknown;
+}
+
+/** 
+ * The conversion from one space to another, which does nothing if
+ * either is unknown.
+ */
+static void make_convert( WorkSpace from, WorkSpace to, CDLConvert& c )
+{
+    c.decode = c.encode = kCurveLinear;
+    c.matrix = false;
+    if ( !known( from ) || !known( to ) || from == to ) return;
+
+    c.decode = curve_of( from );
+    c.encode = curve_of( to );
+    bool ap0_in  = from == kWorkSpaceACES;
+    bool ap0_out = to == kWorkSpaceACES;
+    c.matrix = ap0_in != ap0_out;
+    const float* m = ap0_in ? kAP0toAP1 : kAP1toAP0;
+    for ( unsigned i = 0; i < 9; ++i )
+        c.m[i] = m[i];
+}
+
+
+const char* workspace_name( WorkSpace s )
+{
+    switch( s )
+    {
+        case kWorkSpaceACES:
+            return "ACES";
+        case kWorkSpaceACEScg:
+            return "ACEScg";
+        case kWorkSpaceACEScc:
+            return "ACEScc";
+        case kWorkSpaceACEScct:
+            return "ACEScct";
+        default:
+            return "unknown";
+    }
+}
+
+static WorkSpace workspace_named( const std::string& name )
+{
+    for ( int s = kWorkSpaceACES; s < kWorkSpaceUnknown; ++s )
+    {
+        if ( name == workspace_name( (WorkSpace) s ) ) 
+            return (WorkSpace) s;
+    }
+    return kWorkSpaceUnknown;
+}
+
+bool workspace_conversion( const std::string& id, WorkSpace& from, 
+                           WorkSpace& to )
+{
+    from = to = kWorkSpaceUnknown;
+    if ( id.find( "ACEScsc" ) == std::string::npos ) return false;
+
+    // The names around _to_, between dots
+    size_t sep = id.find( "_to_" );
+    if ( sep == std::string::npos ) return false;
+    size_t start = id.find_last_of( ".:", sep );
+    start = start == std::string::npos ? 0 : start + 1;
+    size_t end = id.find( '.', sep + 4 );
+    if ( end == std::string::npos ) end = id.size();
+
+    from = workspace_named( id.substr( start, sep - start ) );
+    to   = workspace_named( id.substr( sep + 4, end - sep - 4 ) );
+    return known( from ) && known( to );
+}
+
+void convert_workspace( const float* in, float* out, size_t pixels, 
+                        unsigned channels, WorkSpace from, WorkSpace to,
+                        CDLPrecision precision )
+{
+    CDLConvert c;
+    make_convert( from, to, c );
+    if ( c.decode == c.encode && !c.matrix )
+    {
+        if ( in != out )
+            memmove( out, in, pixels * ( channels == 4 ? 4 : 3 ) *
+                     sizeof(float) );
+        return;
+    }
+
+    const CDLKernels* k = cdl_kernels( simd_level() );
+    k->convert[known_precision( precision )]( c, in, out, pixels, 
+                                    channels == 4 ? 4 : 3 );
+}
+
+
+CDLWorkSpaceProcessor::CDLWorkSpaceProcessor( const ASC_CDL& cdl,
+                                              WorkSpace space,
+                                              WorkSpace pixels )
+{
+    set( cdl, pixels, space, pixels );
+    luma( kCDLLumaRec709 );
+    simd( simd_level() );
+}
+
+CDLWorkSpaceProcessor::CDLWorkSpaceProcessor( const ACESclipMetadata& m )
+{
+    set( m.sops, m.convert_to, m.convert_from );
+    luma( kCDLLumaRec709 );
+    simd( simd_level() );
+}
+
+void CDLWorkSpaceProcessor::set( const ASC_CDL& cdl, WorkSpace in, 
+                                 WorkSpace space, WorkSpace out )
+{
+    _cdl = cdl;
+    _paths = cdl_paths( cdl );
+    _in = in;
+    _space = space;
+    _out = out;
+}
+
+bool CDLWorkSpaceProcessor::set( const ASC_CDL& cdl, 
+                                 const std::string& convert_to,
+                                 const std::string& convert_from )
+{
+    WorkSpace in, to, from, out;
+    bool ok = workspace_conversion( convert_to, in, to ) &&
+              workspace_conversion( convert_from, from, out ) &&
+              to == from;
+    if ( !ok ) in = to = out = kWorkSpaceUnknown;
+    set( cdl, in, to, out );
+    return ok;
+}
+
+void CDLWorkSpaceProcessor::luma( CDLLuma l )
+{
+    _luma = set_luma( l, _weights );
+}
+
+void CDLWorkSpaceProcessor::luma( float r, float g, float b )
+{
+    _luma = kCDLLumaCustom;
+    _weights[0] = r;
+    _weights[1] = g;
+    _weights[2] = b;
+}
+
+void CDLWorkSpaceProcessor::simd( SIMDLevel level )
+{
+    SIMDLevel best = simd_level();
+    if ( level > best ) level = best;
+
+    int l = level;
+    while ( l > kSIMDScalar && !cdl_kernels( (SIMDLevel) l ) )
+        --l;
+    _level = (SIMDLevel) l;
+    _kernels = cdl_kernels( _level );
+}
+
+void CDLWorkSpaceProcessor::apply( const float* in, float* out, 
+                                   size_t pixels, unsigned channels,
+                                   CDLPrecision precision ) const
+{
+    CDLParams p;
+    cdl_params( _cdl, _weights, p );
+    CDLConvert to, from;
+    make_convert( _in, _space, to );
+    make_convert( _space, _out, from );
+    _kernels->workspace[known_precision( precision )][_luma][_paths]( 
+        p, to, from, in, out, pixels, channels == 4 ? 4 : 3 );
+}
+
+
+//
+// The curves and conversions in double, for reference()
+//
+
+static double decode_ref( unsigned curve, double x )
+{
+    const double top = 1.4679963120447153;   // 65504 in either curve
+    if ( curve == kCurveLinear ) return x;
+    if ( x >= top ) return 65504.0;
+    if ( curve == kCurveACEScc && x < ( 9.72 - 15.0 ) / 17.52 )
+        return ( exp2( x * 17.52 - 9.72 ) - exp2( -16.0 ) ) * 2.0;
+    if ( curve == kCurveACEScct && x <= 0.155251141552511 )
+        return ( x - 0.0729055341958355 ) / 10.5402377416545;
+    return exp2( x * 17.52 - 9.72 );
+}
+
+static double encode_ref( unsigned curve, double lin )
+{
+    if ( curve == kCurveLinear ) return lin;
+    if ( curve == kCurveACEScct && !( lin > 0.0078125 ) )
+        return 10.5402377416545 * lin + 0.0729055341958355;
+    if ( curve == kCurveACEScc )
+    {
+        if ( !( lin > 0.0 ) ) lin = 0.0;   // NaN too
+        if ( lin < exp2( -15.0 ) ) lin = exp2( -16.0 ) + lin * 0.5;
+    }
+    return ( log2( lin ) + 9.72 ) / 17.52;
+}
+
+static void convert_ref( WorkSpace from, WorkSpace to, double v[3] )
+{
+    CDLConvert c;
+    make_convert( from, to, c );
+
+    for ( unsigned i = 0; i < 3; ++i )
+        v[i] = decode_ref( c.decode, v[i] );
+    if ( c.matrix )
+    {
+        // The matrices in double, as written above
+        double r = v[0], g = v[1], b = v[2];
+        for ( unsigned i = 0; i < 3; ++i )
+            v[i] = (double) c.m[i*3] * r + (double) c.m[i*3+1] * g +
+                   (double) c.m[i*3+2] * b;
+    }
+    for ( unsigned i = 0; i < 3; ++i )
+        v[i] = encode_ref( c.encode, v[i] );
+}
+
+void CDLWorkSpaceProcessor::reference( const ASC_CDL& c, WorkSpace in,
+                                       WorkSpace space, WorkSpace out,
+                                       const float rgb[3], 
+                                       float result[3], const float* luma )
+{
+    double v[3] = { rgb[0], rgb[1], rgb[2] };
+    convert_ref( in, space, v );
+
+    float graded[3] = { (float) v[0], (float) v[1], (float) v[2] };
+    CDLProcessor::reference( c, graded, graded, luma );
+
+    for ( unsigned i = 0; i < 3; ++i ) v[i] = graded[i];
+    convert_ref( space, out, v );
+    for ( unsigned i = 0; i < 3; ++i ) result[i] = (float) v[i];
+}
+
+}  // namespace ACES
@@ -0,0 +1,115 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESHalf_h
+#define ACESHalf_h
+
+//
+// Conversions between float and IEEE 754 half (binary16), as stored in
+// 16f images.  Bit manipulation only, so they need no tables and no
+// F16C instructions.
+//
+
+#include <stdint.h>
+#include <string.h>
+
+namespace ACES {
+
+/** 
+ * Half to float.  Exact for every half, subnormals, infinities and NaN
+ * included.
+ */
+inline float half_to_float( uint16_t h )
+{
+    uint32_t sign = (uint32_t)( h & 0x8000 ) << 16;
+    uint32_t exp  = ( h >> 10 ) & 0x1f;
+    uint32_t man  = h & 0x3ff;
+    uint32_t bits;
+
+    if ( exp == 0x1f )                    // inf, NaN
+        bits = sign | 0x7f800000 | ( man << 13 );
+    else if ( exp != 0 )                  // normal
+        bits = sign | ( ( exp + 112 ) << 23 ) | ( man << 13 );
+    else if ( man == 0 )                  // zero
+        bits = sign;
+    else                                  // subnormal, normalize it
+    {
+        exp = 113;
+        while ( !( man & 0x400 ) )
+        {
+            man <<= 1;
+            --exp;
+        }
+        bits = sign | ( exp << 23 ) | ( ( man & 0x3ff ) << 13 );
+    }
+
+    float f;
+    memcpy( &f, &bits, sizeof(f) );
+    return f;
+}
+
+/** 
+ * Float to half, rounded to nearest even.  Overflow gives infinity and
+ * NaN stays NaN.
+ */
+inline uint16_t float_to_half( float f )
+{
+    uint32_t bits;
+    memcpy( &bits, &f, sizeof(bits) );
+
+    uint16_t sign = (uint16_t)( ( bits >> 16 ) & 0x8000 );
+    uint32_t a = bits & 0x7fffffff;
+
+    if ( a >= 0x7f800000 )                // inf, NaN
+        return sign | 0x7c00 | ( a > 0x7f800000 ? 0x200 : 0 );
+    if ( a >= 0x477ff000 )                // rounds past 65504
+        return sign | 0x7c00;
+    if ( a < 0x38800000 )                 // subnormal or zero
+    {
+        if ( a < 0x33000000 ) return sign;   // below half the smallest
+        uint32_t exp = a >> 23;
+        uint32_t man = ( a & 0x7fffff ) | 0x800000;
+        uint32_t shift = 126 - exp;          // 14..24
+        uint32_t h = man >> shift;
+        uint32_t rest = man & ( ( 1u << shift ) - 1 );
+        uint32_t half = 1u << ( shift - 1 );
+        if ( rest > half || ( rest == half && ( h & 1 ) ) ) ++h;
+        return sign | (uint16_t) h;
+    }
+
+    // Normal: rebias and round the 13 bits dropped to nearest, ties to
+    // even, without a branch.  A carry out of the mantissa goes into
+    // the exponent, as it should.
+    uint32_t odd = ( a >> 13 ) & 1;
+    return sign | (uint16_t)( ( a - 0x38000000 + 0xfff + odd ) >> 13 );
+}
+
+}  // namespace ACES
+
+#endif  // ACESHalf_h
@@ -0,0 +1,65 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESHash_h
+#define ACESHash_h
+
+#include <stddef.h>
+
+namespace ACES {
+
+typedef unsigned long long HashValue;
+
+const HashValue kFNVOffset = 14695981039346656037ULL;
+const HashValue kFNVPrime  = 1099511628211ULL;
+
+/** 
+ * 64-bit FNV-1a hash of some bytes.
+ * 
+ * @param data  bytes to hash
+ * @param size  number of bytes
+ * @param h     hash to continue from
+ * 
+ * @return hash value
+ */
+inline HashValue fnv1a( const void* data, size_t size, 
+                        HashValue h = kFNVOffset )
+{
+    const unsigned char* p = (const unsigned char*) data;
+    for ( size_t i = 0; i < size; ++i )
+    {
+        h ^= p[i];
+        h *= kFNVPrime;
+    }
+    return h;
+}
+
+}  // namespace ACES
+
+#endif  // ACESHash_h
@@ -0,0 +1,158 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "ACESMappedFile.h"
+
+
+namespace ACES {
+
+MappedFile::MappedFile() :
+_data( NULL ),
+_size( 0 )
+#ifdef _WIN32
+, _file( INVALID_HANDLE_VALUE ),
+_mapping( NULL )
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open( const char* filename )
+{
+    close();
+
+    HANDLE f = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+    if ( f == INVALID_HANDLE_VALUE ) return false;
+    _file = f;
+
+    LARGE_INTEGER size;
+    if ( !GetFileSizeEx( f, &size ) )
+    {
+        close();
+        return false;
+    }
+
+    _size = (size_t) size.QuadPart;
+    if ( _size == 0 ) return true;
+
+    HANDLE m = CreateFileMappingA( f, NULL, PAGE_READONLY, 0, 0, NULL );
+    if ( !m )
+    {
+        close();
+        return false;
+    }
+    _mapping = m;
+
+    _data = (const char*) MapViewOfFile( m, FILE_MAP_READ, 0, 0, 0 );
+    if ( !_data )
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if ( _data ) UnmapViewOfFile( _data );
+    if ( _mapping ) CloseHandle( (HANDLE) _mapping );
+    if ( _file != INVALID_HANDLE_VALUE ) CloseHandle( (HANDLE) _file );
+    _data = NULL;
+    _size = 0;
+    _mapping = NULL;
+    _file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open( const char* filename )
+{
+    close();
+
+    int fd = ::open( filename, O_RDONLY );
+    if ( fd < 0 ) return false;
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 )
+    {
+        ::close( fd );
+        return false;
+    }
+
+    _size = (size_t) st.st_size;
+    if ( _size == 0 )
+    {
+        ::close( fd );
+        return true;
+    }
+
+    void* p = mmap( NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd );   // the mapping keeps its own reference to the file
+
+    if ( p == MAP_FAILED )
+    {
+        _size = 0;
+        return false;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    madvise( p, _size, MADV_SEQUENTIAL );
+#endif
+
+    _data = (const char*) p;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if ( _data ) munmap( (void*) _data, _size );
+    _data = NULL;
+    _size = 0;
+}
+
+#endif
+
+}  // namespace ACES
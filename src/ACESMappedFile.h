@@ -0,0 +1,83 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESMappedFile_h
+#define ACESMappedFile_h
+
+#include <stddef.h>
+
+namespace ACES {
+
+/**
+ * MappedFile:  read-only memory mapping of a whole file.
+ *
+ * The mapping stays valid until close() is called or the object is
+ * destroyed.  Empty files are opened successfully with a NULL data()
+ * and a size() of 0.
+ */
+class MappedFile
+{
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    /** 
+     * Map a file in memory.
+     * 
+     * @param filename file to map.
+     * 
+     * @return true on success, false on failure
+     */
+    bool open( const char* filename );
+
+    /** 
+     * Unmap the file, if any.
+     * 
+     */
+    void close();
+
+    const char* data() const { return _data; }
+    size_t      size() const { return _size; }
+
+  private:
+    MappedFile( const MappedFile& );
+    MappedFile& operator=( const MappedFile& );
+
+  protected:
+    const char* _data;
+    size_t      _size;
+#ifdef _WIN32
+    void*       _file;
+    void*       _mapping;
+#endif
+};
+
+}  // namespace ACES
+
+#endif  // ACESMappedFile_h
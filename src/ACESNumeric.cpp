@@ -0,0 +1,941 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <string.h>
+#include <math.h>
+#include <limits>
+
+#include "ACESNumeric.h"
+
+namespace ACES {
+
+namespace {
+
+typedef unsigned long long uint64;
+
+inline bool is_space( char c )
+{
+    return ( c == ' ' || c == '\t' || c == '\n' || c == '\r' ||
+             c == '\v' || c == '\f' );
+}
+
+inline bool is_digit( char c )
+{
+    return ( c >= '0' && c <= '9' );
+}
+
+inline char lower( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? char( c - 'A' + 'a' ) : c;
+}
+
+/** 
+ * Match a case insensitive keyword (in lowercase) at s.
+ * 
+ * @return number of characters matched or 0.
+ */
+size_t match( const char* s, const char* last, const char* keyword )
+{
+    size_t n = strlen( keyword );
+    if ( size_t( last - s ) < n ) return 0;
+    for ( size_t i = 0; i < n; ++i )
+        if ( lower( s[i] ) != keyword[i] ) return 0;
+    return n;
+}
+
+// Powers of ten exactly representable as a double and as a float.
+const double kPow10d[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const float kPow10f[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/** 
+ * Result of the syntax pass: the number is mantissa * 10^exponent, with
+ * the first 19 significant digits in mantissa.  If more nonzero digits
+ * follow, truncated is set and the slow path is taken.
+ */
+struct Decimal
+{
+    const char* begin;    // first digit (after the sign)
+    const char* end;      // past the number
+    uint64 mantissa;
+    int    exponent;
+    bool   negative;
+    bool   truncated;
+    bool   special;       // inf or nan, value already stored in special_value
+    double special_value;
+};
+
+/** 
+ * Syntax pass.  Returns false if there is no number at first.
+ */
+bool scan_number( const char* first, const char* last, Decimal& d )
+{
+    const char* s = first;
+    while ( s != last && is_space( *s ) ) ++s;
+
+    d.negative = false;
+    d.truncated = false;
+    d.special = false;
+    d.mantissa = 0;
+    d.exponent = 0;
+
+    if ( s != last && ( *s == '-' || *s == '+' ) )
+    {
+        d.negative = ( *s == '-' );
+        ++s;
+    }
+    d.begin = s;
+
+    if ( s != last && !is_digit( *s ) && *s != '.' )
+    {
+        size_t n;
+        if ( ( n = match( s, last, "infinity" ) ) ||
+             ( n = match( s, last, "inf" ) ) )
+        {
+            d.special = true;
+            d.special_value = std::numeric_limits<double>::infinity();
+        }
+        else if ( ( n = match( s, last, "nan" ) ) )
+        {
+            d.special = true;
+            d.special_value = std::numeric_limits<double>::quiet_NaN();
+        }
+        else
+        {
+            return false;
+        }
+        if ( d.negative ) d.special_value = -d.special_value;
+        d.end = s + n;
+        return true;
+    }
+
+    int digits = 0;     // significant digits stored in mantissa
+    bool any = false;
+    for ( ; s != last && is_digit( *s ); ++s )
+    {
+        any = true;
+        if ( digits < 19 )
+        {
+            d.mantissa = d.mantissa * 10 + ( *s - '0' );
+            if ( d.mantissa ) ++digits;
+        }
+        else
+        {
+            ++d.exponent;
+            if ( *s != '0' ) d.truncated = true;
+        }
+    }
+    if ( s != last && *s == '.' )
+    {
+        ++s;
+        for ( ; s != last && is_digit( *s ); ++s )
+        {
+            any = true;
+            if ( digits < 19 )
+            {
+                d.mantissa = d.mantissa * 10 + ( *s - '0' );
+                if ( d.mantissa ) ++digits;
+                --d.exponent;
+            }
+            else if ( *s != '0' )
+            {
+                d.truncated = true;
+            }
+        }
+    }
+    if ( !any ) return false;
+
+    if ( s != last && lower( *s ) == 'e' )
+    {
+        const char* e = s + 1;
+        bool eneg = false;
+        if ( e != last && ( *e == '-' || *e == '+' ) )
+        {
+            eneg = ( *e == '-' );
+            ++e;
+        }
+        if ( e != last && is_digit( *e ) )
+        {
+            int x = 0;
+            for ( ; e != last && is_digit( *e ); ++e )
+                if ( x < 100000 ) x = x * 10 + ( *e - '0' );
+            d.exponent += eneg ? -x : x;
+            s = e;
+        }
+    }
+    d.end = s;
+    return true;
+}
+
+/** 
+ * Arbitrary precision decimal used by the slow path, when the fast
+ * exact computation is not possible.  This is the classic "simple
+ * decimal conversion": the number is scaled by powers of two until it
+ * lies in [0.5,1), then the mantissa bits are extracted.  Slow, but
+ * always correctly rounded and only hit by unusual input.
+ */
+struct BigDecimal
+{
+    enum { kMaxDigits = 800, kMaxShift = 60 };
+
+    unsigned char d[kMaxDigits];   // digits, most significant first
+    int  nd;                       // number of digits used
+    int  dp;                       // decimal point
+    bool trunc;                    // nonzero digits discarded
+
+    void set( const char* s, const char* last );
+    void trim();
+    void left_shift( unsigned k );
+    void right_shift( unsigned k );
+    void shift( int k );
+    bool round_up( int n ) const;
+    uint64 rounded_integer() const;
+};
+
+void BigDecimal::set( const char* s, const char* last )
+{
+    nd = 0;
+    dp = 0;
+    trunc = false;
+    bool dot = false;
+    for ( ; s != last; ++s )
+    {
+        if ( *s == '.' )
+        {
+            if ( dot ) break;
+            dot = true;
+            dp = nd;
+            continue;
+        }
+        if ( !is_digit( *s ) ) break;
+        if ( *s == '0' && nd == 0 )     // leading zeros
+        {
+            --dp;
+            continue;
+        }
+        if ( nd < kMaxDigits )
+            d[nd++] = (unsigned char)( *s - '0' );
+        else if ( *s != '0' )
+            trunc = true;
+    }
+    if ( !dot ) dp = nd;
+    if ( s != last && lower( *s ) == 'e' )
+    {
+        ++s;
+        bool eneg = false;
+        if ( s != last && ( *s == '-' || *s == '+' ) )
+        {
+            eneg = ( *s == '-' );
+            ++s;
+        }
+        int x = 0;
+        for ( ; s != last && is_digit( *s ); ++s )
+            if ( x < 100000 ) x = x * 10 + ( *s - '0' );
+        dp += eneg ? -x : x;
+    }
+    trim();
+}
+
+void BigDecimal::trim()
+{
+    while ( nd > 0 && d[nd-1] == 0 ) --nd;
+    if ( nd == 0 ) dp = 0;
+}
+
+// Multiply by 2^k, k <= kMaxShift.
+void BigDecimal::left_shift( unsigned k )
+{
+    // 2^k adds at most k*log10(2)+1 digits.  Write from the right and
+    // move the digits down if we overestimated.
+    int delta = int( k * 78 / 256 ) + 1;
+    int r = nd - 1;
+    int w = nd + delta;
+    uint64 n = 0;
+    for ( ; r >= 0; --r )
+    {
+        n += uint64( d[r] ) << k;
+        uint64 q = n / 10;
+        unsigned rem = unsigned( n - 10 * q );
+        --w;
+        if ( w < kMaxDigits ) d[w] = (unsigned char) rem;
+        else if ( rem != 0 ) trunc = true;
+        n = q;
+    }
+    while ( n > 0 )
+    {
+        uint64 q = n / 10;
+        unsigned rem = unsigned( n - 10 * q );
+        --w;
+        if ( w < kMaxDigits ) d[w] = (unsigned char) rem;
+        else if ( rem != 0 ) trunc = true;
+        n = q;
+    }
+    // w is now the index of the leading digit
+    int end = nd + delta < kMaxDigits ? nd + delta : kMaxDigits;
+    if ( w > 0 ) memmove( d, d + w, end - w );
+    nd = end - w;
+    dp += delta - w;
+    trim();
+}
+
+// Divide by 2^k, k <= kMaxShift.
+void BigDecimal::right_shift( unsigned k )
+{
+    int r = 0;
+    int w = 0;
+    uint64 n = 0;
+    for ( ; ( n >> k ) == 0; ++r )
+    {
+        if ( r >= nd )
+        {
+            if ( n == 0 )
+            {
+                nd = 0;
+                return;
+            }
+            while ( ( n >> k ) == 0 )
+            {
+                n *= 10;
+                ++r;
+            }
+            break;
+        }
+        n = n * 10 + d[r];
+    }
+    dp -= r - 1;
+
+    uint64 mask = ( uint64(1) << k ) - 1;
+    for ( ; r < nd; ++r )
+    {
+        d[w++] = (unsigned char)( n >> k );
+        n = ( n & mask ) * 10 + d[r];
+    }
+    while ( n > 0 )
+    {
+        unsigned dig = unsigned( n >> k );
+        n &= mask;
+        if ( w < kMaxDigits ) d[w++] = (unsigned char) dig;
+        else if ( dig > 0 ) trunc = true;
+        n *= 10;
+    }
+    nd = w;
+    trim();
+}
+
+void BigDecimal::shift( int k )
+{
+    if ( nd == 0 ) return;
+    if ( k > 0 )
+    {
+        for ( ; k > kMaxShift; k -= kMaxShift ) left_shift( kMaxShift );
+        left_shift( k );
+    }
+    else if ( k < 0 )
+    {
+        for ( ; k < -kMaxShift; k += kMaxShift ) right_shift( kMaxShift );
+        right_shift( -k );
+    }
+}
+
+// If we chop at n digits, should we round up?
+bool BigDecimal::round_up( int n ) const
+{
+    if ( n < 0 || n >= nd ) return false;
+    if ( d[n] == 5 && n + 1 == nd )   // exactly halfway, round to even
+    {
+        if ( trunc ) return true;
+        return n > 0 && ( d[n-1] % 2 ) == 1;
+    }
+    return d[n] >= 5;
+}
+
+uint64 BigDecimal::rounded_integer() const
+{
+    if ( dp > 20 ) return ~uint64(0);
+    uint64 n = 0;
+    int i = 0;
+    for ( ; i < dp && i < nd; ++i ) n = n * 10 + d[i];
+    for ( ; i < dp; ++i ) n *= 10;
+    if ( round_up( dp ) ) ++n;
+    return n;
+}
+
+/** 
+ * Slow path.  Returns the IEEE bits of the correctly rounded number
+ * with mantbits/expbits/bias describing the format.
+ */
+uint64 slow_bits( const Decimal& x, unsigned mantbits, unsigned expbits,
+                  int bias )
+{
+    static const int kPowTab[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+    const int kPowTabSize = int( sizeof(kPowTab) / sizeof(int) );
+
+    BigDecimal b;
+    b.set( x.begin, x.end );
+
+    uint64 mant = 0;
+    int exp = bias;
+    const int exp_max = ( 1 << expbits ) - 1;
+
+    if ( b.nd == 0 || b.dp < -330 )
+    {
+        mant = 0;
+        exp = bias;
+    }
+    else if ( b.dp > 310 )
+    {
+        mant = 0;
+        exp = exp_max + bias;
+    }
+    else
+    {
+        // Scale to [0.5,1)
+        exp = 0;
+        while ( b.dp > 0 )
+        {
+            int n = b.dp >= kPowTabSize ? 27 : kPowTab[b.dp];
+            b.shift( -n );
+            exp += n;
+        }
+        while ( b.dp < 0 || ( b.dp == 0 && b.d[0] < 5 ) )
+        {
+            int n = -b.dp >= kPowTabSize ? 27 : kPowTab[-b.dp];
+            b.shift( n );
+            exp -= n;
+        }
+        --exp;   // [0.5,1) -> [1,2)
+
+        if ( exp < bias + 1 )   // denormal
+        {
+            int n = bias + 1 - exp;
+            b.shift( -n );
+            exp += n;
+        }
+
+        if ( exp - bias >= exp_max )
+        {
+            mant = 0;
+            exp = exp_max + bias;
+        }
+        else
+        {
+            b.shift( int( mantbits ) + 1 );
+            mant = b.rounded_integer();
+            if ( mant == ( uint64(2) << mantbits ) )
+            {
+                mant >>= 1;
+                ++exp;
+            }
+            if ( exp - bias >= exp_max )
+            {
+                mant = 0;
+                exp = exp_max + bias;
+            }
+            else if ( ( mant & ( uint64(1) << mantbits ) ) == 0 )
+            {
+                exp = bias;
+            }
+        }
+    }
+
+    uint64 bits = mant & ( ( uint64(1) << mantbits ) - 1 );
+    bits |= uint64( ( exp - bias ) & exp_max ) << mantbits;
+    if ( x.negative ) bits |= uint64(1) << ( mantbits + expbits );
+    return bits;
+}
+
+double slow_double( const Decimal& x )
+{
+    uint64 bits = slow_bits( x, 52, 11, -1023 );
+    double r;
+    memcpy( &r, &bits, sizeof(r) );
+    return r;
+}
+
+float slow_float( const Decimal& x )
+{
+    unsigned bits = unsigned( slow_bits( x, 23, 8, -127 ) );
+    float r;
+    memcpy( &r, &bits, sizeof(r) );
+    return r;
+}
+
+/** 
+ * Clinger's fast path: when the mantissa and the power of ten are both
+ * exact doubles, a single multiplication or division is correctly
+ * rounded.
+ */
+inline bool fast_double( const Decimal& x, double& r )
+{
+    if ( x.truncated || x.mantissa > ( uint64(1) << 53 ) ) return false;
+    if ( x.exponent < -22 || x.exponent > 22 ) return false;
+    r = double( x.mantissa );
+    if ( x.exponent < 0 ) r /= kPow10d[-x.exponent];
+    else                  r *= kPow10d[x.exponent];
+    if ( x.negative ) r = -r;
+    return true;
+}
+
+
+//
+// Shortest round trip formatting of floats, after Ulf Adams' Ryu
+// (PLDI 2018).  f2s() finds the shortest decimal digits that parse back
+// to the same float, choosing the closest one when several qualify.
+//
+
+static const unsigned kFloatPow5InvBits = 59;
+static const unsigned kFloatPow5Bits = 61;
+
+// ceil( 2^( pow5bits(i) - 1 + 59 ) / 5^i )
+static const uint64 kFloatPow5InvSplit[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u,
+    295147905179352826u, 472236648286964522u, 377789318629571618u,
+    302231454903657294u, 483570327845851670u, 386856262276681336u,
+    309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u,
+    324518553658426727u, 519229685853482763u, 415383748682786211u,
+    332306998946228969u, 531691198313966350u, 425352958651173080u,
+    340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u,
+    356811923176489971u, 570899077082383953u, 456719261665907162u,
+    365375409332725730u
+};
+
+// 5^i in its top 61 bits
+static const uint64 kFloatPow5Split[48] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+    2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+    2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+    2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+    2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+    2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+    1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+    1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+    1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+    1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+    1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+    1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+    1615587133892632177u, 2019483917365790221u, 1262177448353618888u
+};
+
+// ceil( log2( 5^e ) ), or 1 for e = 0
+inline int pow5bits( int e )
+{
+    return int( ( unsigned( e ) * 1217359 ) >> 19 ) + 1;
+}
+
+// floor( log10( 2^e ) )
+inline int log10_pow2( int e )
+{
+    return int( ( unsigned( e ) * 78913 ) >> 18 );
+}
+
+// floor( log10( 5^e ) )
+inline int log10_pow5( int e )
+{
+    return int( ( unsigned( e ) * 732923 ) >> 20 );
+}
+
+inline unsigned pow5_factor( unsigned v )
+{
+    unsigned count = 0;
+    while ( v % 5 == 0 )
+    {
+        v /= 5;
+        ++count;
+    }
+    return count;
+}
+
+inline bool multiple_of_pow5( unsigned v, int p )
+{
+    return int( pow5_factor( v ) ) >= p;
+}
+
+inline bool multiple_of_pow2( unsigned v, int p )
+{
+    return ( v & ( ( 1u << p ) - 1 ) ) == 0;
+}
+
+// ( m * factor ) >> shift, for shift > 32
+inline unsigned mul_shift( unsigned m, uint64 factor, int shift )
+{
+    uint64 lo = uint64( m ) * unsigned( factor );
+    uint64 hi = uint64( m ) * unsigned( factor >> 32 );
+    uint64 sum = ( lo >> 32 ) + hi;
+    return unsigned( sum >> ( shift - 32 ) );
+}
+
+inline unsigned mul_pow5_inv_div_pow2( unsigned m, int q, int j )
+{
+    return mul_shift( m, kFloatPow5InvSplit[q], j );
+}
+
+inline unsigned mul_pow5_div_pow2( unsigned m, int i, int j )
+{
+    return mul_shift( m, kFloatPow5Split[i], j );
+}
+
+/** 
+ * Shortest decimal digits * 10^exponent of a positive finite float,
+ * from its IEEE fields.
+ */
+void f2s( unsigned ieee_mantissa, unsigned ieee_exponent,
+          unsigned& digits, int& exponent )
+{
+    int e2;
+    unsigned m2;
+    if ( ieee_exponent == 0 )
+    {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = ieee_mantissa;
+    }
+    else
+    {
+        e2 = int( ieee_exponent ) - 127 - 23 - 2;
+        m2 = ( 1u << 23 ) | ieee_mantissa;
+    }
+    const bool accept_bounds = ( m2 & 1 ) == 0;
+
+    // The value and the halfway points to its neighbours, times 4.
+    const unsigned mv = 4 * m2;
+    const unsigned mp = 4 * m2 + 2;
+    const unsigned mm_shift = ( ieee_mantissa != 0 || ieee_exponent <= 1 );
+    const unsigned mm = 4 * m2 - 1 - mm_shift;
+
+    // Scale them to decimal, keeping track of the digits dropped.
+    unsigned vr, vp, vm;
+    int e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    unsigned last_removed = 0;
+    if ( e2 >= 0 )
+    {
+        const int q = log10_pow2( e2 );
+        e10 = q;
+        const int k = kFloatPow5InvBits + pow5bits( q ) - 1;
+        const int i = -e2 + q + k;
+        vr = mul_pow5_inv_div_pow2( mv, q, i );
+        vp = mul_pow5_inv_div_pow2( mp, q, i );
+        vm = mul_pow5_inv_div_pow2( mm, q, i );
+        if ( q != 0 && ( vp - 1 ) / 10 <= vm / 10 )
+        {
+            const int l = kFloatPow5InvBits + pow5bits( q - 1 ) - 1;
+            last_removed = mul_pow5_inv_div_pow2( mv, q - 1,
+                                                  -e2 + q - 1 + l ) % 10;
+        }
+        if ( q <= 9 )
+        {
+            if ( mv % 5 == 0 )
+                vr_trailing_zeros = multiple_of_pow5( mv, q );
+            else if ( accept_bounds )
+                vm_trailing_zeros = multiple_of_pow5( mm, q );
+            else
+                vp -= multiple_of_pow5( mp, q );
+        }
+    }
+    else
+    {
+        const int q = log10_pow5( -e2 );
+        e10 = q + e2;
+        const int i = -e2 - q;
+        const int k = pow5bits( i ) - kFloatPow5Bits;
+        int j = q - k;
+        vr = mul_pow5_div_pow2( mv, i, j );
+        vp = mul_pow5_div_pow2( mp, i, j );
+        vm = mul_pow5_div_pow2( mm, i, j );
+        if ( q != 0 && ( vp - 1 ) / 10 <= vm / 10 )
+        {
+            j = q - 1 - ( pow5bits( i + 1 ) - kFloatPow5Bits );
+            last_removed = mul_pow5_div_pow2( mv, i + 1, j ) % 10;
+        }
+        if ( q <= 1 )
+        {
+            vr_trailing_zeros = true;
+            if ( accept_bounds )
+                vm_trailing_zeros = mm_shift == 1;
+            else
+                --vp;
+        }
+        else if ( q < 31 )
+        {
+            vr_trailing_zeros = multiple_of_pow2( mv, q - 1 );
+        }
+    }
+
+    // Drop digits while the interval still holds a shorter number.
+    int removed = 0;
+    if ( vm_trailing_zeros || vr_trailing_zeros )
+    {
+        while ( vp / 10 > vm / 10 )
+        {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        if ( vm_trailing_zeros )
+        {
+            while ( vm % 10 == 0 )
+            {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                ++removed;
+            }
+        }
+        // Exactly halfway: round to even.
+        if ( vr_trailing_zeros && last_removed == 5 && vr % 2 == 0 )
+            last_removed = 4;
+        digits = vr + ( ( vr == vm &&
+                          ( !accept_bounds || !vm_trailing_zeros ) ) ||
+                        last_removed >= 5 );
+    }
+    else
+    {
+        while ( vp / 10 > vm / 10 )
+        {
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            ++removed;
+        }
+        digits = vr + ( vr == vm || last_removed >= 5 );
+    }
+    exponent = e10 + removed;
+}
+
+}  // namespace
+
+
+const char* parse_double( const char* first, const char* last,
+                          double& value )
+{
+    Decimal x;
+    if ( !first || !scan_number( first, last, x ) ) return first;
+
+    if ( x.special )
+        value = x.special_value;
+    else if ( x.mantissa == 0 )
+        value = x.negative ? -0.0 : 0.0;
+    else if ( !fast_double( x, value ) )
+        value = slow_double( x );
+    return x.end;
+}
+
+const char* parse_float( const char* first, const char* last,
+                         float& value )
+{
+    Decimal x;
+    if ( !first || !scan_number( first, last, x ) ) return first;
+
+    if ( x.special )
+    {
+        value = float( x.special_value );
+        return x.end;
+    }
+    if ( x.mantissa == 0 )
+    {
+        value = x.negative ? -0.0f : 0.0f;
+        return x.end;
+    }
+
+    // Clinger's fast path in single precision.
+    if ( !x.truncated && x.mantissa <= ( uint64(1) << 24 ) &&
+         x.exponent >= -10 && x.exponent <= 10 )
+    {
+        float r = float( x.mantissa );
+        if ( x.exponent < 0 ) r /= kPow10f[-x.exponent];
+        else                  r *= kPow10f[x.exponent];
+        value = x.negative ? -r : r;
+        return x.end;
+    }
+
+    // Exact double rounded to float.  This can only round twice the
+    // wrong way if the double lands exactly halfway between two floats.
+    double d;
+    if ( fast_double( x, d ) )
+    {
+        float f = float( d );
+        double fd = f;
+        if ( fd == d ) 
+        {
+            value = f;
+            return x.end;
+        }
+        float g = fd < d ? 
+                  nextafterf( f, std::numeric_limits<float>::infinity() ) :
+                  nextafterf( f, -std::numeric_limits<float>::infinity() );
+        if ( ( fd + double( g ) ) * 0.5 != d )
+        {
+            value = f;
+            return x.end;
+        }
+    }
+
+    value = slow_float( x );
+    return x.end;
+}
+
+const char* parse_V3( const char* first, const char* last, float out[3] )
+{
+    const char* s = first;
+    for ( int i = 0; i < 3; ++i )
+    {
+        out[i] = 0.0f;
+        s = parse_float( s, last, out[i] );
+    }
+    return s;
+}
+
+char* format_float( float value, char* out )
+{
+    unsigned bits;
+    memcpy( &bits, &value, sizeof(bits) );
+    const unsigned ieee_mantissa = bits & ( ( 1u << 23 ) - 1 );
+    const unsigned ieee_exponent = ( bits >> 23 ) & 0xff;
+    const bool negative = ( bits >> 31 ) != 0;
+
+    char* p = out;
+    if ( ieee_exponent == 0xff )
+    {
+        if ( ieee_mantissa ) 
+        {
+            memcpy( p, "nan", 4 );
+            return p + 3;
+        }
+        if ( negative ) *p++ = '-';
+        memcpy( p, "inf", 4 );
+        return p + 3;
+    }
+    if ( negative ) *p++ = '-';
+    if ( ieee_exponent == 0 && ieee_mantissa == 0 )
+    {
+        *p++ = '0';
+        *p = 0;
+        return p;
+    }
+
+    unsigned digits;
+    int exponent;
+    f2s( ieee_mantissa, ieee_exponent, digits, exponent );
+
+    char d[10];
+    int n = 0;
+    for ( unsigned v = digits; v; v /= 10 )
+        d[n++] = char( '0' + v % 10 );
+    // d holds the n digits backwards; x is the power of ten of the first.
+    const int x = exponent + n - 1;
+
+    if ( x >= -4 && x < 9 )
+    {
+        if ( x < 0 )
+        {
+            *p++ = '0';
+            *p++ = '.';
+            for ( int i = -1; i > x; --i ) *p++ = '0';
+            while ( n ) *p++ = d[--n];
+        }
+        else
+        {
+            for ( int i = 0; i <= x; ++i ) 
+                *p++ = n ? d[--n] : '0';
+            if ( n )
+            {
+                *p++ = '.';
+                while ( n ) *p++ = d[--n];
+            }
+        }
+    }
+    else
+    {
+        // Scientific notation, as printf's %g writes it: 1.5e-07
+        *p++ = d[--n];
+        if ( n )
+        {
+            *p++ = '.';
+            while ( n ) *p++ = d[--n];
+        }
+        *p++ = 'e';
+        int e = x;
+        if ( e < 0 )
+        {
+            *p++ = '-';
+            e = -e;
+        }
+        else
+        {
+            *p++ = '+';
+        }
+        if ( e >= 10 ) *p++ = char( '0' + e / 10 );
+        else           *p++ = '0';
+        *p++ = char( '0' + e % 10 );
+    }
+    *p = 0;
+    return p;
+}
+
+char* format_V3( const float v[3], char* out )
+{
+    char* p = format_float( v[0], out );
+    *p++ = ' ';
+    p = format_float( v[1], p );
+    *p++ = ' ';
+    return format_float( v[2], p );
+}
+
+float to_float( const char* s )
+{
+    float r = 0.0f;
+    if ( s ) parse_float( s, s + strlen(s), r );
+    return r;
+}
+
+double to_double( const char* s )
+{
+    double r = 0.0;
+    if ( s ) parse_double( s, s + strlen(s), r );
+    return r;
+}
+
+}  // namespace ACES
@@ -0,0 +1,439 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESSimd_h
+#define ACESSimd_h
+
+//
+// Thin wrappers over one vector instruction set each, so a kernel is
+// written once as a template and compiled for all of them:
+//
+//   Scalar   plain floats, for the fallback and for any CPU
+//   SSE4     4 floats, -msse4.1
+//   AVX2     8 floats, -mavx2 -mfma
+//   AVX512   16 floats, -mavx512f
+//
+// A wrapper is only defined when the translation unit is compiled for
+// its instruction set.  Everything here has internal linkage: the
+// kernel files are compiled with different flags, and an inline
+// function merged across them could run AVX code on a CPU without it.
+// They are also compiled with -ffp-contract=off, so a kernel rounds
+// the same on all of them unless it asks for fmadd().
+//
+// Each wrapper has F (floats), I (32 bit ints) and M (lane masks), and
+// N, the number of lanes.  bits() of a mask has bit i set for lane i.
+// gather() loads each lane from a table by index: with one instruction
+// on AVX2 and AVX-512, a lane at a time on the others.
+//
+
+#include <math.h>
+#include <string.h>
+
+// MSVC has no flag for SSE4 and does not say when FMA is there, so
+// CMake names the instruction set of a file with ACES_SIMD_*.
+#if defined(__SSE4_1__) || defined(ACES_SIMD_SSE4)
+#define ACES_HAS_SSE4
+#endif
+#if ( defined(__AVX2__) && defined(__FMA__) ) || defined(ACES_SIMD_AVX2)
+#define ACES_HAS_AVX2
+#endif
+#if defined(__AVX512F__) || defined(ACES_SIMD_AVX512)
+#define ACES_HAS_AVX512
+#endif
+
+#if defined(ACES_HAS_SSE4) || defined(ACES_HAS_AVX2) || \
+    defined(ACES_HAS_AVX512)
+#include <immintrin.h>
+#endif
+
+#if defined(ACES_HAS_AVX512) && defined(__GNUC__) && !defined(__clang__)
+// GCC 12 takes the undefined vectors the AVX-512 intrinsics start from
+// for uninitialized variables.
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace ACES {
+namespace {
+
+struct Scalar
+{
+    typedef float F;
+    typedef int   I;
+    typedef bool  M;
+    enum { N = 1 };
+
+    static F load( const float* p )      { return *p; }
+    static void store( float* p, F a )   { *p = a; }
+    static F set1( float a )             { return a; }
+    static F gather( const float* p, I i ) { return p[i]; }
+
+    static F add( F a, F b )             { return a + b; }
+    static F sub( F a, F b )             { return a - b; }
+    static F mul( F a, F b )             { return a * b; }
+    static F div( F a, F b )             { return a / b; }
+    static F fmadd( F a, F b, F c )      { return a * b + c; }
+    // NaN gives b, as the SSE instructions do
+    static F min( F a, F b )             { return a < b ? a : b; }
+    static F max( F a, F b )             { return a > b ? a : b; }
+    static F floor( F a )                { return ::floorf( a ); }
+
+    static M lt( F a, F b )              { return a < b; }
+    static M gt( F a, F b )              { return a > b; }
+    static M eq( F a, F b )              { return a == b; }
+    static F select( M m, F a, F b )     { return m ? a : b; }
+    static unsigned bits( M m )          { return m ? 1u : 0u; }
+
+    static I as_int( F a )               { I i; memcpy( &i, &a, 4 ); return i; }
+    static F as_float( I i )             { F a; memcpy( &a, &i, 4 ); return a; }
+    static I iset1( int a )              { return a; }
+    static I iadd( I a, I b )            { return a + b; }
+    static I isub( I a, I b )            { return a - b; }
+    static I imul( I a, I b )            { return a * b; }
+    static I iand( I a, I b )            { return a & b; }
+    static I ior( I a, I b )             { return a | b; }
+    static I shl23( I a )                { return (I)( (unsigned) a << 23 ); }
+    static I shr23( I a )                { return (I)( (unsigned) a >> 23 ); }
+    static I sra1( I a )                 { return a >> 1; }
+    static F to_float( I a )             { return (F) a; }
+    static I to_int( F a )               { return (I) a; }   // a is whole
+};
+
+#ifdef ACES_HAS_SSE4
+struct SSE4
+{
+    typedef __m128  F;
+    typedef __m128i I;
+    typedef __m128  M;
+    enum { N = 4 };
+
+    static F load( const float* p )      { return _mm_loadu_ps( p ); }
+    static void store( float* p, F a )   { _mm_storeu_ps( p, a ); }
+    static F set1( float a )             { return _mm_set1_ps( a ); }
+    static F gather( const float* p, I i )
+    {
+        return _mm_setr_ps( p[_mm_extract_epi32( i, 0 )], 
+                            p[_mm_extract_epi32( i, 1 )],
+                            p[_mm_extract_epi32( i, 2 )], 
+                            p[_mm_extract_epi32( i, 3 )] );
+    }
+
+    static F add( F a, F b )             { return _mm_add_ps( a, b ); }
+    static F sub( F a, F b )             { return _mm_sub_ps( a, b ); }
+    static F mul( F a, F b )             { return _mm_mul_ps( a, b ); }
+    static F div( F a, F b )             { return _mm_div_ps( a, b ); }
+    static F fmadd( F a, F b, F c )      { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+    static F min( F a, F b )             { return _mm_min_ps( a, b ); }
+    static F max( F a, F b )             { return _mm_max_ps( a, b ); }
+    static F floor( F a )                { return _mm_floor_ps( a ); }
+
+    static M lt( F a, F b )              { return _mm_cmplt_ps( a, b ); }
+    static M gt( F a, F b )              { return _mm_cmpgt_ps( a, b ); }
+    static M eq( F a, F b )              { return _mm_cmpeq_ps( a, b ); }
+    static F select( M m, F a, F b )     { return _mm_blendv_ps( b, a, m ); }
+    static unsigned bits( M m )          { return (unsigned) _mm_movemask_ps( m ); }
+
+    static I as_int( F a )               { return _mm_castps_si128( a ); }
+    static F as_float( I i )             { return _mm_castsi128_ps( i ); }
+    static I iset1( int a )              { return _mm_set1_epi32( a ); }
+    static I iadd( I a, I b )            { return _mm_add_epi32( a, b ); }
+    static I isub( I a, I b )            { return _mm_sub_epi32( a, b ); }
+    static I imul( I a, I b )            { return _mm_mullo_epi32( a, b ); }
+    static I iand( I a, I b )            { return _mm_and_si128( a, b ); }
+    static I ior( I a, I b )             { return _mm_or_si128( a, b ); }
+    static I shl23( I a )                { return _mm_slli_epi32( a, 23 ); }
+    static I shr23( I a )                { return _mm_srli_epi32( a, 23 ); }
+    static I sra1( I a )                 { return _mm_srai_epi32( a, 1 ); }
+    static F to_float( I a )             { return _mm_cvtepi32_ps( a ); }
+    static I to_int( F a )               { return _mm_cvttps_epi32( a ); }
+};
+#endif
+
+#ifdef ACES_HAS_AVX2
+struct AVX2
+{
+    typedef __m256  F;
+    typedef __m256i I;
+    typedef __m256  M;
+    enum { N = 8 };
+
+    static F load( const float* p )      { return _mm256_loadu_ps( p ); }
+    static void store( float* p, F a )   { _mm256_storeu_ps( p, a ); }
+    static F set1( float a )             { return _mm256_set1_ps( a ); }
+    static F gather( const float* p, I i ) { return _mm256_i32gather_ps( p, i, 4 ); }
+
+    static F add( F a, F b )             { return _mm256_add_ps( a, b ); }
+    static F sub( F a, F b )             { return _mm256_sub_ps( a, b ); }
+    static F mul( F a, F b )             { return _mm256_mul_ps( a, b ); }
+    static F div( F a, F b )             { return _mm256_div_ps( a, b ); }
+    static F fmadd( F a, F b, F c )      { return _mm256_fmadd_ps( a, b, c ); }
+    static F min( F a, F b )             { return _mm256_min_ps( a, b ); }
+    static F max( F a, F b )             { return _mm256_max_ps( a, b ); }
+    static F floor( F a )                { return _mm256_floor_ps( a ); }
+
+    static M lt( F a, F b )              { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+    static M gt( F a, F b )              { return _mm256_cmp_ps( a, b, _CMP_GT_OQ ); }
+    static M eq( F a, F b )              { return _mm256_cmp_ps( a, b, _CMP_EQ_OQ ); }
+    static F select( M m, F a, F b )     { return _mm256_blendv_ps( b, a, m ); }
+    static unsigned bits( M m )          { return (unsigned) _mm256_movemask_ps( m ); }
+
+    static I as_int( F a )               { return _mm256_castps_si256( a ); }
+    static F as_float( I i )             { return _mm256_castsi256_ps( i ); }
+    static I iset1( int a )              { return _mm256_set1_epi32( a ); }
+    static I iadd( I a, I b )            { return _mm256_add_epi32( a, b ); }
+    static I isub( I a, I b )            { return _mm256_sub_epi32( a, b ); }
+    static I imul( I a, I b )            { return _mm256_mullo_epi32( a, b ); }
+    static I iand( I a, I b )            { return _mm256_and_si256( a, b ); }
+    static I ior( I a, I b )             { return _mm256_or_si256( a, b ); }
+    static I shl23( I a )                { return _mm256_slli_epi32( a, 23 ); }
+    static I shr23( I a )                { return _mm256_srli_epi32( a, 23 ); }
+    static I sra1( I a )                 { return _mm256_srai_epi32( a, 1 ); }
+    static F to_float( I a )             { return _mm256_cvtepi32_ps( a ); }
+    static I to_int( F a )               { return _mm256_cvttps_epi32( a ); }
+};
+#endif
+
+#ifdef ACES_HAS_AVX512
+struct AVX512
+{
+    typedef __m512    F;
+    typedef __m512i   I;
+    typedef __mmask16 M;
+    enum { N = 16 };
+
+    static F load( const float* p )      { return _mm512_loadu_ps( p ); }
+    static void store( float* p, F a )   { _mm512_storeu_ps( p, a ); }
+    static F set1( float a )             { return _mm512_set1_ps( a ); }
+    static F gather( const float* p, I i ) { return _mm512_i32gather_ps( i, p, 4 ); }
+
+    static F add( F a, F b )             { return _mm512_add_ps( a, b ); }
+    static F sub( F a, F b )             { return _mm512_sub_ps( a, b ); }
+    static F mul( F a, F b )             { return _mm512_mul_ps( a, b ); }
+    static F div( F a, F b )             { return _mm512_div_ps( a, b ); }
+    static F fmadd( F a, F b, F c )      { return _mm512_fmadd_ps( a, b, c ); }
+    static F min( F a, F b )             { return _mm512_min_ps( a, b ); }
+    static F max( F a, F b )             { return _mm512_max_ps( a, b ); }
+    static F floor( F a )                { return _mm512_roundscale_ps( a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC ); }
+
+    static M lt( F a, F b )              { return _mm512_cmp_ps_mask( a, b, _CMP_LT_OQ ); }
+    static M gt( F a, F b )              { return _mm512_cmp_ps_mask( a, b, _CMP_GT_OQ ); }
+    static M eq( F a, F b )              { return _mm512_cmp_ps_mask( a, b, _CMP_EQ_OQ ); }
+    static F select( M m, F a, F b )     { return _mm512_mask_blend_ps( m, b, a ); }
+    static unsigned bits( M m )          { return (unsigned) m; }
+
+    static I as_int( F a )               { return _mm512_castps_si512( a ); }
+    static F as_float( I i )             { return _mm512_castsi512_ps( i ); }
+    static I iset1( int a )              { return _mm512_set1_epi32( a ); }
+    static I iadd( I a, I b )            { return _mm512_add_epi32( a, b ); }
+    static I isub( I a, I b )            { return _mm512_sub_epi32( a, b ); }
+    static I imul( I a, I b )            { return _mm512_mullo_epi32( a, b ); }
+    static I iand( I a, I b )            { return _mm512_and_si512( a, b ); }
+    static I ior( I a, I b )             { return _mm512_or_si512( a, b ); }
+    static I shl23( I a )                { return _mm512_slli_epi32( a, 23 ); }
+    static I shr23( I a )                { return _mm512_srli_epi32( a, 23 ); }
+    static I sra1( I a )                 { return _mm512_srai_epi32( a, 1 ); }
+    static F to_float( I a )             { return _mm512_cvtepi32_ps( a ); }
+    static I to_int( F a )               { return _mm512_cvttps_epi32( a ); }
+};
+#endif
+
+
+//
+// Math on any of the wrappers
+//
+
+template< class V >
+inline typename V::F clamp01( typename V::F x )
+{
+    // max first, so NaN becomes 0
+    return V::min( V::max( x, V::set1( 0.0f ) ), V::set1( 1.0f ) );
+}
+
+/** 
+ * How closely log2(), exp2() and pow() follow the exact functions; the
+ * cheaper ones evaluate shorter polynomials.  Largest errors of pow()
+ * on 0..1, measured by the pow mode of ACESclipBench, are in the
+ * comments.
+ */
+enum MathQuality
+{
+kMathExact,      ///< pow() in double on each lane, rounded once; 3e-8
+kMathPrecise,    ///< 9e-8, exp2 within 7e-8 relative
+kMathFast,       ///< 4.2e-6, exp2 within 2.7e-6 relative
+kMathFastest     ///< 2.6e-4, exp2 within 7.5e-5 relative
+};
+
+/** 
+ * log2 of x > 0, subnormals included.  Q is a MathQuality; kMathExact
+ * is the same as kMathPrecise here.
+ */
+template< class V, unsigned Q >
+inline typename V::F log2( typename V::F x )
+{
+    typedef typename V::F F;
+    typedef typename V::I I;
+    typedef typename V::M M;
+
+    // Bring subnormals into the normal range
+    M sub = V::lt( x, V::set1( 1.17549435e-38f ) );
+    x = V::select( sub, V::mul( x, V::set1( 16777216.0f ) ), x );
+    F e = V::select( sub, V::set1( -24.0f ), V::set1( 0.0f ) );
+
+    // x = m * 2^e, m in [sqrt(1/2), sqrt(2))
+    I bits = V::as_int( x );
+    e = V::add( e, V::to_float( V::isub( V::shr23( bits ), V::iset1( 127 ) ) ) );
+    F m = V::as_float( V::ior( V::iand( bits, V::iset1( 0x007fffff ) ),
+                               V::iset1( 0x3f800000 ) ) );
+    M big = V::gt( m, V::set1( 1.41421356f ) );
+    m = V::select( big, V::mul( m, V::set1( 0.5f ) ), m );
+    e = V::add( e, V::select( big, V::set1( 1.0f ), V::set1( 0.0f ) ) );
+
+    if ( Q >= kMathFast )
+    {
+        // log2(1 + u) = u * P(u), minimax fits on |u| < 0.415 with no
+        // division
+        F u = V::sub( m, V::set1( 1.0f ) );
+        F p;
+        if ( Q == kMathFast )
+        {
+            p = V::set1( -0.20659174f );
+            p = V::fmadd( p, u, V::set1( 0.32215479f ) );
+            p = V::fmadd( p, u, V::set1( -0.367489994f ) );
+            p = V::fmadd( p, u, V::set1( 0.479348004f ) );
+            p = V::fmadd( p, u, V::set1( -0.721131861f ) );
+            p = V::fmadd( p, u, V::set1( 1.4427135f ) );
+        }
+        else
+        {
+            p = V::set1( -0.329629719f );
+            p = V::fmadd( p, u, V::set1( 0.517509401f ) );
+            p = V::fmadd( p, u, V::set1( -0.72490418f ) );
+            p = V::fmadd( p, u, V::set1( 1.44176066f ) );
+        }
+        return V::fmadd( p, u, e );
+    }
+
+    // log2(m) = 2/ln(2) * atanh(t), t = (m-1)/(m+1), |t| < 0.172
+    F t = V::div( V::sub( m, V::set1( 1.0f ) ), V::add( m, V::set1( 1.0f ) ) );
+    F t2 = V::mul( t, t );
+    F p = V::set1( 0.320598898f );                      // 2/(9 ln2)
+    p = V::fmadd( p, t2, V::set1( 0.412198583f ) );     // 2/(7 ln2)
+    p = V::fmadd( p, t2, V::set1( 0.577078016f ) );     // 2/(5 ln2)
+    p = V::fmadd( p, t2, V::set1( 0.961796694f ) );     // 2/(3 ln2)
+    p = V::fmadd( p, t2, V::set1( 2.88539008f ) );     // 2/ln2
+    return V::fmadd( p, t, e );
+}
+
+/** 
+ * 2^y, overflowing to inf and underflowing gradually to 0.  Q is a
+ * MathQuality; kMathExact is the same as kMathPrecise here.
+ */
+template< class V, unsigned Q >
+inline typename V::F exp2( typename V::F y )
+{
+    typedef typename V::F F;
+    typedef typename V::I I;
+
+    // Far enough out that the result is 0 or inf either way
+    y = V::min( V::max( y, V::set1( -160.0f ) ), V::set1( 129.0f ) );
+
+    // y = n + f, f in [-0.5, 0.5]
+    F n = V::floor( V::add( y, V::set1( 0.5f ) ) );
+    F f = V::sub( y, n );
+
+    F p;
+    if ( Q == kMathFastest )
+    {
+        // Minimax fit of the relative error
+        p = V::set1( 0.0551716685f );
+        p = V::fmadd( p, f, V::set1( 0.242611125f ) );
+        p = V::fmadd( p, f, V::set1( 0.693260968f ) );
+        p = V::fmadd( p, f, V::set1( 0.999928057f ) );
+    }
+    else if ( Q == kMathFast )
+    {
+        p = V::set1( 0.00957010128f );
+        p = V::fmadd( p, f, V::set1( 0.0559178591f ) );
+        p = V::fmadd( p, f, V::set1( 0.240247443f ) );
+        p = V::fmadd( p, f, V::set1( 0.693121791f ) );
+        p = V::fmadd( p, f, V::set1( 0.999999285f ) );
+    }
+    else
+    {
+        // 2^f = e^(f ln2), Taylor to the 7th power
+        p = V::set1( 1.52527338e-5f );
+        p = V::fmadd( p, f, V::set1( 1.54035304e-4f ) );
+        p = V::fmadd( p, f, V::set1( 1.33335581e-3f ) );
+        p = V::fmadd( p, f, V::set1( 9.61812911e-3f ) );
+        p = V::fmadd( p, f, V::set1( 5.55041087e-2f ) );
+        p = V::fmadd( p, f, V::set1( 2.40226507e-1f ) );
+        p = V::fmadd( p, f, V::set1( 6.93147181e-1f ) );
+        p = V::fmadd( p, f, V::set1( 1.0f ) );
+    }
+
+    // 2^n in two halves, so both stay normal numbers
+    I i = V::to_int( n );
+    I h = V::sra1( i );
+    F a = V::as_float( V::shl23( V::iadd( h, V::iset1( 127 ) ) ) );
+    F b = V::as_float( V::shl23( V::iadd( V::isub( i, h ), 
+                                          V::iset1( 127 ) ) ) );
+    return V::mul( V::mul( p, a ), b );
+}
+
+/** 
+ * x^p for x >= 0, with 0^0 = 1.  Q is a MathQuality.
+ */
+template< class V, unsigned Q >
+inline typename V::F pow( typename V::F x, typename V::F p )
+{
+    typedef typename V::F F;
+
+    F zero = V::set1( 0.0f );
+    F r;
+    if ( Q == kMathExact )
+    {
+        // One lane at a time, through memory
+        float xs[V::N], ps[V::N];
+        V::store( xs, x );
+        V::store( ps, p );
+        for ( unsigned k = 0; k < (unsigned) V::N; ++k )
+            xs[k] = (float) ::pow( (double) xs[k], (double) ps[k] );
+        r = V::load( xs );
+    }
+    else
+    {
+        r = exp2< V, Q >( V::mul( p, log2< V, Q >( x ) ) );
+    }
+    F at_zero = V::select( V::eq( p, zero ), V::set1( 1.0f ), zero );
+    return V::select( V::gt( x, zero ), r, at_zero );
+}
+
+}  // namespace
+}  // namespace ACES
+
+#endif  // ACESSimd_h
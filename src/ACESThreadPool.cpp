@@ -0,0 +1,256 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <chrono>
+
+#include "ACESThreadPool.h"
+
+
+namespace ACES {
+
+// Pool and index of the worker running on this thread, if any.
+static thread_local const ThreadPool* t_pool = NULL;
+static thread_local unsigned t_index = 0;
+
+
+ThreadPool::ThreadPool( unsigned threads ) :
+_queued( 0 ),
+_next( 0 ),
+_stop( false )
+{
+    if ( threads == 0 ) threads = std::thread::hardware_concurrency();
+    if ( threads == 0 ) threads = 1;
+
+    for ( unsigned i = 0; i < threads; ++i )
+        _workers.push_back( std::unique_ptr< Worker >( new Worker ) );
+
+    for ( unsigned i = 0; i < threads; ++i )
+        _threads.push_back( std::thread( &ThreadPool::run, this, i ) );
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard< std::mutex > lock( _sleep_mutex );
+        _stop = true;
+    }
+    _wake.notify_all();
+
+    for ( size_t i = 0; i < _threads.size(); ++i )
+        _threads[i].join();
+}
+
+unsigned ThreadPool::current_index() const
+{
+    if ( t_pool == this ) return t_index;
+    return size();
+}
+
+void ThreadPool::submit( const Task& t )
+{
+    unsigned n = size();
+    unsigned i = current_index();
+    if ( i == n ) i = _next.fetch_add( 1, std::memory_order_relaxed ) % n;
+
+    {
+        Worker& w = *_workers[i];
+        std::lock_guard< std::mutex > lock( w.mutex );
+        w.tasks.push_back( t );
+    }
+    _queued.fetch_add( 1 );
+
+    // Taking the lock orders this with a worker about to go to sleep
+    { std::lock_guard< std::mutex > lock( _sleep_mutex ); }
+    _wake.notify_one();
+}
+
+/** 
+ * Find a task to run, from our own queue first (newest task) and then
+ * from the other workers (oldest task).
+ * 
+ * @param self index of the calling thread
+ * @param t    task found
+ * 
+ * @return true if a task was found
+ */
+bool ThreadPool::find( unsigned self, Task& t )
+{
+    unsigned n = size();
+    if ( _queued.load() == 0 ) return false;
+
+    if ( self < n )
+    {
+        Worker& w = *_workers[self];
+        std::lock_guard< std::mutex > lock( w.mutex );
+        if ( !w.tasks.empty() )
+        {
+            t.swap( w.tasks.back() );
+            w.tasks.pop_back();
+            _queued.fetch_sub( 1 );
+            return true;
+        }
+    }
+
+    unsigned start = ( self < n ) ? self + 1 : 
+                     _next.load( std::memory_order_relaxed );
+    for ( unsigned k = 0; k < n; ++k )
+    {
+        Worker& w = *_workers[ ( start + k ) % n ];
+        std::lock_guard< std::mutex > lock( w.mutex );
+        if ( !w.tasks.empty() )
+        {
+            t.swap( w.tasks.front() );
+            w.tasks.pop_front();
+            _queued.fetch_sub( 1 );
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::run_one()
+{
+    Task t;
+    if ( !find( current_index(), t ) ) return false;
+    t();
+    return true;
+}
+
+void ThreadPool::run( unsigned self )
+{
+    t_pool  = this;
+    t_index = self;
+
+    for (;;)
+    {
+        Task t;
+        if ( find( self, t ) )
+        {
+            t();
+            continue;
+        }
+
+        std::unique_lock< std::mutex > lock( _sleep_mutex );
+        while ( !_stop && _queued.load() == 0 )
+            _wake.wait( lock );
+        if ( _stop && _queued.load() == 0 ) return;
+    }
+}
+
+void ThreadPool::parallel_for( size_t begin, size_t end, size_t grain,
+                               const std::function< void( size_t, size_t ) >& fn )
+{
+    if ( begin >= end ) return;
+    if ( grain == 0 ) grain = 1;
+
+    // A single range does not need the pool
+    if ( end - begin <= grain )
+    {
+        fn( begin, end );
+        return;
+    }
+
+    TaskGroup group( *this );
+    for ( size_t i = begin; i < end; i += grain )
+    {
+        size_t last = ( end - i > grain ) ? i + grain : end;
+        group.run( [&fn, i, last]() { fn( i, last ); } );
+    }
+    group.wait();
+}
+
+ThreadPool& ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+
+TaskGroup::TaskGroup( ThreadPool& pool ) :
+_pool( pool ),
+_pending( 0 )
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    try
+    {
+        wait();
+    }
+    catch( ... )
+    {
+    }
+}
+
+void TaskGroup::run( const ThreadPool::Task& t )
+{
+    _pending.fetch_add( 1 );
+    _pool.submit( [this, t]()
+    {
+        try
+        {
+            t();
+        }
+        catch( ... )
+        {
+            std::lock_guard< std::mutex > lock( _mutex );
+            if ( !_error ) _error = std::current_exception();
+        }
+
+        // Under the lock, so wait() cannot return and destroy the group
+        // while we still use it.
+        std::lock_guard< std::mutex > lock( _mutex );
+        if ( _pending.fetch_sub( 1 ) == 1 ) _done.notify_all();
+    } );
+}
+
+void TaskGroup::wait()
+{
+    while ( _pending.load() != 0 )
+    {
+        if ( _pool.run_one() ) continue;
+
+        // Nothing left to steal, our tasks are running elsewhere.
+        std::unique_lock< std::mutex > lock( _mutex );
+        _done.wait_for( lock, std::chrono::milliseconds( 1 ),
+                        [this]() { return _pending.load() == 0; } );
+    }
+
+    std::exception_ptr e;
+    {
+        std::lock_guard< std::mutex > lock( _mutex );
+        e = _error;
+        _error = std::exception_ptr();
+    }
+    if ( e ) std::rethrow_exception( e );
+}
+
+}  // namespace ACES
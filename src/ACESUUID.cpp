@@ -0,0 +1,198 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "ACESUUID.h"
+
+
+namespace ACES {
+
+static std::atomic< UUIDSource* > g_source( NULL );
+
+// Bumped when the source changes and in the child after a fork, so
+// blocks handed out before are dropped and generators are reseeded.
+static std::atomic< unsigned > g_generation( 0 );
+
+#ifndef _WIN32
+static void after_fork()
+{
+    ++g_generation;
+}
+
+static int g_atfork = pthread_atfork( NULL, NULL, after_fork );
+#endif
+
+
+void UUIDValue::format( char* out ) const
+{
+    static const char kHex[] = "0123456789abcdef";
+    for ( unsigned i = 0; i < 16; ++i )
+    {
+        if ( i == 4 || i == 6 || i == 8 || i == 10 ) *out++ = '-';
+        *out++ = kHex[ bytes[i] >> 4 ];
+        *out++ = kHex[ bytes[i] & 0xf ];
+    }
+    *out = 0;
+}
+
+std::string UUIDValue::str() const
+{
+    char buf[37];
+    format( buf );
+    return buf;
+}
+
+
+UUIDSource::~UUIDSource()
+{
+}
+
+UUIDSource& UUIDSource::current()
+{
+    UUIDSource* s = g_source.load( std::memory_order_acquire );
+    if ( s ) return *s;
+    return RandomUUIDSource::instance();
+}
+
+void UUIDSource::set_current( UUIDSource* s )
+{
+    g_source.store( s, std::memory_order_release );
+    ++g_generation;
+}
+
+
+struct ThreadEngine
+{
+    std::mt19937_64 engine;
+    unsigned        generation;
+    bool            seeded;
+
+    ThreadEngine() : engine(), generation( 0 ), seeded( false ) {}
+
+    void seed()
+    {
+        // random_device may be weak on some platforms, so the time and
+        // this thread's address go in too to keep threads apart.
+        std::random_device rd;
+        unsigned long long now = (unsigned long long)
+            std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        unsigned long long self = (unsigned long long) (size_t) this;
+        std::seed_seq seq{ rd(), rd(), rd(), rd(), rd(), rd(), rd(), rd(),
+                (unsigned) now, (unsigned) ( now >> 32 ),
+                (unsigned) self, (unsigned) ( self >> 32 ) };
+        engine.seed( seq );
+        seeded = true;
+    }
+};
+
+static thread_local ThreadEngine t_engine;
+
+void RandomUUIDSource::generate( UUIDValue* out, size_t count )
+{
+    ThreadEngine& t = t_engine;
+    unsigned generation = g_generation.load( std::memory_order_relaxed );
+    if ( !t.seeded || t.generation != generation )
+    {
+        t.seed();
+        t.generation = generation;
+    }
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        unsigned long long r[2] = { t.engine(), t.engine() };
+        unsigned char* b = out[i].bytes;
+        memcpy( b, r, 16 );
+        b[6] = (unsigned char)( ( b[6] & 0x0f ) | 0x40 );  // version 4
+        b[8] = (unsigned char)( ( b[8] & 0x3f ) | 0x80 );  // RFC 4122 variant
+    }
+}
+
+RandomUUIDSource& RandomUUIDSource::instance()
+{
+    static RandomUUIDSource s;
+    return s;
+}
+
+
+UUIDBlock::UUIDBlock( UUIDSource& source ) :
+_source( source ),
+_generation( 0 ),
+_next( kSize )
+{
+}
+
+const UUIDValue& UUIDBlock::next()
+{
+    unsigned generation = g_generation.load( std::memory_order_relaxed );
+    if ( _next == kSize || _generation != generation )
+    {
+        _source.generate( _block, kSize );
+        _generation = generation;
+        _next = 0;
+    }
+    return _block[ _next++ ];
+}
+
+
+struct ThreadBlock
+{
+    UUIDSource* source;
+    unsigned    generation;
+    size_t      next;
+    UUIDValue   block[ UUIDBlock::kSize ];
+};
+
+static thread_local ThreadBlock t_block = { NULL, 0, UUIDBlock::kSize, {} };
+
+void new_uuid( char* out )
+{
+    ThreadBlock& t = t_block;
+    UUIDSource& source = UUIDSource::current();
+    unsigned generation = g_generation.load( std::memory_order_relaxed );
+    if ( t.next == UUIDBlock::kSize || t.source != &source ||
+         t.generation != generation )
+    {
+        source.generate( t.block, UUIDBlock::kSize );
+        t.source = &source;
+        t.generation = generation;
+        t.next = 0;
+    }
+    t.block[ t.next++ ].format( out );
+}
+
+}  // namespace ACES
@@ -0,0 +1,205 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#endif
+
+#include "ACESclipBatch.h"
+
+
+namespace ACES {
+
+// Files handed to a worker at a time
+static const size_t kGrain = 8;
+
+
+ACESclipBatch::ACESclipBatch( ThreadPool* pool ) :
+_pool( pool ? pool : &ThreadPool::global() ),
+_sections( ACESclipReader::kAllSections )
+{
+    // One reader per worker, plus one for the thread calling load()
+    _readers.reserve( _pool->size() + 1 );
+}
+
+ACESclipBatch::~ACESclipBatch()
+{
+}
+
+void ACESclipBatch::load( const std::vector< std::string >& files,
+                          Results& results )
+{
+    results.resize( files.size() );
+
+    _pool->parallel_for( 0, files.size(), kGrain,
+                         [&]( size_t first, size_t last )
+    {
+        ObjectPool< ACESclipReader >::Handle reader = _readers.acquire();
+        ACESclipReader& r = *reader;
+        for ( size_t i = first; i < last; ++i )
+        {
+            Result& res = results[i];
+            res.filename = files[i];
+
+            if ( _sections == ACESclipReader::kAllSections )
+                res.error = r.load_mapped( files[i].c_str() );
+            else
+                res.error = r.probe( files[i].c_str(), _sections );
+            res.metadata = r;
+        }
+    } );
+}
+
+bool ACESclipBatch::load_directory( const std::string& root, 
+                                    Results& results )
+{
+    std::vector< std::string > files;
+    if ( !find_files( root, files ) )
+    {
+        results.clear();
+        return false;
+    }
+
+    load( files, results );
+    return true;
+}
+
+static bool has_extension( const char* name, const char* ext )
+{
+    size_t n = strlen( name );
+    size_t e = strlen( ext );
+    if ( n < e ) return false;
+
+    const char* s = name + n - e;
+    for ( size_t i = 0; i < e; ++i )
+    {
+        if ( tolower( (unsigned char) s[i] ) != tolower( (unsigned char) ext[i] ) )
+            return false;
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+static bool walk( const std::string& dir, std::vector< std::string >& files,
+                  const char* ext )
+{
+    WIN32_FIND_DATAA data;
+    std::string pattern = dir + "\\*";
+    HANDLE h = FindFirstFileA( pattern.c_str(), &data );
+    if ( h == INVALID_HANDLE_VALUE ) return false;
+
+    do
+    {
+        const char* name = data.cFileName;
+        if ( strcmp( name, "." ) == 0 || strcmp( name, ".." ) == 0 )
+            continue;
+
+        std::string path = dir + "/" + name;
+        if ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY )
+        {
+            // Junctions are not followed, to stay clear of loops.
+            if ( !( data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT ) )
+                walk( path, files, ext );
+        }
+        else if ( has_extension( name, ext ) )
+            files.push_back( path );
+    } while ( FindNextFileA( h, &data ) );
+
+    FindClose( h );
+    return true;
+}
+
+#else
+
+static bool walk( const std::string& dir, std::vector< std::string >& files,
+                  const char* ext )
+{
+    DIR* d = opendir( dir.c_str() );
+    if ( !d ) return false;
+
+    struct dirent* e;
+    while ( ( e = readdir( d ) ) != NULL )
+    {
+        const char* name = e->d_name;
+        if ( strcmp( name, "." ) == 0 || strcmp( name, ".." ) == 0 )
+            continue;
+
+        std::string path = dir + "/" + name;
+
+        // Symbolic links to directories are not followed, to stay clear
+        // of loops.
+        bool is_dir = false;
+#ifdef DT_DIR
+        if ( e->d_type == DT_DIR )
+            is_dir = true;
+        else if ( e->d_type == DT_UNKNOWN )
+#endif
+        {
+            struct stat st;
+            is_dir = lstat( path.c_str(), &st ) == 0 && S_ISDIR( st.st_mode );
+        }
+
+        if ( is_dir )
+            walk( path, files, ext );
+        else if ( has_extension( name, ext ) )
+            files.push_back( path );
+    }
+
+    closedir( d );
+    return true;
+}
+
+#endif
+
+bool ACESclipBatch::find_files( const std::string& root,
+                                std::vector< std::string >& files,
+                                const char* ext )
+{
+    std::string dir = root;
+    while ( dir.size() > 1 && ( dir[dir.size()-1] == '/' || 
+                                dir[dir.size()-1] == '\\' ) )
+        dir.resize( dir.size() - 1 );
+
+    size_t first = files.size();
+    if ( !walk( dir, files, ext ) ) return false;
+
+    std::sort( files.begin() + first, files.end() );
+    return true;
+}
+
+}  // namespace ACES
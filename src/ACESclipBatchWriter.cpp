@@ -0,0 +1,178 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <algorithm>
+#include <chrono>
+
+#include "ACESclipBatchWriter.h"
+#include "ACESclipFormat.h"
+
+
+namespace ACES {
+
+void ACESclipBatchWriter::Stats::clear()
+{
+    commits = files = failed = bytes = 0;
+    seconds = last_seconds = max_seconds = 0.0;
+}
+
+ACESclipBatchWriter::ACESclipBatchWriter( Durability durability,
+                                          size_t group_size,
+                                          ThreadPool* pool ) :
+_pool( pool ? pool : &ThreadPool::global() ),
+_durability( durability ),
+_group_size( group_size ? group_size : 1 ),
+_queued( 0 )
+{
+}
+
+ACESclipBatchWriter::~ACESclipBatchWriter()
+{
+    commit();
+}
+
+void ACESclipBatchWriter::add( const char* filename, const char* document,
+                               size_t size )
+{
+    // Entries past _queued keep their strings for the next groups
+    if ( _queued == _pending.size() ) _pending.push_back( Pending() );
+
+    Pending& p = _pending[_queued++];
+    p.filename.assign( filename );
+    p.document.assign( document, size );
+    p.error = 0;
+
+    if ( _queued >= _group_size ) commit();
+}
+
+void ACESclipBatchWriter::add( const std::string& filename,
+                               const std::string& document )
+{
+    add( filename.c_str(), document.data(), document.size() );
+}
+
+/** 
+ * Write a document to its temporary file, sync it if durable and
+ * rename it over the final name.  Sets p.error on failure.
+ */
+void ACESclipBatchWriter::write( Pending& p )
+{
+    p.error = replace_file( p.filename, p.document.data(), 
+                            p.document.size(), _durability == kDurable,
+                            p.temporary );
+}
+
+/** 
+ * Sync once each directory the first count files were renamed into,
+ * failing the files of any directory that could not be synced.
+ */
+void ACESclipBatchWriter::sync_directories( size_t count )
+{
+    typedef std::pair< std::string, int > Directory;
+    std::vector< Directory > dirs;
+    std::vector< size_t > dir_of( count );
+
+    size_t last = 0;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        if ( _pending[i].error ) continue;
+
+        // Files of a group mostly share one directory.  The temporary
+        // name is in the one renamed in, past any symlink.
+        std::string d = directory_of( _pending[i].temporary );
+        if ( last >= dirs.size() || dirs[last].first != d )
+        {
+            last = 0;
+            while ( last < dirs.size() && dirs[last].first != d ) ++last;
+            if ( last == dirs.size() ) dirs.push_back( Directory( d, 0 ) );
+        }
+        dir_of[i] = last;
+    }
+
+    for ( size_t j = 0; j < dirs.size(); ++j )
+        dirs[j].second = sync_directory( dirs[j].first );
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        if ( !_pending[i].error )
+            _pending[i].error = dirs[ dir_of[i] ].second;
+    }
+}
+
+bool ACESclipBatchWriter::commit()
+{
+    if ( _queued == 0 ) return true;
+
+    std::chrono::steady_clock::time_point start = 
+    std::chrono::steady_clock::now();
+
+    const size_t count = _queued;
+    _pool->parallel_for( 0, count, 1, [this]( size_t first, size_t last )
+    {
+        for ( size_t i = first; i < last; ++i )
+            write( _pending[i] );
+    } );
+
+    if ( _durability == kDurable ) sync_directories( count );
+
+    bool all = true;
+    for ( size_t i = 0; i < count; ++i )
+    {
+        const Pending& p = _pending[i];
+
+        Result r;
+        r.filename = p.filename;
+        r.ok = p.error == 0;
+        r.error = p.error;
+        _results.push_back( r );
+
+        if ( r.ok )
+        {
+            ++_stats.files;
+            _stats.bytes += p.document.size();
+        }
+        else
+        {
+            ++_stats.failed;
+            all = false;
+        }
+    }
+    _queued = 0;
+
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - 
+                                      start;
+    ++_stats.commits;
+    _stats.seconds += d.count();
+    _stats.last_seconds = d.count();
+    if ( d.count() > _stats.max_seconds ) _stats.max_seconds = d.count();
+
+    return all;
+}
+
+}  // namespace ACES
@@ -0,0 +1,502 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "ACESclipCache.h"
+#include "ACESMappedFile.h"
+#include "ACESHash.h"
+#include "ACESclipFormat.h"
+
+
+namespace ACES {
+
+namespace {
+
+typedef unsigned long long uint64;
+typedef unsigned int       uint32;
+
+// Bump kFormat whenever the record layout or ACESclipMetadata changes.
+const char   kMagic[8]   = { 'A', 'C', 'E', 'S', 'c', 'l', 'c', 0 };
+const uint32 kFormat     = 1;
+const uint32 kByteOrder  = 0x01020304;
+
+/** 
+ * Modification time, in nanoseconds, and size of a file.
+ */
+struct Stamp
+{
+    Stamp() : mtime( 0 ), size( 0 ) {}
+
+    bool operator==( const Stamp& b ) const
+    {
+        return mtime == b.mtime && size == b.size;
+    }
+
+    uint64 mtime;
+    uint64 size;
+};
+
+bool file_stamp( const char* filename, Stamp& s )
+{
+#ifdef _WIN32
+    struct __stat64 st;
+    if ( _stat64( filename, &st ) != 0 ) return false;
+    s.mtime = uint64( st.st_mtime ) * 1000000000ULL;
+#else
+    struct stat st;
+    if ( stat( filename, &st ) != 0 ) return false;
+    s.mtime = uint64( st.st_mtime ) * 1000000000ULL;
+#  if defined(__APPLE__)
+    s.mtime += st.st_mtimespec.tv_nsec;
+#  elif defined(__linux__)
+    s.mtime += st.st_mtim.tv_nsec;
+#  endif
+#endif
+    s.size = uint64( st.st_size );
+    return true;
+}
+
+/** 
+ * Serializes a record.  Numbers are stored in host order; the byte
+ * order mark in the header rejects records from other machines.
+ */
+class RecordWriter
+{
+  public:
+    RecordWriter( std::string& out ) : _out( out ) {}
+
+    void bytes( const void* p, size_t n ) 
+    { 
+        _out.append( (const char*) p, n );
+    }
+
+    void u32( uint32 x )  { bytes( &x, sizeof(x) ); }
+    void u64( uint64 x )  { bytes( &x, sizeof(x) ); }
+    void f32( float x )   { bytes( &x, sizeof(x) ); }
+
+    void str( const std::string& s )
+    {
+        u32( uint32( s.size() ) );
+        bytes( s.data(), s.size() );
+    }
+
+    void transform( const Transform& t )
+    {
+        str( t.name );
+        str( t.link_transform );
+        u32( t.status );
+    }
+
+  private:
+    std::string& _out;
+};
+
+/** 
+ * Reads a record back, checking every field stays inside it.
+ */
+class RecordReader
+{
+  public:
+    RecordReader( const char* p, const char* end ) : 
+    _p( p ), _end( end ), _ok( true )
+    {
+    }
+
+    bool ok() const { return _ok; }
+    const char* pos() const { return _p; }
+
+    const char* bytes( size_t n )
+    {
+        if ( !_ok || size_t( _end - _p ) < n ) 
+        {
+            _ok = false;
+            return NULL;
+        }
+        const char* r = _p;
+        _p += n;
+        return r;
+    }
+
+    uint32 u32()
+    {
+        uint32 x = 0;
+        const char* p = bytes( sizeof(x) );
+        if ( p ) memcpy( &x, p, sizeof(x) );
+        return x;
+    }
+
+    uint64 u64()
+    {
+        uint64 x = 0;
+        const char* p = bytes( sizeof(x) );
+        if ( p ) memcpy( &x, p, sizeof(x) );
+        return x;
+    }
+
+    float f32()
+    {
+        float x = 0;
+        const char* p = bytes( sizeof(x) );
+        if ( p ) memcpy( &x, p, sizeof(x) );
+        return x;
+    }
+
+    void str( std::string& s )
+    {
+        uint32 n = u32();
+        const char* p = bytes( n );
+        if ( p ) s.assign( p, n );
+        else s.clear();
+    }
+
+    TransformStatus status()
+    {
+        uint32 x = u32();
+        if ( x > kLastStatus ) _ok = false;
+        return _ok ? TransformStatus( x ) : kLastStatus;
+    }
+
+    void transform( Transform& t )
+    {
+        str( t.name );
+        str( t.link_transform );
+        t.status = status();
+    }
+
+  private:
+    const char* _p;
+    const char* _end;
+    bool _ok;
+};
+
+void encode( RecordWriter& w, const ACESclipMetadata& m )
+{
+    w.str( m.application );
+    w.str( m.version );
+    w.str( m.comment );
+
+    w.str( m.clip_name );
+    w.str( m.media_id );
+    w.str( m.clip_date );
+
+    w.str( m.timestamp );
+
+    w.u32( m.graderef_status );
+    w.str( m.convert_to );
+    w.str( m.convert_from );
+    w.u32( m.in_bit_depth );
+    w.u32( m.out_bit_depth );
+    w.u32( uint32( m.grade_refs.size() ) );
+    for ( size_t i = 0; i < m.grade_refs.size(); ++i )
+        w.str( m.grade_refs[i] );
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        w.f32( m.sops.slope(i) );
+        w.f32( m.sops.offset(i) );
+        w.f32( m.sops.power(i) );
+    }
+    w.f32( m.sops.saturation() );
+
+    w.transform( m.IDT );
+    w.u32( uint32( m.LMT.size() ) );
+    for ( size_t i = 0; i < m.LMT.size(); ++i )
+        w.transform( m.LMT[i] );
+    w.transform( m.RRTODT );
+    w.transform( m.RRT );
+    w.transform( m.ODT );
+    w.str( m.link_ITL );
+    w.str( m.link_PTL );
+}
+
+bool decode( RecordReader& r, ACESclipMetadata& m )
+{
+    r.str( m.application );
+    r.str( m.version );
+    r.str( m.comment );
+
+    r.str( m.clip_name );
+    r.str( m.media_id );
+    r.str( m.clip_date );
+
+    r.str( m.timestamp );
+
+    m.graderef_status = r.status();
+    r.str( m.convert_to );
+    r.str( m.convert_from );
+    uint32 in = r.u32();
+    uint32 out = r.u32();
+    if ( in > ACESclipMetadata::kLastBitDepth || 
+         out > ACESclipMetadata::kLastBitDepth ) return false;
+    m.in_bit_depth = ACESclipMetadata::BitDepth( in );
+    m.out_bit_depth = ACESclipMetadata::BitDepth( out );
+
+    // Counts are checked against what is left so a bad record can't
+    // make us allocate a huge list.
+    uint32 n = r.u32();
+    if ( !r.ok() || n > 64 ) return false;
+    m.grade_refs.resize( n );
+    for ( uint32 i = 0; i < n; ++i )
+        r.str( m.grade_refs[i] );
+
+    float slope[3], offset[3], power[3];
+    for ( unsigned short i = 0; i < 3; ++i )
+    {
+        slope[i] = r.f32();
+        offset[i] = r.f32();
+        power[i] = r.f32();
+    }
+    m.sops.slope( slope[0], slope[1], slope[2] );
+    m.sops.offset( offset[0], offset[1], offset[2] );
+    m.sops.power( power[0], power[1], power[2] );
+    m.sops.saturation( r.f32() );
+
+    r.transform( m.IDT );
+    n = r.u32();
+    if ( !r.ok() || n > 4096 ) return false;
+    m.LMT.resize( n );
+    for ( uint32 i = 0; i < n; ++i )
+        r.transform( m.LMT[i] );
+    r.transform( m.RRTODT );
+    r.transform( m.RRT );
+    r.transform( m.ODT );
+    r.str( m.link_ITL );
+    r.str( m.link_PTL );
+
+    return r.ok();
+}
+
+/** 
+ * Write the record of a file.
+ * 
+ * @param path        record file
+ * @param validation  ACESclipCache::Validation
+ * @param filename    ACESclip file
+ * @param stamp       its time and size, taken before it was read
+ * @param hash        hash of its contents, for kContentHash
+ * @param m           metadata read from it
+ * @param error       error read from it
+ */
+bool write_record( const std::string& path, uint32 validation,
+                   const char* filename, const Stamp& stamp, uint64 hash,
+                   const ACESclipMetadata& m, uint32 error )
+{
+    std::string record;
+    record.reserve( 1024 );
+
+    RecordWriter w( record );
+    w.bytes( kMagic, sizeof(kMagic) );
+    w.u32( kFormat );
+    w.u32( kByteOrder );
+    w.u32( validation );
+    size_t n = strlen( filename );
+    w.u32( uint32( n ) );
+    w.bytes( filename, n );
+    w.u64( stamp.mtime );
+    w.u64( stamp.size );
+    w.u64( hash );
+    w.u32( error );
+    encode( w, m );
+    w.u64( fnv1a( record.data(), record.size() ) );
+
+    return replace_file( path, record.data(), record.size() );
+}
+
+}  // namespace
+
+
+ACESclipCache::ACESclipCache( const std::string& directory,
+                              Validation validation ) :
+_directory( directory ),
+_validation( validation ),
+_hits( 0 ),
+_misses( 0 )
+{
+    while ( _directory.size() > 1 && 
+            ( _directory[_directory.size()-1] == '/' ||
+              _directory[_directory.size()-1] == '\\' ) )
+        _directory.resize( _directory.size() - 1 );
+
+#ifdef _WIN32
+    _mkdir( _directory.c_str() );
+#else
+    mkdir( _directory.c_str(), 0777 );
+#endif
+}
+
+ACESclipCache::~ACESclipCache()
+{
+}
+
+std::string ACESclipCache::record_path( const char* filename ) const
+{
+    char name[32];
+    snprintf( name, sizeof(name), "/%016llx.acc", 
+              fnv1a( filename, strlen(filename) ) );
+    return _directory + name;
+}
+
+bool ACESclipCache::find( const char* filename, ACESclipMetadata& metadata,
+                          ACESclipReader::ACESError& error )
+{
+    MappedFile record;
+    if ( !record.open( record_path( filename ).c_str() ) || 
+         record.size() < sizeof(kMagic) + sizeof(uint64) )
+    {
+        ++_misses;
+        return false;
+    }
+
+    // Checksum, at the end, covers the rest of the record
+    const char* begin = record.data();
+    const char* end = begin + record.size() - sizeof(uint64);
+    uint64 checksum;
+    memcpy( &checksum, end, sizeof(checksum) );
+
+    RecordReader r( begin, end );
+    const char* magic = r.bytes( sizeof(kMagic) );
+    if ( memcmp( magic, kMagic, sizeof(kMagic) ) != 0 ||
+         r.u32() != kFormat || r.u32() != kByteOrder ||
+         r.u32() != uint32( _validation ) ||
+         fnv1a( begin, end - begin ) != checksum )
+    {
+        ++_misses;
+        return false;
+    }
+
+    // Different paths can hash to the same record name
+    uint32 n = r.u32();
+    const char* path = r.bytes( n );
+    if ( !path || n != strlen( filename ) || memcmp( path, filename, n ) )
+    {
+        ++_misses;
+        return false;
+    }
+
+    Stamp stamp;
+    stamp.mtime = r.u64();
+    stamp.size = r.u64();
+    uint64 hash = r.u64();
+    uint32 err = r.u32();
+
+    bool valid = r.ok() && err <= ACESclipReader::kLastError;
+    if ( valid && _validation == kPathTimeSize )
+    {
+        Stamp now;
+        valid = file_stamp( filename, now ) && now == stamp;
+    }
+    else if ( valid )
+    {
+        MappedFile f;
+        valid = f.open( filename ) && f.size() == stamp.size &&
+                fnv1a( f.data(), f.size() ) == hash;
+    }
+
+    if ( !valid || !decode( r, metadata ) )
+    {
+        ++_misses;
+        return false;
+    }
+
+    error = ACESclipReader::ACESError( err );
+    ++_hits;
+    return true;
+}
+
+bool ACESclipCache::store( const char* filename, 
+                           const ACESclipMetadata& metadata,
+                           ACESclipReader::ACESError error )
+{
+    Stamp stamp;
+    if ( !file_stamp( filename, stamp ) ) return false;
+
+    uint64 hash = 0;
+    if ( _validation == kContentHash )
+    {
+        MappedFile f;
+        if ( !f.open( filename ) ) return false;
+        stamp.size = f.size();
+        hash = fnv1a( f.data(), f.size() );
+    }
+
+    return write_record( record_path( filename ), _validation, filename,
+                         stamp, hash, metadata, error );
+}
+
+bool ACESclipCache::remove( const char* filename )
+{
+    return ::remove( record_path( filename ).c_str() ) == 0;
+}
+
+ACESclipReader::ACESError ACESclipCache::load( const char* filename,
+                                               ACESclipMetadata& metadata )
+{
+    ACESclipReader::ACESError error;
+    if ( find( filename, metadata, error ) ) return error;
+
+    // Take the stamp before reading, so a file changed while we read it
+    // is read again next time.
+    Stamp stamp;
+    if ( !file_stamp( filename, stamp ) ) 
+    {
+        metadata.reset();
+        return ACESclipReader::kFileError;
+    }
+
+    MappedFile f;
+    if ( !f.open( filename ) ) 
+    {
+        metadata.reset();
+        return ACESclipReader::kFileError;
+    }
+
+    ObjectPool< ACESclipReader >::Handle reader = _readers.acquire();
+    error = reader->probe( f.data(), f.size(), 
+                           ACESclipReader::kAllSections );
+    metadata = *reader;
+
+    stamp.size = f.size();
+    uint64 hash = 0;
+    if ( _validation == kContentHash ) hash = fnv1a( f.data(), f.size() );
+
+    write_record( record_path( filename ), _validation, filename, stamp,
+                  hash, metadata, error );
+    return error;
+}
+
+}  // namespace ACES
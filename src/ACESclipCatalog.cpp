@@ -0,0 +1,421 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+
+#include "ACESclipCatalog.h"
+#include "ACESHash.h"
+
+
+namespace ACES {
+
+
+//
+// Strings
+//
+
+ACESclipCatalog::Strings::Strings()
+{
+    clear();
+}
+
+void ACESclipCatalog::Strings::clear()
+{
+    _chars.assign( 1, '\0' );
+    _offsets.assign( 1, 0 );
+    _table.assign( 16, 0 );
+}
+
+size_t ACESclipCatalog::Strings::memory() const
+{
+    return _chars.capacity() + 
+           ( _offsets.capacity() + _table.capacity() ) * sizeof(unsigned);
+}
+
+void ACESclipCatalog::Strings::grow()
+{
+    std::vector< unsigned > table( _table.size() * 2, 0 );
+    size_t mask = table.size() - 1;
+    for ( unsigned id = 1; id < _offsets.size(); ++id )
+    {
+        const char* s = str( id );
+        size_t i = size_t( fnv1a( s, strlen(s) ) ) & mask;
+        while ( table[i] ) i = ( i + 1 ) & mask;
+        table[i] = id + 1;
+    }
+    _table.swap( table );
+}
+
+bool ACESclipCatalog::Strings::find( const char* s, size_t len,
+                                     unsigned& id ) const
+{
+    if ( len == 0 )
+    {
+        id = 0;
+        return true;
+    }
+
+    size_t mask = _table.size() - 1;
+    size_t i = size_t( fnv1a( s, len ) ) & mask;
+    for ( ; _table[i]; i = ( i + 1 ) & mask )
+    {
+        // The length first, so memcmp stays inside the stored string
+        unsigned candidate = _table[i] - 1;
+        if ( length( candidate ) == len && 
+             memcmp( str( candidate ), s, len ) == 0 )
+        {
+            id = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned ACESclipCatalog::Strings::intern( const std::string& s )
+{
+    unsigned id;
+    if ( find( s.c_str(), s.size(), id ) ) return id;
+
+    // Keep the table at most half full
+    if ( ( _offsets.size() + 1 ) * 2 > _table.size() ) grow();
+
+    id = unsigned( _offsets.size() );
+    _offsets.push_back( unsigned( _chars.size() ) );
+    _chars.insert( _chars.end(), s.begin(), s.end() );
+    _chars.push_back( '\0' );
+
+    size_t mask = _table.size() - 1;
+    size_t i = size_t( fnv1a( s.c_str(), s.size() ) ) & mask;
+    while ( _table[i] ) i = ( i + 1 ) & mask;
+    _table[i] = id + 1;
+    return id;
+}
+
+
+//
+// Index
+//
+
+ACESclipCatalog::Range ACESclipCatalog::Index::find( unsigned value ) const
+{
+    if ( value + 1 >= offsets.size() ) return Range();
+    const ClipId* p = clips.empty() ? NULL : &clips[0];
+    return Range( p + offsets[value], p + offsets[value+1] );
+}
+
+size_t ACESclipCatalog::Index::memory() const
+{
+    return ( offsets.capacity() + clips.capacity() ) * sizeof(unsigned);
+}
+
+void ACESclipCatalog::Index::clear()
+{
+    offsets.clear();
+    clips.clear();
+}
+
+
+//
+// ACESclipCatalog
+//
+
+ACESclipCatalog::ACESclipCatalog() :
+_indexed( false )
+{
+    _LMT_offsets.push_back( 0 );
+}
+
+ACESclipCatalog::~ACESclipCatalog()
+{
+}
+
+void ACESclipCatalog::reserve( size_t clips )
+{
+    _filename.reserve( clips );
+    _clip_name.reserve( clips );
+    _clip_date.reserve( clips );
+    _media_id.reserve( clips );
+    _IDT.reserve( clips );
+    _RRT.reserve( clips );
+    _RRTODT.reserve( clips );
+    _ODT.reserve( clips );
+    _error.reserve( clips );
+    _LMT_offsets.reserve( clips + 1 );
+}
+
+void ACESclipCatalog::clear()
+{
+    _paths.clear();
+    _media.clear();
+    _transforms.clear();
+
+    _filename.clear();
+    _clip_name.clear();
+    _clip_date.clear();
+    _media_id.clear();
+    _IDT.clear();
+    _RRT.clear();
+    _RRTODT.clear();
+    _ODT.clear();
+    _error.clear();
+    _LMT_offsets.assign( 1, 0 );
+    _LMT.clear();
+
+    _indexed = false;
+}
+
+ACESclipCatalog::ClipId ACESclipCatalog::add( const std::string& filename,
+                                              const ACESclipMetadata& m,
+                                              ACESclipReader::ACESError err )
+{
+    ClipId id = ClipId( _filename.size() );
+
+    _filename.push_back( _paths.intern( filename ) );
+    _clip_name.push_back( _paths.intern( m.clip_name ) );
+    _clip_date.push_back( _paths.intern( m.clip_date ) );
+    _media_id.push_back( _media.intern( m.media_id ) );
+    _IDT.push_back( _transforms.intern( m.IDT.name ) );
+    _RRT.push_back( _transforms.intern( m.RRT.name ) );
+    _RRTODT.push_back( _transforms.intern( m.RRTODT.name ) );
+    _ODT.push_back( _transforms.intern( m.ODT.name ) );
+    _error.push_back( (unsigned char) err );
+
+    for ( size_t i = 0; i < m.LMT.size(); ++i )
+        _LMT.push_back( _transforms.intern( m.LMT[i].name ) );
+    _LMT_offsets.push_back( unsigned( _LMT.size() ) );
+
+    _indexed = false;
+    return id;
+}
+
+void ACESclipCatalog::add( const ACESclipBatch::Results& results )
+{
+    reserve( size() + results.size() );
+    for ( size_t i = 0; i < results.size(); ++i )
+    {
+        const ACESclipBatch::Result& r = results[i];
+        add( r.filename, r.metadata, r.error );
+    }
+}
+
+/** 
+ * Counting sort of the clips by the value of a column.  Clips come out
+ * sorted by id within each value.
+ */
+void ACESclipCatalog::build_index( Index& idx, const Strings& dict,
+                                   const std::vector< unsigned >& column ) 
+    const
+{
+    idx.offsets.assign( dict.size() + 1, 0 );
+    for ( size_t i = 0; i < column.size(); ++i )
+        ++idx.offsets[ column[i] + 1 ];
+    for ( size_t v = 1; v < idx.offsets.size(); ++v )
+        idx.offsets[v] += idx.offsets[v-1];
+
+    idx.clips.resize( column.size() );
+    std::vector< unsigned > next( idx.offsets.begin(), 
+                                  idx.offsets.end() - 1 );
+    for ( size_t i = 0; i < column.size(); ++i )
+        idx.clips[ next[ column[i] ]++ ] = ClipId( i );
+}
+
+void ACESclipCatalog::build_indexes()
+{
+    build_index( _by_IDT, _transforms, _IDT );
+    build_index( _by_ODT, _transforms, _ODT );
+    build_index( _by_RRT, _transforms, _RRT );
+    build_index( _by_RRTODT, _transforms, _RRTODT );
+    build_index( _by_media_id, _media, _media_id );
+
+    // Inverted LMT index.  A clip using the same LMT twice is only
+    // listed once.
+    size_t n = size();
+    Index& lmt = _by_LMT;
+    lmt.offsets.assign( _transforms.size() + 1, 0 );
+    std::vector< unsigned > last( _transforms.size(), ~0u );
+    for ( size_t c = 0; c < n; ++c )
+    {
+        for ( unsigned j = _LMT_offsets[c]; j < _LMT_offsets[c+1]; ++j )
+        {
+            unsigned v = _LMT[j];
+            if ( last[v] == c ) continue;
+            last[v] = unsigned( c );
+            ++lmt.offsets[v+1];
+        }
+    }
+    for ( size_t v = 1; v < lmt.offsets.size(); ++v )
+        lmt.offsets[v] += lmt.offsets[v-1];
+
+    lmt.clips.resize( lmt.offsets.back() );
+    std::vector< unsigned > next( lmt.offsets.begin(), 
+                                  lmt.offsets.end() - 1 );
+    last.assign( _transforms.size(), ~0u );
+    for ( size_t c = 0; c < n; ++c )
+    {
+        for ( unsigned j = _LMT_offsets[c]; j < _LMT_offsets[c+1]; ++j )
+        {
+            unsigned v = _LMT[j];
+            if ( last[v] == c ) continue;
+            last[v] = unsigned( c );
+            lmt.clips[ next[v]++ ] = ClipId( c );
+        }
+    }
+
+    // Media ids sorted by string, for prefix lookups.  The empty id 0
+    // is left out.
+    _media_sorted.resize( _media.size() - 1 );
+    for ( unsigned i = 1; i < _media.size(); ++i )
+        _media_sorted[i-1] = i;
+    const Strings& media = _media;
+    std::sort( _media_sorted.begin(), _media_sorted.end(),
+               [&media]( unsigned a, unsigned b )
+               {
+                   return strcmp( media.str( a ), media.str( b ) ) < 0;
+               } );
+}
+
+void ACESclipCatalog::index() const
+{
+    if ( _indexed.load( std::memory_order_acquire ) ) return;
+
+    std::lock_guard< std::mutex > lock( _index_mutex );
+    if ( _indexed.load( std::memory_order_relaxed ) ) return;
+
+    const_cast< ACESclipCatalog* >( this )->build_indexes();
+    _indexed.store( true, std::memory_order_release );
+}
+
+ACESclipCatalog::Range ACESclipCatalog::find( const Strings& dict, 
+                                              const Index& idx,
+                                              const std::string& name ) const
+{
+    index();
+
+    unsigned id;
+    if ( !dict.find( name.c_str(), name.size(), id ) ) return Range();
+    return idx.find( id );
+}
+
+ACESclipCatalog::Range 
+ACESclipCatalog::with_IDT( const std::string& name ) const
+{
+    return find( _transforms, _by_IDT, name );
+}
+
+ACESclipCatalog::Range 
+ACESclipCatalog::with_ODT( const std::string& name ) const
+{
+    return find( _transforms, _by_ODT, name );
+}
+
+ACESclipCatalog::Range 
+ACESclipCatalog::with_RRT( const std::string& name ) const
+{
+    return find( _transforms, _by_RRT, name );
+}
+
+ACESclipCatalog::Range 
+ACESclipCatalog::with_RRTODT( const std::string& name ) const
+{
+    return find( _transforms, _by_RRTODT, name );
+}
+
+ACESclipCatalog::Range 
+ACESclipCatalog::with_media_id( const std::string& media_id ) const
+{
+    return find( _media, _by_media_id, media_id );
+}
+
+ACESclipCatalog::Range 
+ACESclipCatalog::with_LMT( const std::string& name ) const
+{
+    return find( _transforms, _by_LMT, name );
+}
+
+void ACESclipCatalog::with_media_id_prefix( const std::string& prefix,
+                                            Clips& clips ) const
+{
+    index();
+
+    clips.clear();
+    if ( prefix.empty() )
+    {
+        clips.resize( size() );
+        for ( size_t i = 0; i < clips.size(); ++i ) clips[i] = ClipId( i );
+        return;
+    }
+
+    const Strings& media = _media;
+    const char* p = prefix.c_str();
+    size_t len = prefix.size();
+    std::vector< unsigned >::const_iterator i = 
+        std::lower_bound( _media_sorted.begin(), _media_sorted.end(), p,
+                          [&media]( unsigned a, const char* b )
+                          {
+                              return strcmp( media.str( a ), b ) < 0;
+                          } );
+
+    size_t groups = 0;
+    for ( ; i != _media_sorted.end(); ++i )
+    {
+        if ( strncmp( media.str( *i ), p, len ) != 0 ) break;
+        Range r = _by_media_id.find( *i );
+        clips.insert( clips.end(), r.begin(), r.end() );
+        ++groups;
+    }
+    if ( groups > 1 ) std::sort( clips.begin(), clips.end() );
+}
+
+void ACESclipCatalog::intersect( const Range& a, const Range& b, 
+                                 Clips& out )
+{
+    out.clear();
+    std::set_intersection( a.begin(), a.end(), b.begin(), b.end(),
+                           std::back_inserter( out ) );
+}
+
+size_t ACESclipCatalog::memory() const
+{
+    size_t n = _paths.memory() + _media.memory() + _transforms.memory();
+
+    n += ( _filename.capacity() + _clip_name.capacity() + 
+           _clip_date.capacity() + _media_id.capacity() +
+           _IDT.capacity() + _RRT.capacity() + _RRTODT.capacity() +
+           _ODT.capacity() + _LMT_offsets.capacity() + _LMT.capacity() +
+           _media_sorted.capacity() ) * sizeof(unsigned);
+    n += _error.capacity();
+
+    n += _by_IDT.memory() + _by_ODT.memory() + _by_RRT.memory() +
+         _by_RRTODT.memory() + _by_media_id.memory() + _by_LMT.memory();
+    return n;
+}
+
+}  // namespace ACES
@@ -0,0 +1,270 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <process.h>
+#define write _write
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+#include "ACESclipFormat.h"
+
+
+namespace ACES {
+
+static char* put_int( char* p, int v )
+{
+    char digits[12];
+    unsigned u = v < 0 ? 0u - (unsigned) v : (unsigned) v;
+    int n = 0;
+    do
+    {
+        digits[n++] = (char)( '0' + u % 10 );
+        u /= 10;
+    } while ( u );
+    if ( v < 0 ) *p++ = '-';
+    while ( n ) *p++ = digits[--n];
+    return p;
+}
+
+static char* put_2digits( char* p, int v )
+{
+    p[0] = (char)( '0' + v / 10 );
+    p[1] = (char)( '0' + v % 10 );
+    return p + 2;
+}
+
+struct DateTimeCache
+{
+    time_t t;
+    bool   valid;
+    char   text[kDateTimeSize];
+};
+
+static thread_local DateTimeCache t_date_time = { 0, false, { 0 } };
+
+const char* format_date_time( time_t t, char* out )
+{
+    DateTimeCache& c = t_date_time;
+    if ( !c.valid || c.t != t )
+    {
+        struct tm now;
+#ifdef _WIN32
+        bool ok = localtime_s( &now, &t ) == 0;
+#else
+        bool ok = localtime_r( &t, &now ) != NULL;
+#endif
+        if ( !ok )
+        {
+            out[0] = 0;
+            return out;
+        }
+
+        char* p = put_int( c.text, now.tm_year + 1900 );
+        *p++ = '-';
+        p = put_2digits( p, now.tm_mon + 1 );
+        *p++ = '-';
+        p = put_2digits( p, now.tm_mday );
+        *p++ = 'T';
+        p = put_2digits( p, now.tm_hour );
+        *p++ = ':';
+        p = put_2digits( p, now.tm_min );
+        *p++ = ':';
+        p = put_2digits( p, now.tm_sec );
+        *p = 0;
+
+        c.t = t;
+        c.valid = true;
+    }
+    memcpy( out, c.text, kDateTimeSize );
+    return out;
+}
+
+const char* status_name( TransformStatus s )
+{
+    switch( s )
+    {
+        case kPreview:
+            return "preview";
+        case kApplied:
+            return "applied";
+        default:
+            return "unknown";
+    }
+}
+
+const char* bit_depth_name( ACESclipMetadata::BitDepth d )
+{
+    switch( d )
+    {
+        case ACESclipMetadata::k10i:
+            return "10i";
+        case ACESclipMetadata::k12i:
+            return "12i";
+        case ACESclipMetadata::k16i:
+            return "16i";
+        case ACESclipMetadata::k16f:
+            return "16f";
+        default:
+            return "32f";
+    }
+}
+
+bool write_all( int fd, const char* data, size_t size )
+{
+    while ( size > 0 )
+    {
+        int n = (int) write( fd, data, (unsigned) size );
+        if ( n < 0 )
+        {
+            if ( errno == EINTR ) continue;
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+int replace_file( const std::string& path, const char* data, size_t size,
+                  bool sync, std::string& temporary )
+{
+    // One counter for every replace in the process
+    static std::atomic<unsigned> counter( 0 );
+
+    char suffix[64];
+    snprintf( suffix, sizeof(suffix), ".%u.%u.tmp", (unsigned) getpid(),
+              counter.fetch_add( 1 ) );
+
+#ifdef _WIN32
+    const std::string& target = path;
+    temporary = target;
+    temporary += suffix;
+    const char* tmp = temporary.c_str();
+
+    int fd = _open( tmp, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                    _S_IREAD | _S_IWRITE );
+    if ( fd < 0 ) return errno;
+    int err = 0;
+#else
+    // Through symlinks, so the file they point to is replaced, not them
+    std::string target = path;
+    char* real = realpath( path.c_str(), NULL );
+    if ( real )
+    {
+        target = real;
+        free( real );
+    }
+    temporary = target;
+    temporary += suffix;
+    const char* tmp = temporary.c_str();
+
+    struct stat old;
+    bool existed = stat( target.c_str(), &old ) == 0;
+
+    int fd = open( tmp, O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+    if ( fd < 0 ) return errno;
+
+    // The new file keeps the permissions of the old one, and its owner
+    // when the user may give it away; not being allowed to is no error
+    int err = 0;
+    if ( existed )
+    {
+        if ( fchown( fd, old.st_uid, old.st_gid ) != 0 ) errno = 0;
+        if ( fchmod( fd, old.st_mode & 07777 ) != 0 ) err = errno;
+    }
+#endif
+
+    if ( !err && !write_all( fd, data, size ) ) err = errno;
+#ifdef _WIN32
+    if ( !err && sync && _commit( fd ) != 0 ) err = errno;
+    if ( _close( fd ) != 0 && !err ) err = errno;
+    DWORD flags = MOVEFILE_REPLACE_EXISTING;
+    if ( sync ) flags |= MOVEFILE_WRITE_THROUGH;
+    if ( !err && !MoveFileExA( tmp, target.c_str(), flags ) ) err = EIO;
+#else
+    if ( !err && sync && fsync( fd ) != 0 ) err = errno;
+    if ( close( fd ) != 0 && !err ) err = errno;
+    if ( !err && rename( tmp, target.c_str() ) != 0 ) err = errno;
+#endif
+
+    if ( err ) ::remove( tmp );
+    return err;
+}
+
+bool replace_file( const std::string& path, const char* data, size_t size,
+                   bool sync )
+{
+    std::string temporary;
+    return replace_file( path, data, size, sync, temporary ) == 0;
+}
+
+std::string directory_of( const std::string& filename )
+{
+#ifdef _WIN32
+    size_t i = filename.find_last_of( "/\\" );
+#else
+    size_t i = filename.rfind( '/' );
+#endif
+    if ( i == std::string::npos ) return ".";
+    if ( i == 0 ) return "/";
+    return filename.substr( 0, i );
+}
+
+int sync_directory( const std::string& dir )
+{
+#ifdef _WIN32
+    // NTFS journals renames done with MOVEFILE_WRITE_THROUGH
+    return 0;
+#else
+    int fd = open( dir.c_str(), O_RDONLY );
+    if ( fd < 0 ) return errno;
+    int err = 0;
+    // Some filesystems cannot sync directories, and say so with EINVAL
+    if ( fsync( fd ) != 0 && errno != EINVAL ) err = errno;
+    close( fd );
+    return err;
+#endif
+}
+
+}  // namespace ACES
@@ -0,0 +1,127 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESclipFormat_h
+#define ACESclipFormat_h
+
+#include <time.h>
+#include <string>
+
+#include "ACESTransform.h"
+#include "ACESclipMetadata.h"
+
+namespace ACES {
+
+// Values written by every ACESclip writer, so all of them agree.
+
+static const double kVersion = 1.0;
+static const double kContainerVersion = 1.0;
+
+// Room for format_date_time(), with any year.
+static const size_t kDateTimeSize = 32;
+
+/** 
+ * Date and time in ACESclip format, 2015-01-02T03:04:05, local time.
+ * Thread safe.  The last time formatted is kept per thread, so the
+ * ModificationTime of many files written in the same second converts
+ * only once.
+ * 
+ * @param t    time to format
+ * @param out  at least kDateTimeSize chars.  Empty if t has no
+ *             local time.
+ * 
+ * @return out
+ */
+const char* format_date_time( time_t t, char* out );
+
+/** 
+ * @return "preview", "applied" or "unknown".
+ */
+const char* status_name( TransformStatus s );
+
+/** 
+ * @return "10i", "12i", "16i", "16f" or "32f".  Unknown depths are
+ *         written as "32f".
+ */
+const char* bit_depth_name( ACESclipMetadata::BitDepth d );
+
+/** 
+ * Write all of a buffer to a file descriptor, retrying short writes
+ * and interrupted calls.
+ * 
+ * @return true on success, false on error.
+ */
+bool write_all( int fd, const char* data, size_t size );
+
+/** 
+ * Write a file atomically: to a temporary name in the same directory
+ * first, then renamed over the final one, so readers see either the old
+ * file or the new one.  Temporary names are unique in the process, so
+ * concurrent replaces of the same path never share one.
+ * 
+ * An existing file keeps its permissions, and its owner where the
+ * user may set it.  A symlink is followed, so the file it points to is
+ * replaced and the link stays.
+ * 
+ * With sync, the temporary file is flushed to disk before the rename,
+ * so a crash cannot leave a torn file under the final name.  The
+ * rename itself is only on disk once the directory is synced too.
+ * 
+ * @param temporary  set to the temporary name, in the directory the
+ *                   file is renamed in.  Passing the same string each
+ *                   time reuses its memory.
+ * 
+ * @return 0 on success, errno on failure.
+ */
+int replace_file( const std::string& path, const char* data, size_t size,
+                  bool sync, std::string& temporary );
+
+/** 
+ * replace_file() above, with a temporary name of its own.
+ * 
+ * @return true on success, false on error.
+ */
+bool replace_file( const std::string& path, const char* data, size_t size,
+                   bool sync = false );
+
+/** 
+ * Directory a file is in, "." for a bare name.
+ */
+std::string directory_of( const std::string& filename );
+
+/** 
+ * Sync a directory, so the renames done in it are on disk.
+ * 
+ * @return 0 on success, errno on failure.
+ */
+int sync_directory( const std::string& dir );
+
+}  // namespace ACES
+
+#endif  // ACESclipFormat_h
@@ -0,0 +1,369 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#include "ACESclipPatch.h"
+#include "ACESclipFormat.h"
+#include "ACESMappedFile.h"
+#include "ACESNumeric.h"
+#include "ACESxmlScanner.h"
+#include "ACESxmlStream.h"
+
+
+namespace ACES {
+
+// Patched file and its temporary name, for patch_file(), per thread
+static thread_local std::string t_patched;
+static thread_local std::string t_temporary;
+
+namespace {
+
+/**
+ * One replacement inside a start tag: the span of an attribute value,
+ * or an empty span where a missing attribute is added.
+ */
+struct Edit
+{
+    const char*        begin;
+    const char*        end;
+    const std::string* attribute;   // name to add, NULL to replace
+    const std::string* value;
+
+    bool operator<( const Edit& b ) const { return begin < b.begin; }
+
+    bool same( const Edit& b ) const
+    {
+        if ( begin != b.begin || end != b.end ) return false;
+        if ( !attribute || !b.attribute ) return attribute == b.attribute;
+        return *attribute == *b.attribute;
+    }
+};
+
+}  // namespace
+
+
+ACESclipPatch::ACESclipPatch() :
+_touch( true )
+{
+}
+
+void ACESclipPatch::clear()
+{
+    _changes.clear();
+}
+
+/** 
+ * Add a change, replacing the value of one made before to the same
+ * element, attribute and occurrence.
+ */
+void ACESclipPatch::add( const std::string& element, 
+                         const std::string& attribute,
+                         const std::string& value, int occurrence )
+{
+    Change c;
+    c.element = element;
+    c.attribute = attribute;
+    c.occurrence = occurrence < 0 ? kAll : occurrence;
+    xml_escape( c.value, value.data(), value.size(), !attribute.empty() );
+
+    for ( size_t i = 0; i < _changes.size(); ++i )
+    {
+        Change& o = _changes[i];
+        if ( o.element == c.element && o.attribute == c.attribute &&
+             o.occurrence == c.occurrence )
+        {
+            o.value.swap( c.value );
+            return;
+        }
+    }
+    _changes.push_back( c );
+}
+
+void ACESclipPatch::set_text( const std::string& element, 
+                              const std::string& text, int occurrence )
+{
+    add( element, "", text, occurrence );
+}
+
+void ACESclipPatch::set_attribute( const std::string& element, 
+                                   const std::string& attribute,
+                                   const std::string& value, 
+                                   int occurrence )
+{
+    if ( attribute.empty() ) return;
+    add( element, attribute, value, occurrence );
+}
+
+void ACESclipPatch::cdl( const ASC_CDL& c )
+{
+    char buf[3 * kFloatChars];
+    float slope[3] = { c.slope(0), c.slope(1), c.slope(2) };
+    format_V3( slope, buf );
+    set_text( "Slope", buf );
+
+    float offset[3] = { c.offset(0), c.offset(1), c.offset(2) };
+    format_V3( offset, buf );
+    set_text( "Offset", buf );
+
+    float power[3] = { c.power(0), c.power(1), c.power(2) };
+    format_V3( power, buf );
+    set_text( "Power", buf );
+
+    format_float( c.saturation(), buf );
+    set_text( "Saturation", buf );
+}
+
+void ACESclipPatch::convert_to( const std::string& name )
+{
+    set_attribute( "Convert_to_WorkSpace", "TransformID", name );
+}
+
+void ACESclipPatch::convert_from( const std::string& name )
+{
+    set_attribute( "Convert_from_WorkSpace", "TransformID", name );
+}
+
+void ACESclipPatch::IDT( const std::string& name )
+{
+    set_attribute( "aces:IDTref", "TransformID", name );
+}
+
+void ACESclipPatch::LMT( int index, const std::string& name )
+{
+    set_attribute( "aces:LMTref", "TransformID", name, index );
+}
+
+void ACESclipPatch::RRT( const std::string& name )
+{
+    set_attribute( "aces:RRTref", "TransformID", name );
+}
+
+void ACESclipPatch::RRTODT( const std::string& name )
+{
+    set_attribute( "aces:RRTODTref", "TransformID", name );
+}
+
+void ACESclipPatch::ODT( const std::string& name )
+{
+    set_attribute( "aces:ODTref", "TransformID", name );
+}
+
+ACESclipPatch::ACESError 
+ACESclipPatch::apply( const char* data, size_t size, std::string& out,
+                      size_t* changed ) const
+{
+    out.clear();
+    out.reserve( size + 256 );
+
+    size_t count = 0;
+    const char* copied = data;   // everything before is in out already
+
+    // Elements seen so far that each change could apply to
+    std::vector< int > seen( _changes.size(), 0 );
+    std::vector< Edit > edits;
+
+    // Element whose text is replaced when it ends, if any
+    const std::string* text = NULL;
+    const char* text_begin = NULL;
+    const char* text_name = NULL;
+    unsigned    text_depth = 0;
+    bool        text_counts = false;
+
+    char date[kDateTimeSize];
+    std::string now;
+
+    bool root = false;
+    XMLScanner x( data, data + size );
+    for (;;)
+    {
+        XMLScanner::Token t = x.next();
+        if ( t == XMLScanner::kError ) 
+            return ACESclipReader::kErrorParsingElement;
+        if ( t == XMLScanner::kEndOfDocument ) break;
+
+        if ( t == XMLScanner::kStartElement )
+        {
+            const XMLSpan& name = x.name();
+            if ( !root )
+            {
+                if ( name != "aces:ACESmetadata" )
+                    return ACESclipReader::kNotAnAcesFile;
+                root = true;
+            }
+
+            // Texts are only replaced in elements without children
+            text = NULL;
+
+            const char* tag_end = data + x.offset();
+            edits.clear();
+            const std::string* new_text = NULL;
+            bool counts = true;
+
+            // Newest changes first, so they win over older ones
+            for ( size_t i = _changes.size(); i-- > 0; )
+            {
+                const Change& c = _changes[i];
+                if ( name != c.element.c_str() ) continue;
+
+                int n = seen[i]++;
+                if ( c.occurrence != kAll && c.occurrence != n ) continue;
+
+                if ( c.attribute.empty() )
+                {
+                    if ( !new_text ) new_text = &c.value;
+                    continue;
+                }
+
+                Edit e;
+                XMLSpan v;
+                if ( x.attribute( c.attribute.c_str(), v ) )
+                {
+                    e.begin = v.begin;
+                    e.end = v.end;
+                    e.attribute = NULL;
+                }
+                else
+                {
+                    // Before the > or /> that ends the tag
+                    const char* at = tag_end - 1;
+                    if ( at[-1] == '/' ) --at;
+                    e.begin = e.end = at;
+                    e.attribute = &c.attribute;
+                }
+                e.value = &c.value;
+                edits.push_back( e );
+            }
+
+            if ( !new_text && _touch && x.depth() == 2 &&
+                 name == "ModificationTime" )
+            {
+                now = format_date_time( time(0), date );
+                new_text = &now;
+                counts = false;
+            }
+
+            std::stable_sort( edits.begin(), edits.end() );
+            const Edit* last = NULL;
+            for ( size_t i = 0; i < edits.size(); ++i )
+            {
+                const Edit& e = edits[i];
+
+                // An older change to an attribute already written
+                if ( e.begin < copied || ( last && last->same( e ) ) ) 
+                    continue;
+
+                out.append( copied, e.begin - copied );
+                if ( e.attribute )
+                {
+                    out += ' ';
+                    out += *e.attribute;
+                    out += "=\"";
+                    out += *e.value;
+                    out += '"';
+                }
+                else
+                {
+                    out += *e.value;
+                }
+                copied = e.end;
+                last = &e;
+                ++count;
+            }
+
+            if ( new_text )
+            {
+                text = new_text;
+                text_begin = tag_end;
+                text_name = name.begin;
+                text_depth = x.depth();
+                text_counts = counts;
+            }
+        }
+        else if ( t == XMLScanner::kEndElement && text && 
+                  x.depth() == text_depth )
+        {
+            const XMLSpan& name = x.name();
+            if ( name.begin == text_name )
+            {
+                // <name/> becomes <name>text</name>
+                out.append( copied, text_begin - 2 - copied );
+                out += '>';
+                out += *text;
+                out += "</";
+                out.append( name.begin, name.size() );
+                out += '>';
+                copied = text_begin;
+            }
+            else
+            {
+                out.append( copied, text_begin - copied );
+                out += *text;
+                copied = name.begin - 2;   // the </ of the end tag
+            }
+            if ( text_counts ) ++count;
+            text = NULL;
+        }
+    }
+
+    if ( !root ) return ACESclipReader::kNotAnAcesFile;
+
+    out.append( copied, data + size - copied );
+    if ( changed ) *changed = count;
+    return ACESclipReader::kAllOK;
+}
+
+ACESclipPatch::ACESError 
+ACESclipPatch::apply( const char* filename, std::string& out,
+                      size_t* changed ) const
+{
+    MappedFile f;
+    if ( !f.open( filename ) ) return ACESclipReader::kFileError;
+    return apply( f.data(), f.size(), out, changed );
+}
+
+ACESclipPatch::ACESError 
+ACESclipPatch::patch_file( const char* filename, size_t* changed ) const
+{
+    size_t n = 0;
+    ACESError err = apply( filename, t_patched, &n );
+    if ( changed ) *changed = n;
+    if ( err != ACESclipReader::kAllOK || n == 0 ) return err;
+
+    // Synced before the rename, so a crash leaves the old file or the new
+    if ( replace_file( filename, t_patched.data(), t_patched.size(), true,
+                       t_temporary ) != 0 ||
+         sync_directory( directory_of( t_temporary ) ) != 0 )
+        return ACESclipReader::kFileError;
+    return ACESclipReader::kAllOK;
+}
+
+}  // namespace ACES
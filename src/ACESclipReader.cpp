@@ -28,14 +28,12 @@ either expressed or implied, of the FreeBSD Project.
 */
 
 #include <stdio.h>
-#include <locale.h>
+#include <string.h>
 #include <iostream>
-
-#ifdef _WIN32
-#define strtod_l _strtod_l
-#endif
+#include <istream>
 
 #include "ACESclipReader.h"
+#include "ACESNumeric.h"
 
 
 namespace ACES {
@@ -60,19 +58,30 @@ ACESclipReader::BitDepth ACESclipReader::get_bit_depth( const std::string& d )
 }
 
 /** 
- * Set status of a transform
+ * Turn an ACESclip date, 2015-01-02T03:04:05, into the form the reader
+ * stores, 2015-01-02 Time: 03:04:05.
  * 
- * @param s kPreview or kApplied
+ * @param i    date as found in the file
+ * @param out  formatted date.  Its memory is reused.
  */
-std::string ACESclipReader::date_time( const char* i )
+void ACESclipReader::date_time( const char* i, std::string& out )
 {
-    if (!i) return "";
+    out.clear();
+    if ( !i ) return;
+
+    // Without a 'T' the whole string ends up on both sides, as it
+    // always has.
+    const char* t = strchr( i, 'T' );
+    if ( t ) out.append( i, t - i );
+    else     out += i;
+    out += " Time: ";
+    out += t ? t + 1 : i;
+}
 
-    std::string s = i;
-    size_t e = s.find('T');
-    std::string r = s.substr(0, e );
-    r += " Time: ";
-    r += s.substr( e+1, s.size() );
+std::string ACESclipReader::date_time( const char* i )
+{
+    std::string r;
+    date_time( i, r );
     return r;
 }
 
@@ -96,39 +105,32 @@ TransformStatus ACESclipReader::get_status( const std::string& s )
  */
 void ACESclipReader::parse_V3( const char* v3, float out[3]  )
 {
-    const char* s = v3;
-    char* e;
-    out[0] = strtod_l( s, &e, loc ); s = e;
-    out[1] = strtod_l( s, &e, loc ); s = e;
-    out[2] = strtod_l( s, &e, loc );
+    ACES::parse_V3( v3, v3 + strlen(v3), out );
 }
 
 /** 
  * Constructor
  * 
  */
-ACESclipReader::ACESclipReader()
+ACESclipReader::ACESclipReader() :
+element( NULL ),
+root( NULL ),
+root2( NULL ),
+root3( NULL ),
+root4( NULL )
 {
-#ifdef _WIN32
-    // The following line should in theory work, but it doesn't
-    // _loc = _create_locale( LC_ALL, "en-US" );
-    // We instead use a full name
-    loc = _create_locale( LC_ALL, "C" );
-#else
-    locale_t empty;
-    memset( &empty, 0, sizeof(locale_t) );
-    loc = newlocale( LC_ALL, "en_US.UTF-8", empty );
-#endif
-
 }
 
 ACESclipReader::~ACESclipReader()
 {
-#ifdef _WIN32
-    _free_locale( loc );
-#else
-    freelocale( loc );
-#endif
+}
+
+void ACESclipReader::reset()
+{
+    ACESclipMetadata::reset();
+    doc.Clear();
+    element = NULL;
+    root = root2 = root3 = root4 = NULL;
 }
 
 /** 
@@ -143,7 +145,7 @@ ACESclipReader::ACESError ACESclipReader::header()
 
     element = root->FirstChildElement( "ContainerFormatVersion" );
     if ( !element ) return kErrorParsingElement;
-    float version = atof( element->GetText() );
+    float version = to_float( element->GetText() );
     if ( version > 1.0f )
         return kErrorVersion;
 
@@ -199,7 +201,7 @@ ACESclipReader::ACESError ACESclipReader::clip_id()
     if ( element )
     {
         const char* tmp = element->GetText();
-        if ( tmp ) clip_date = date_time( tmp );
+        if ( tmp ) date_time( tmp, clip_date );
     }
 
     return kAllOK;
@@ -216,7 +218,7 @@ ACESclipReader::ACESError ACESclipReader::config()
         const char* tmp = element->GetText();
         if ( tmp )
         {
-            double version = atof( tmp );
+            double version = to_double( tmp );
             if ( version > 1.0 )
             {
                 return kErrorVersion;
@@ -320,8 +322,7 @@ ACESclipReader::ACESError ACESclipReader::GradeRef()
             const char* s = element->GetText();
             if ( s )
             {
-                char* e = (char*) s + strlen(s) - 1;
-                sops.saturation( (float) strtod_l( s, &e, loc ) );
+                sops.saturation( to_float( s ) );
             }
         }
     }
@@ -552,17 +553,12 @@ const char* ACESclipReader::error_name( ACESclipReader::ACESError err ) const
 }
 
 /** 
- * First Step.  Load the XML file.
+ * Run all the sections on the loaded document.
  * 
- * @param filename file to load the XML file from. 
- * 
- * @return true on success, false on failure
+ * @return ACESError.
  */
-ACESclipReader::ACESError ACESclipReader::load( const char* filename )
+ACESclipReader::ACESError ACESclipReader::parse()
 {
-    XMLError e = doc.LoadFile( filename );
-    if ( e != XML_NO_ERROR ) return kFileError;
-
     ACESError err = header();
     if ( err != kAllOK ) return err;
 
@@ -584,6 +580,72 @@ ACESclipReader::ACESError ACESclipReader::load( const char* filename )
     return kAllOK;
 }
 
+/** 
+ * First Step.  Load the XML file.
+ * 
+ * @param filename file to load the XML file from. 
+ * 
+ * @return true on success, false on failure
+ */
+ACESclipReader::ACESError ACESclipReader::load( const char* filename )
+{
+    reset();
+
+    XMLError e = doc.LoadFile( filename );
+    if ( e != XML_NO_ERROR ) return kFileError;
+
+    return parse();
+}
+
+/** 
+ * Load the XML file from memory.
+ * 
+ * @param data  XML contents
+ * @param len   size of the contents, in bytes
+ * 
+ * @return ACESError.
+ */
+ACESclipReader::ACESError ACESclipReader::load( const char* data, size_t len )
+{
+    reset();
+    if ( !data || len == 0 ) return kFileError;
+
+    XMLError e = doc.Parse( data, len );
+    if ( e != XML_NO_ERROR ) return kFileError;
+
+    return parse();
+}
+
+/** 
+ * Load the XML file from a stream.
+ * 
+ * @param in  stream positioned at the start of the XML contents
+ * 
+ * @return ACESError.
+ */
+ACESclipReader::ACESError ACESclipReader::load( std::istream& in )
+{
+    std::string buf;
+
+    // Read it in one go if the stream knows its size.
+    std::streampos pos = in.tellg();
+    if ( pos != std::streampos(-1) )
+    {
+        in.seekg( 0, std::ios::end );
+        std::streampos end = in.tellg();
+        in.seekg( pos );
+        if ( end > pos ) buf.reserve( (size_t)( end - pos ) );
+    }
+
+    char chunk[16384];
+    while ( in.read( chunk, sizeof(chunk) ) || in.gcount() > 0 )
+        buf.append( chunk, (size_t) in.gcount() );
+
+    if ( in.bad() ) return kFileError;
+
+    return load( buf.data(), buf.size() );
+}
+
 
 }  // namespace ACES
 
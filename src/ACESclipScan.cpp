@@ -0,0 +1,781 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "ACESclipReader.h"
+#include "ACESNumeric.h"
+#include "ACESMappedFile.h"
+#include "ACESxmlScanner.h"
+
+
+namespace ACES {
+
+namespace {
+
+/**
+ * Elements the scanner cares about.  Each one is only recognized under
+ * its expected parent and, like FirstChildElement(), only the first
+ * occurrence counts (except for aces:LMTref).
+ */
+enum Context
+{
+kIgnore,
+kDocument,
+kRoot,
+kContainerVersion,
+kInfo,
+kApplication,
+kComment,
+kClipID,
+kClipName,
+kMediaID,
+kClipDate,
+kConfig,
+kReleaseVersion,
+kConfigDate,
+// Input Transform List
+kITL,
+kIDT,
+kIDTLink,
+kLinkITL,
+kGradeRef,
+kConvertTo,
+kColorDecisionList,
+kCDL,
+kSOPNode,
+kSlope,
+kOffset,
+kPower,
+kSatNode,
+kSaturation,
+kConvertFrom,
+// Preview Transform List
+kPTL,
+kLMT,
+kLMTLink,
+kRRTODT,
+kRRT,
+kODT,
+kODTLink,
+kLinkPTL,
+kLastContext
+};
+
+/**
+ * Text or attribute value found in the buffer.  Nothing is decoded
+ * until the value is stored in the reader.
+ */
+struct Field
+{
+    Field() : raw( false ) {}
+
+    bool present() const { return span.begin != NULL; }
+
+    XMLSpan span;
+    bool    raw;   // CDATA, no entities to decode
+};
+
+struct TransformFields
+{
+    Field name;
+    Field status;
+    Field link;
+};
+
+/** 
+ * LMTs found.  The first kInline are kept in place, so usual files scan
+ * without allocating.
+ */
+class TransformList
+{
+  public:
+    enum { kInline = 16 };
+
+    TransformList() : _size( 0 ) {}
+
+    void clear()
+    {
+        _size = 0;
+        _more.clear();
+    }
+
+    void push_back( const TransformFields& t )
+    {
+        if ( _size < kInline ) _inline[_size] = t;
+        else _more.push_back( t );
+        ++_size;
+    }
+
+    size_t size() const { return _size; }
+
+    TransformFields& back() { return (*this)[_size-1]; }
+
+    TransformFields& operator[]( size_t i )
+    {
+        return i < kInline ? _inline[i] : _more[i - kInline];
+    }
+
+    const TransformFields& operator[]( size_t i ) const
+    {
+        return i < kInline ? _inline[i] : _more[i - kInline];
+    }
+
+  private:
+    TransformFields _inline[kInline];
+    std::vector< TransformFields > _more;
+    size_t _size;
+};
+
+struct ScanState
+{
+    ScanState()
+    {
+        reset( kIgnore, kLinkPTL );
+        itl_prefixed = ptl_prefixed = false;
+    }
+
+    void reset( Context first, Context last )
+    {
+        for ( unsigned i = first; i <= (unsigned) last; ++i )
+            seen[i] = closed[i] = false;
+    }
+
+    bool seen[kLastContext];
+    bool closed[kLastContext];
+    bool itl_prefixed, ptl_prefixed;
+
+    Field container_version;
+    Field application, app_version, comment;
+    Field clip_name, media_id, clip_date;
+    Field release_version, config_date;
+
+    TransformFields IDT;
+    Field link_ITL;
+
+    Field graderef_status;
+    Field convert_to, convert_from;
+    Field in_bit_depth, out_bit_depth;
+    Field slope, offset, power, saturation;
+
+    TransformList LMT;
+    TransformFields RRTODT, RRT, ODT;
+    Field link_PTL;
+};
+
+inline void attribute( const XMLScanner& x, const char* name, Field& f )
+{
+    f.raw = false;
+    if ( !x.attribute( name, f.span ) ) f.span = XMLSpan();
+}
+
+/** 
+ * Transform name, from TransformID or, for backwards compatibility,
+ * from name.
+ */
+inline void transform_name( const XMLScanner& x, Field& f, bool compat )
+{
+    attribute( x, "TransformID", f );
+    if ( !f.present() && compat ) attribute( x, "name", f );
+}
+
+inline void decode( const Field& f, std::string& out )
+{
+    if ( f.raw ) out.assign( f.span.begin, f.span.size() );
+    else xml_decode( f.span, out );
+}
+
+inline size_t decode( const Field& f, char* buf, size_t size )
+{
+    if ( !f.raw ) return xml_decode( f.span, buf, size );
+
+    size_t len = f.span.size();
+    if ( len >= size ) len = size - 1;
+    memcpy( buf, f.span.begin, len );
+    buf[len] = 0;
+    return len;
+}
+
+/** 
+ * Find the context of a new element from its parent's context.
+ * 
+ * @param s       scan state
+ * @param parent  context of the parent element
+ * @param x       scanner positioned on the start element
+ * 
+ * @return context of the element
+ */
+Context start_element( ScanState& s, Context parent, const XMLScanner& x )
+{
+    const XMLSpan& n = x.name();
+    Context c = kIgnore;
+
+    switch( parent )
+    {
+        case kIgnore:
+            return kIgnore;
+        case kDocument:
+            if ( n == "aces:ACESmetadata" ) c = kRoot;
+            break;
+        case kRoot:
+            if ( n == "ContainerFormatVersion" ) c = kContainerVersion;
+            else if ( n == "aces:Info" ) c = kInfo;
+            else if ( n == "aces:ClipID" ) c = kClipID;
+            else if ( n == "aces:Config" ) c = kConfig;
+            break;
+        case kInfo:
+            if ( n == "Application" ) c = kApplication;
+            else if ( n == "Comment" ) c = kComment;
+            break;
+        case kClipID:
+            if ( n == "ClipName" ) c = kClipName;
+            else if ( n == "Source_MediaID" ) c = kMediaID;
+            else if ( n == "ClipDate" ) c = kClipDate;
+            break;
+        case kConfig:
+            if ( n == "ACESrelease_Version" ) c = kReleaseVersion;
+            else if ( n == "ClipDate" ) c = kConfigDate;
+            else if ( n == "aces:InputTransformList" )
+            {
+                // The prefixed list wins over the unprefixed one
+                if ( s.seen[kITL] && !s.itl_prefixed )
+                {
+                    s.reset( kITL, kConvertFrom );
+                    s.IDT = TransformFields();
+                    s.link_ITL = Field();
+                    s.graderef_status = s.convert_to = s.convert_from = Field();
+                    s.in_bit_depth = s.out_bit_depth = Field();
+                    s.slope = s.offset = s.power = s.saturation = Field();
+                }
+                if ( !s.seen[kITL] ) s.itl_prefixed = true;
+                c = kITL;
+            }
+            else if ( n == "InputTransformList" ) c = kITL;
+            else if ( n == "aces:PreviewTransformList" )
+            {
+                if ( s.seen[kPTL] && !s.ptl_prefixed )
+                {
+                    s.reset( kPTL, kLinkPTL );
+                    s.LMT.clear();
+                    s.RRTODT = s.RRT = s.ODT = TransformFields();
+                    s.link_PTL = Field();
+                }
+                if ( !s.seen[kPTL] ) s.ptl_prefixed = true;
+                c = kPTL;
+            }
+            else if ( n == "PreviewTransformList" ) c = kPTL;
+            break;
+        case kITL:
+            if ( n == "aces:IDTref" ) c = kIDT;
+            else if ( n == "aces:GradeRef" ) c = kGradeRef;
+            else if ( n == "LinkInputTransformList" ) c = kLinkITL;
+            break;
+        case kIDT:
+            if ( n == "LinkTransform" ) c = kIDTLink;
+            break;
+        case kGradeRef:
+            if ( n == "Convert_to_WorkSpace" ) c = kConvertTo;
+            else if ( n == "ColorDecisionList" ) c = kColorDecisionList;
+            else if ( n == "Convert_from_WorkSpace" ) c = kConvertFrom;
+            break;
+        case kColorDecisionList:
+            if ( n == "ASC_CDL" ) c = kCDL;
+            break;
+        case kCDL:
+            if ( n == "SOPNode" ) c = kSOPNode;
+            else if ( n == "SatNode" ) c = kSatNode;
+            break;
+        case kSOPNode:
+            if ( n == "Slope" ) c = kSlope;
+            else if ( n == "Offset" ) c = kOffset;
+            else if ( n == "Power" ) c = kPower;
+            break;
+        case kSatNode:
+            if ( n == "Saturation" ) c = kSaturation;
+            break;
+        case kPTL:
+            if ( n == "aces:LMTref" ) c = kLMT;
+            else if ( n == "aces:RRTODTref" ) c = kRRTODT;
+            else if ( n == "aces:RRTref" ) c = kRRT;
+            else if ( n == "aces:ODTref" ) c = kODT;
+            else if ( n == "LinkPreviewTransformList" ) c = kLinkPTL;
+            break;
+        case kLMT:
+            if ( n == "LinkTransform" ) c = kLMTLink;
+            break;
+        case kODT:
+            if ( n == "LinkTransform" ) c = kODTLink;
+            break;
+        default:
+            break;
+    }
+
+    if ( c == kIgnore ) return kIgnore;
+
+    if ( c == kLMT )
+    {
+        s.LMT.push_back( TransformFields() );
+        s.seen[kLMTLink] = false;
+    }
+    else if ( s.seen[c] )
+    {
+        return kIgnore;
+    }
+    s.seen[c] = true;
+
+    switch( c )
+    {
+        case kApplication:
+            attribute( x, "version", s.app_version );
+            break;
+        case kIDT:
+            transform_name( x, s.IDT.name, true );
+            attribute( x, "status", s.IDT.status );
+            break;
+        case kGradeRef:
+            attribute( x, "status", s.graderef_status );
+            break;
+        case kConvertTo:
+            attribute( x, "TransformID", s.convert_to );
+            break;
+        case kConvertFrom:
+            attribute( x, "TransformID", s.convert_from );
+            break;
+        case kCDL:
+            attribute( x, "inBitDepth", s.in_bit_depth );
+            attribute( x, "outBitDepth", s.out_bit_depth );
+            break;
+        case kLMT:
+            transform_name( x, s.LMT.back().name, true );
+            attribute( x, "status", s.LMT.back().status );
+            break;
+        case kRRTODT:
+            transform_name( x, s.RRTODT.name, false );
+            attribute( x, "status", s.RRTODT.status );
+            break;
+        case kRRT:
+            transform_name( x, s.RRT.name, true );
+            attribute( x, "status", s.RRT.status );
+            break;
+        case kODT:
+            transform_name( x, s.ODT.name, true );
+            attribute( x, "status", s.ODT.status );
+            break;
+        default:
+            break;
+    }
+
+    return c;
+}
+
+/** 
+ * Store the text of an element, if it is one we want.
+ */
+void text( ScanState& s, Context c, const XMLScanner& x )
+{
+    Field* f;
+    switch( c )
+    {
+        case kContainerVersion: f = &s.container_version; break;
+        case kApplication:      f = &s.application; break;
+        case kComment:          f = &s.comment; break;
+        case kClipName:         f = &s.clip_name; break;
+        case kMediaID:          f = &s.media_id; break;
+        case kClipDate:         f = &s.clip_date; break;
+        case kReleaseVersion:   f = &s.release_version; break;
+        case kConfigDate:       f = &s.config_date; break;
+        case kIDTLink:          f = &s.IDT.link; break;
+        case kLinkITL:          f = &s.link_ITL; break;
+        case kSlope:            f = &s.slope; break;
+        case kOffset:           f = &s.offset; break;
+        case kPower:            f = &s.power; break;
+        case kSaturation:       f = &s.saturation; break;
+        case kLMTLink:          f = &s.LMT.back().link; break;
+        case kODTLink:          f = &s.ODT.link; break;
+        case kLinkPTL:          f = &s.link_PTL; break;
+        default:
+            return;
+    }
+
+    f->span = x.text();
+    f->raw  = x.cdata();
+}
+
+/** 
+ * Check whether all the requested sections have been read in full,
+ * so the scan can stop.
+ * 
+ * @param s         scan state
+ * @param sections  ACESclipReader::Section flags
+ * 
+ * @return true if nothing else is needed from the file.
+ */
+bool finished( const ScanState& s, unsigned sections )
+{
+    if ( s.closed[kRoot] ) return true;
+    if ( !s.closed[kContainerVersion] ) return false;
+
+    // The first of each element wins, but a prefixed transform list
+    // still replaces an unprefixed one found before it.
+    bool config = s.closed[kConfig];
+    bool itl = config || ( s.closed[kITL] && s.itl_prefixed );
+    bool ptl = config || ( s.closed[kPTL] && s.ptl_prefixed );
+
+    if ( ( sections & ACESclipReader::kSectionInfo ) && !s.closed[kInfo] )
+        return false;
+    if ( ( sections & ACESclipReader::kSectionClipID ) && !s.closed[kClipID] )
+        return false;
+    if ( ( sections & ACESclipReader::kSectionConfig ) && !config &&
+         !( s.closed[kReleaseVersion] && s.closed[kConfigDate] ) )
+        return false;
+    if ( ( sections & ACESclipReader::kSectionITL ) && !itl )
+        return false;
+    if ( ( sections & ACESclipReader::kSectionGradeRef ) && !itl &&
+         !( s.closed[kGradeRef] && s.itl_prefixed ) )
+        return false;
+    if ( ( sections & ACESclipReader::kSectionPTL ) && !ptl )
+        return false;
+
+    return true;
+}
+
+}  // namespace
+
+
+/** 
+ * Scan an ACESclip file in place and fill in the reader fields.  The
+ * checks are made in the same order as header(), info(), clip_id(),
+ * config(), ITL() and PTL() make them, so the result and the fields
+ * filled on error match load().
+ * 
+ * Only the sections asked for are stored, and the scan stops as soon
+ * as they have all been read.
+ * 
+ * @param begin     start of the XML data
+ * @param end       end of the XML data
+ * @param sections  Section flags
+ * 
+ * @return ACESError.
+ */
+ACESclipReader::ACESError ACESclipReader::scan( const char* begin,
+                                                const char* end,
+                                                unsigned sections )
+{
+    ScanState s;
+    Context ctx[XMLScanner::kMaxDepth+1];
+    ctx[0] = kDocument;
+
+    bool done = false;
+    XMLScanner x( begin, end );
+    while ( !done )
+    {
+        XMLScanner::Token t = x.next();
+        if ( t == XMLScanner::kEndOfDocument ) break;
+
+        switch( t )
+        {
+            case XMLScanner::kStartElement:
+                ctx[x.depth()] = start_element( s, ctx[x.depth()-1], x );
+                break;
+            case XMLScanner::kText:
+                if ( x.first_child() ) text( s, ctx[x.depth()], x );
+                break;
+            case XMLScanner::kEndElement:
+                if ( ctx[x.depth()] != kIgnore )
+                {
+                    s.closed[ctx[x.depth()]] = true;
+                    done = finished( s, sections );
+                }
+                break;
+            default:
+                return kFileError;
+        }
+    }
+
+    char buf[256];
+
+    // header()
+    if ( !s.seen[kRoot] ) return kNotAnAcesFile;
+    if ( !s.seen[kContainerVersion] ) return kErrorParsingElement;
+    size_t len = decode( s.container_version, buf, sizeof(buf) );
+    float container = 0.0f;
+    parse_float( buf, buf + len, container );
+    if ( container > 1.0f )
+        return kErrorVersion;
+
+    const unsigned kConfigSections = kSectionConfig | kSectionITL |
+                                     kSectionGradeRef | kSectionPTL;
+
+    // info()
+    if ( sections & kSectionInfo )
+    {
+        if ( !s.seen[kInfo] ) return kNoAcesInfo;
+        if ( s.application.present() ) decode( s.application, application );
+        if ( s.app_version.present() ) decode( s.app_version, version );
+        if ( s.comment.present() ) decode( s.comment, comment );
+    }
+
+    // clip_id()
+    if ( sections & kSectionClipID )
+    {
+        if ( !s.seen[kClipID] ) return kNoClipID;
+        if ( s.clip_name.present() ) decode( s.clip_name, clip_name );
+        if ( s.media_id.present() ) decode( s.media_id, media_id );
+        if ( s.clip_date.present() )
+        {
+            decode( s.clip_date, buf, sizeof(buf) );
+            date_time( buf, clip_date );
+        }
+    }
+
+    // config()
+    if ( sections & kConfigSections )
+    {
+        if ( !s.seen[kConfig] ) return kNoConfig;
+    }
+    if ( sections & kSectionConfig )
+    {
+        if ( s.release_version.present() )
+        {
+            len = decode( s.release_version, buf, sizeof(buf) );
+            double release = 0.0;
+            parse_double( buf, buf + len, release );
+            if ( release > 1.0 ) return kErrorVersion;
+        }
+        if ( s.config_date.present() ) decode( s.config_date, timestamp );
+    }
+
+    // ITL()
+    if ( sections & ( kSectionITL | kSectionGradeRef ) )
+    {
+        if ( !s.seen[kITL] ) return kNoInputTransformList;
+    }
+
+    if ( sections & kSectionITL )
+    {
+        IDT.name.clear();
+        IDT.link_transform.clear();
+        IDT.status = kPreview;
+        if ( s.IDT.name.present() ) decode( s.IDT.name, IDT.name );
+        if ( s.IDT.status.present() )
+        {
+            decode( s.IDT.status, buf, sizeof(buf) );
+            IDT.status = get_status( buf );
+        }
+        if ( s.IDT.link.present() ) decode( s.IDT.link, IDT.link_transform );
+    }
+
+    // GradeRef()
+    if ( ( sections & kSectionGradeRef ) && s.seen[kGradeRef] )
+    {
+        graderef_status = kPreview;
+        if ( s.graderef_status.present() )
+        {
+            decode( s.graderef_status, buf, sizeof(buf) );
+            graderef_status = get_status( buf );
+        }
+
+        if ( !s.convert_to.present() ) return kMissingSpaceConversion;
+        decode( s.convert_to, convert_to );
+
+        if ( s.seen[kCDL] )
+        {
+            if ( s.in_bit_depth.present() )
+            {
+                decode( s.in_bit_depth, buf, sizeof(buf) );
+                in_bit_depth = get_bit_depth( buf );
+            }
+            if ( s.out_bit_depth.present() )
+            {
+                decode( s.out_bit_depth, buf, sizeof(buf) );
+                out_bit_depth = get_bit_depth( buf );
+            }
+
+            float out[3];
+            if ( s.seen[kSOPNode] )
+            {
+                grade_refs.push_back( "SOPNode" );
+                if ( s.slope.present() )
+                {
+                    len = decode( s.slope, buf, sizeof(buf) );
+                    ACES::parse_V3( buf, buf + len, out );
+                    sops.slope( out[0], out[1], out[2] );
+                }
+                if ( s.offset.present() )
+                {
+                    len = decode( s.offset, buf, sizeof(buf) );
+                    ACES::parse_V3( buf, buf + len, out );
+                    sops.offset( out[0], out[1], out[2] );
+                }
+                if ( s.power.present() )
+                {
+                    len = decode( s.power, buf, sizeof(buf) );
+                    ACES::parse_V3( buf, buf + len, out );
+                    sops.power( out[0], out[1], out[2] );
+                }
+            }
+
+            if ( s.seen[kSaturation] )
+            {
+                grade_refs.push_back( "SatNode" );
+                if ( s.saturation.present() )
+                {
+                    len = decode( s.saturation, buf, sizeof(buf) );
+                    float sat = 0.0f;
+                    parse_float( buf, buf + len, sat );
+                    sops.saturation( sat );
+                }
+            }
+
+            if ( !s.convert_from.present() ) return kMissingSpaceConversion;
+            decode( s.convert_from, convert_from );
+        }
+    }
+
+    if ( sections & kSectionITL )
+    {
+        if ( s.link_ITL.present() ) decode( s.link_ITL, link_ITL );
+    }
+
+    // PTL()
+    if ( !( sections & kSectionPTL ) ) return kAllOK;
+
+    if ( !s.seen[kPTL] ) return kNoPreviewTransformList;
+
+    for ( size_t j = 0; j < s.LMT.size(); ++j )
+    {
+        const TransformFields& f = s.LMT[j];
+        LMT.push_back( Transform() );
+        Transform& t = LMT.back();
+        t.status = kPreview;
+        if ( f.name.present() ) decode( f.name, t.name );
+        if ( f.status.present() )
+        {
+            decode( f.status, buf, sizeof(buf) );
+            t.status = get_status( buf );
+        }
+        if ( f.link.present() ) decode( f.link, t.link_transform );
+    }
+
+    if ( s.seen[kRRTODT] )
+    {
+        RRTODT.name.clear();
+        RRTODT.status = kPreview;
+        if ( s.RRTODT.name.present() ) decode( s.RRTODT.name, RRTODT.name );
+        if ( s.RRTODT.status.present() )
+        {
+            decode( s.RRTODT.status, buf, sizeof(buf) );
+            RRTODT.status = get_status( buf );
+        }
+    }
+    else
+    {
+        RRT.name.clear();
+        RRT.status = kPreview;
+        if ( s.RRT.name.present() ) decode( s.RRT.name, RRT.name );
+        if ( s.RRT.status.present() )
+        {
+            decode( s.RRT.status, buf, sizeof(buf) );
+            RRT.status = get_status( buf );
+        }
+    }
+
+    ODT.name.clear();
+    ODT.link_transform.clear();
+    ODT.status = kPreview;
+    if ( s.ODT.name.present() ) decode( s.ODT.name, ODT.name );
+    if ( s.ODT.status.present() )
+    {
+        decode( s.ODT.status, buf, sizeof(buf) );
+        ODT.status = get_status( buf );
+    }
+    if ( s.ODT.link.present() ) decode( s.ODT.link, ODT.link_transform );
+
+    if ( s.link_PTL.present() ) decode( s.link_PTL, link_PTL );
+
+    return kAllOK;
+}
+
+/** 
+ * Read some sections of the XML file through a memory mapping.
+ * 
+ * @param filename file to load the XML file from. 
+ * @param sections Section flags
+ * 
+ * @return ACESError.
+ */
+ACESclipReader::ACESError ACESclipReader::probe( const char* filename,
+                                                 unsigned sections )
+{
+    reset();
+
+    MappedFile f;
+    if ( !f.open( filename ) || f.size() == 0 ) return kFileError;
+
+    return scan( f.data(), f.data() + f.size(), sections );
+}
+
+/** 
+ * Read some sections of XML data in memory.
+ * 
+ * @param data     XML contents
+ * @param len      size of the contents, in bytes
+ * @param sections Section flags
+ * 
+ * @return ACESError.
+ */
+ACESclipReader::ACESError ACESclipReader::probe( const char* data, size_t len,
+                                                 unsigned sections )
+{
+    reset();
+    if ( !data || len == 0 ) return kFileError;
+
+    return scan( data, data + len, sections );
+}
+
+/** 
+ * Load the XML file through a memory mapping.
+ * 
+ * @param filename file to load the XML file from. 
+ * 
+ * @return ACESError.
+ */
+ACESclipReader::ACESError ACESclipReader::load_mapped( const char* filename )
+{
+    reset();
+
+    MappedFile f;
+    if ( !f.open( filename ) || f.size() == 0 ) return kFileError;
+
+    return scan( f.data(), f.data() + f.size() );
+}
+
+}  // namespace ACES
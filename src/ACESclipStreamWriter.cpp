@@ -0,0 +1,421 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <tinyxml2.h>
+
+#include "ACESclipStreamWriter.h"
+#include "ACESclipFormat.h"
+#include "ACESNumeric.h"
+#include "ACESUUID.h"
+#include "ACESxmlStream.h"
+
+
+namespace ACES {
+
+// Depth of the open elements each call adds to
+static const unsigned kRootDepth     = 1;  // aces:ACESmetadata
+static const unsigned kSectionDepth  = 2;  // aces:Info, aces:Config, ...
+static const unsigned kListDepth     = 3;  // aces:InputTransformList, ...
+static const unsigned kGradeRefDepth = 4;  // aces:GradeRef
+static const unsigned kCDLDepth      = 6;  // ASC_CDL
+
+// Bytes buffered before writing to the file descriptor
+static const size_t kChunkSize = 64 * 1024;
+
+
+ACESclipStreamWriter::ACESclipStreamWriter() :
+_xml( new XMLStream( _buffer ) ),
+_slots( NULL ),
+_fd( -1 ),
+_ok( true )
+{
+    header();
+}
+
+ACESclipStreamWriter::ACESclipStreamWriter( int fd ) :
+_xml( new XMLStream( _buffer ) ),
+_slots( NULL ),
+_fd( fd ),
+_ok( true )
+{
+    header();
+}
+
+ACESclipStreamWriter::~ACESclipStreamWriter()
+{
+    delete _xml;
+}
+
+void ACESclipStreamWriter::reset()
+{
+    _buffer.clear();
+    _xml->reset();
+    _ok = true;
+    if ( _slots ) _slots->clear();
+
+    LMT.clear();
+    IDT.reset();
+    RRT.reset();
+    RRTODT.reset();
+    ODT.reset();
+
+    header();
+}
+
+/** 
+ * Send the buffer to the file descriptor, if there is one.
+ * 
+ * @param all  send it even if it is not full.
+ */
+void ACESclipStreamWriter::flush( bool all )
+{
+    if ( _fd < 0 ) return;
+    if ( !all && _buffer.size() < kChunkSize ) return;
+
+    if ( _ok ) _ok = write_all( _fd, _buffer.data(), _buffer.size() );
+    _buffer.clear();
+}
+
+void ACESclipStreamWriter::header()
+{
+    XMLStream& x = *_xml;
+    x.declaration( "xml version=\"1.0\" encoding=\"UTF-8\"" );
+
+    x.open( "aces:ACESmetadata" );
+    x.attribute( "xmlns:aces", "http://www.oscars.org/aces/ref/acesmetadata" );
+
+    char buf[200];
+    XMLUtil::ToStr( kContainerVersion, buf, sizeof(buf) );
+    x.element( "ContainerFormatVersion", buf );
+    new_uuid( buf );
+    field( kUUID, "UUID", buf );
+    field( kModificationTime, "ModificationTime", 
+           format_date_time( time(0), buf ) );
+}
+
+/** 
+ * Element with the text of a Field, <name>text</name>, recording where
+ * the text went if there are slots.
+ */
+void ACESclipStreamWriter::field( Field f, const char* name, 
+                                  const char* text )
+{
+    XMLStream& x = *_xml;
+    x.open( name );
+    x.text( "", 0 );
+    size_t begin = _buffer.size();
+    x.text( text );
+    if ( _slots )
+    {
+        Slot s = { f, begin, _buffer.size() };
+        _slots->push_back( s );
+    }
+    x.close();
+}
+
+/** 
+ * Transform reference, with its optional LinkTransform.
+ */
+void ACESclipStreamWriter::transform( const char* element, 
+                                      const Transform& t )
+{
+    XMLStream& x = *_xml;
+    x.open( element );
+    x.attribute( "TransformID", t.name.c_str() );
+    x.attribute( "status", status_name( t.status ) );
+    if ( !t.link_transform.empty() )
+        x.element( "LinkTransform", t.link_transform.c_str() );
+    x.close();
+}
+
+void ACESclipStreamWriter::info( const std::string application,
+                                 const std::string version,
+                                 const std::string comment )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kRootDepth );
+    x.open( "aces:Info" );
+
+    x.open( "Application" );
+    x.attribute( "version", version.c_str() );
+    x.text( application.c_str() );
+    x.close();
+
+    if ( !comment.empty() )
+        x.element( "Comment", comment.c_str() );
+
+    flush( false );
+}
+
+void ACESclipStreamWriter::clip_id( const std::string clip_name,
+                                    const std::string media_id,
+                                    const time_t clip_date )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kRootDepth );
+    x.open( "aces:ClipID" );
+    field( kClipName, "ClipName", clip_name.c_str() );
+    field( kSourceMediaID, "Source_MediaID", media_id.c_str() );
+    char date[kDateTimeSize];
+    field( kClipDate, "ClipDate", format_date_time( clip_date, date ) );
+
+    flush( false );
+}
+
+void ACESclipStreamWriter::config( const time_t xml_date )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kRootDepth );
+    x.open( "aces:Config" );
+
+    char buf[200];
+    XMLUtil::ToStr( kVersion, buf, sizeof(buf) );
+    x.element( "ACESrelease_Version", buf );
+    field( kTimestamp, "Timestamp", format_date_time( xml_date, buf ) );
+
+    flush( false );
+}
+
+void ACESclipStreamWriter::gradeRef_start( const std::string convert_to,
+                                           const TransformStatus status,
+                                           ACESclipMetadata::BitDepth in_depth,
+                                           ACESclipMetadata::BitDepth out_depth )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kListDepth );
+    x.open( "aces:GradeRef" );
+    x.attribute( "status", status_name( status ) );
+
+    x.open( "Convert_to_WorkSpace" );
+    x.attribute( "TransformID", convert_to.c_str() );
+    x.close();
+
+    x.open( "ColorDecisionList" );
+    x.attribute( "id", "cdl0ID" );
+
+    x.open( "ASC_CDL" );
+    x.attribute( "id", "cc001" );
+    x.attribute( "inBitDepth", bit_depth_name( in_depth ) );
+    x.attribute( "outBitDepth", bit_depth_name( out_depth ) );
+}
+
+void ACESclipStreamWriter::gradeRef_SOPNode( const ASC_CDL& c )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kCDLDepth );
+    x.open( "SOPNode" );
+
+    char buf[3 * kFloatChars];
+    float slope[3] = { c.slope(0), c.slope(1), c.slope(2) };
+    format_V3( slope, buf );
+    field( kSlope, "Slope", buf );
+
+    float offset[3] = { c.offset(0), c.offset(1), c.offset(2) };
+    format_V3( offset, buf );
+    field( kOffset, "Offset", buf );
+
+    float power[3] = { c.power(0), c.power(1), c.power(2) };
+    format_V3( power, buf );
+    field( kPower, "Power", buf );
+}
+
+void ACESclipStreamWriter::gradeRef_SatNode( const ASC_CDL& c )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kCDLDepth );
+    x.open( "SatNode" );
+
+    char buf[kFloatChars];
+    format_float( c.saturation(), buf );
+    field( kSaturation, "Saturation", buf );
+}
+
+void ACESclipStreamWriter::gradeRef_end( const std::string convert_from )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kGradeRefDepth );
+    x.open( "Convert_from_WorkSpace" );
+    x.attribute( "TransformID", convert_from.c_str() );
+    x.close();
+
+    flush( false );
+}
+
+void ACESclipStreamWriter::ITL_start( TransformStatus status )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kSectionDepth );
+    x.open( "aces:InputTransformList" );
+    x.attribute( "status", status_name( status ) );
+}
+
+void ACESclipStreamWriter::add_IDT( const std::string name, 
+                                    TransformStatus status )
+{
+    IDT.name = name;
+    IDT.status = status;
+
+    if ( !IDT.name.empty() )
+    {
+        _xml->close_to( kListDepth );
+        transform( "aces:IDTref", IDT );
+    }
+}
+
+void ACESclipStreamWriter::ITL_end( const std::string it )
+{
+    _xml->close_to( kListDepth );
+    if ( !it.empty() )
+        _xml->element( "LinkInputTransformList", it.c_str() );
+
+    flush( false );
+}
+
+void ACESclipStreamWriter::PTL_start()
+{
+    XMLStream& x = *_xml;
+    x.close_to( kSectionDepth );
+    x.open( "aces:PreviewTransformList" );
+}
+
+void ACESclipStreamWriter::add_LMT( const std::string name, 
+                                    TransformStatus status,
+                                    const std::string link_transform )
+{
+    LMT.push_back( Transform( name, link_transform, status ) );
+}
+
+void ACESclipStreamWriter::add_RRT( const std::string name, 
+                                    TransformStatus status )
+{
+    RRT.name = name;
+    RRT.status = status;
+}
+
+void ACESclipStreamWriter::add_RRTODT( const std::string name, 
+                                       TransformStatus status )
+{
+    RRTODT.name = name;
+    RRTODT.status = status;
+}
+
+void ACESclipStreamWriter::add_ODT( const std::string name, 
+                                    TransformStatus status,
+                                    const std::string link_transform )
+{
+    ODT.name = name;
+    ODT.link_transform = link_transform;
+    ODT.status = status;
+}
+
+void ACESclipStreamWriter::PTL_end( const std::string t )
+{
+    XMLStream& x = *_xml;
+    x.close_to( kListDepth );
+
+    int count = 0;
+    for ( size_t i = 0; i < LMT.size(); ++i, ++count )
+        transform( "aces:LMTref", LMT[i] );
+
+    if ( !RRT.name.empty() )
+    {
+        ++count;
+        transform( "aces:RRTref", RRT );
+    }
+
+    if ( !RRTODT.name.empty() )
+    {
+        ++count;
+        transform( "aces:RRTODTref", RRTODT );
+    }
+
+    if ( !ODT.name.empty() )
+    {
+        ++count;
+        transform( "aces:ODTref", ODT );
+    }
+
+    if ( count > 1 && !t.empty() )
+        x.element( "LinkPreviewTransformList", t.c_str() );
+
+    flush( false );
+}
+
+bool ACESclipStreamWriter::finish()
+{
+    _xml->close_to( 0 );
+    flush( true );
+    return _ok;
+}
+
+bool ACESclipStreamWriter::save( const char* filename )
+{
+    if ( _fd >= 0 ) return false;
+
+    finish();
+
+    FILE* f = fopen( filename, "w" );
+    if ( !f ) return false;
+
+    bool ok = fwrite( _buffer.data(), 1, _buffer.size(), f ) == 
+              _buffer.size();
+    if ( fclose( f ) != 0 ) ok = false;
+    return ok;
+}
+
+void ACESclipStreamWriter::save_to_string( std::string& out )
+{
+    finish();
+    out.assign( _buffer.data(), _buffer.size() );
+}
+
+size_t ACESclipStreamWriter::save_to_buffer( char* buffer, size_t size )
+{
+    finish();
+    size_t n = _buffer.size();
+    if ( buffer && n <= size )
+    {
+        memcpy( buffer, _buffer.data(), n );
+        if ( n < size ) buffer[n] = 0;
+    }
+    return n;
+}
+
+bool ACESclipStreamWriter::save_to_fd( int fd )
+{
+    if ( _fd >= 0 ) return false;
+
+    finish();
+    return write_all( fd, _buffer.data(), _buffer.size() );
+}
+
+}  // namespace ACES
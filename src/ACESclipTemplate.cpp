@@ -0,0 +1,175 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ACESclipTemplate.h"
+#include "ACESclipFormat.h"
+#include "ACESNumeric.h"
+#include "ACESUUID.h"
+#include "ACESxmlStream.h"
+
+
+namespace ACES {
+
+// Document stamped by stamp_to_file() and stamp_to_fd(), per thread
+static thread_local std::string t_document;
+
+
+ACESclipTemplate::Clip::Clip() :
+clip_name( NULL ),
+media_id( NULL ),
+clip_date( time(0) ),
+xml_date( clip_date ),
+cdl( NULL )
+{
+}
+
+ACESclipTemplate::ACESclipTemplate()
+{
+    // The base constructor wrote a header before there were slots.
+    _slots = &_fields;
+    ACESclipStreamWriter::reset();
+}
+
+void ACESclipTemplate::stamp( const Clip& c, std::string& out ) const
+{
+    assert( _xml->depth() == 0 );
+
+    out.clear();
+    out.reserve( _buffer.size() + 256 );
+
+    // Large enough for a UUID, a date or three floats
+    char buf[3 * kFloatChars + kDateTimeSize];
+    size_t pos = 0;
+    Slots::const_iterator i = _fields.begin();
+    Slots::const_iterator e = _fields.end();
+    for ( ; i != e; ++i )
+    {
+        const Slot& s = *i;
+        out.append( _buffer, pos, s.begin - pos );
+        pos = s.end;
+
+        const char* text = NULL;
+        const ASC_CDL* cdl = c.cdl;
+        switch( s.field )
+        {
+            case kUUID:
+                new_uuid( buf );
+                text = buf;
+                break;
+            case kModificationTime:
+                text = format_date_time( time(0), buf );
+                break;
+            case kClipName:
+                if ( c.clip_name )
+                    xml_escape( out, c.clip_name, strlen(c.clip_name), false );
+                else
+                    out.append( _buffer, s.begin, s.end - s.begin );
+                continue;
+            case kSourceMediaID:
+                if ( c.media_id )
+                    xml_escape( out, c.media_id, strlen(c.media_id), false );
+                else
+                    out.append( _buffer, s.begin, s.end - s.begin );
+                continue;
+            case kClipDate:
+                text = format_date_time( c.clip_date, buf );
+                break;
+            case kTimestamp:
+                text = format_date_time( c.xml_date, buf );
+                break;
+            case kSlope:
+                if ( !cdl ) break;
+                {
+                    float v[3] = { cdl->slope(0), cdl->slope(1), 
+                                   cdl->slope(2) };
+                    format_V3( v, buf );
+                }
+                text = buf;
+                break;
+            case kOffset:
+                if ( !cdl ) break;
+                {
+                    float v[3] = { cdl->offset(0), cdl->offset(1), 
+                                   cdl->offset(2) };
+                    format_V3( v, buf );
+                }
+                text = buf;
+                break;
+            case kPower:
+                if ( !cdl ) break;
+                {
+                    float v[3] = { cdl->power(0), cdl->power(1), 
+                                   cdl->power(2) };
+                    format_V3( v, buf );
+                }
+                text = buf;
+                break;
+            case kSaturation:
+                if ( !cdl ) break;
+                format_float( cdl->saturation(), buf );
+                text = buf;
+                break;
+            default:
+                break;
+        }
+
+        // Numbers, dates and UUIDs need no escaping
+        if ( text )
+            out.append( text );
+        else
+            out.append( _buffer, s.begin, s.end - s.begin );
+    }
+    out.append( _buffer, pos, std::string::npos );
+}
+
+bool ACESclipTemplate::stamp_to_file( const char* filename, 
+                                      const Clip& c ) const
+{
+    stamp( c, t_document );
+
+    FILE* f = fopen( filename, "w" );
+    if ( !f ) return false;
+
+    bool ok = fwrite( t_document.data(), 1, t_document.size(), f ) == 
+              t_document.size();
+    if ( fclose( f ) != 0 ) ok = false;
+    return ok;
+}
+
+bool ACESclipTemplate::stamp_to_fd( int fd, const Clip& c ) const
+{
+    stamp( c, t_document );
+    return write_all( fd, t_document.data(), t_document.size() );
+}
+
+}  // namespace ACES
@@ -27,19 +27,16 @@ of the authors and should not be interpreted as representing official policies,
 either expressed or implied, of the FreeBSD Project.
 */
 
-#include <boost/uuid/uuid.hpp>            // uuid class
-#include <boost/uuid/uuid_generators.hpp> // generators
-#include <boost/uuid/uuid_io.hpp> // input-output
-#include <boost/lexical_cast.hpp> // for casting uuid into std::string
+#include <string.h>
 
 #include "ACESclipWriter.h"
+#include "ACESclipFormat.h"
+#include "ACESNumeric.h"
+#include "ACESUUID.h"
 
 
 namespace ACES {
 
-static const double kVersion = 1.0;
-static const double kContainerVersion = 1.0;
-
 using namespace tinyxml2;
 
 
@@ -52,12 +49,8 @@ using namespace tinyxml2;
  */
 std::string ACESclipWriter::date_time( const time_t& t ) const
 {
-    char buf[24];
-    struct tm* now = localtime( &t );
-    sprintf( buf, "%d-%02d-%02dT%02d:%02d:%02d",
-             now->tm_year+1900, now->tm_mon+1, now->tm_mday,
-             now->tm_hour, now->tm_min, now->tm_sec );
-    return buf;
+    char buf[kDateTimeSize];
+    return format_date_time( t, buf );
 }
 
 
@@ -68,24 +61,46 @@ std::string ACESclipWriter::date_time( const time_t& t ) const
  */
 void ACESclipWriter::set_status( TransformStatus s )
 {
-    const char* p;
-    switch( s )
-    {
-        case kPreview:
-            p = "preview"; break;
-        case kApplied:
-            p = "applied"; break;
-        default:
-            p = "unknown"; break;
-    }
-    element->SetAttribute( "status", p );
+    element->SetAttribute( "status", status_name( s ) );
 }
 
 /** 
  * Constructor
  * 
  */
-ACESclipWriter::ACESclipWriter()
+ACESclipWriter::ACESclipWriter() :
+element( NULL ),
+root( NULL ), root2( NULL ), root3( NULL ), root4( NULL ),
+root5( NULL ), root6( NULL ), root7( NULL )
+{
+    header();
+}
+
+/** 
+ * Start a new document, clearing the previous one.
+ * 
+ */
+void ACESclipWriter::reset()
+{
+    doc.Clear();
+    element = NULL;
+    root = root2 = root3 = root4 = root5 = root6 = root7 = NULL;
+
+    LMT.clear();
+    IDT.reset();
+    RRT.reset();
+    RRTODT.reset();
+    ODT.reset();
+
+    header();
+}
+
+/** 
+ * Declaration, ContainerFormatVersion, UUID and ModificationTime that
+ * start every document.
+ * 
+ */
+void ACESclipWriter::header()
 {
     XMLDeclaration* decl = doc.NewDeclaration( NULL );
     doc.InsertFirstChild( decl );
@@ -100,18 +115,18 @@ ACESclipWriter::ACESclipWriter()
     element->SetText( kContainerVersion );
     root->InsertEndChild( element );
 
-    boost::uuids::uuid uuid = boost::uuids::random_generator()();
-    std::string UUID = boost::lexical_cast<std::string>(uuid);
+    char uuid[37];
+    new_uuid( uuid );
 
     element = doc.NewElement("UUID");
-    element->SetText( UUID.c_str() );
+    element->SetText( uuid );
     root->InsertEndChild( element );
 
     element = doc.NewElement("ModificationTime");
 
+    char date[kDateTimeSize];
     time_t t = time(0);   // get time now
-    const std::string& date = date_time( t );
-    element->SetText( date.c_str() );
+    element->SetText( format_date_time( t, date ) );
     root->InsertEndChild( element );
 }
 
@@ -165,10 +180,10 @@ void ACESclipWriter::clip_id( const std::string clip_name,
     element->SetText( media_id.c_str() );
     root2->InsertEndChild( element );
 
-    std::string date = date_time( clip_date );
+    char date[kDateTimeSize];
 
     element = doc.NewElement("ClipDate");
-    element->SetText( date.c_str() );
+    element->SetText( format_date_time( clip_date, date ) );
     root2->InsertEndChild( element );
 }
 
@@ -188,14 +203,16 @@ void ACESclipWriter::config( const time_t xml_date )
 
     element = doc.NewElement("Timestamp");
 
-    std::string date = date_time( xml_date );
-    element->SetText( date.c_str() );
+    char date[kDateTimeSize];
+    element->SetText( format_date_time( xml_date, date ) );
     root2->InsertEndChild( element );
 }
 
 
 void ACESclipWriter::gradeRef_start( const std::string convert_to,
-                                     const TransformStatus status )
+                                     const TransformStatus status,
+                                     ACESclipMetadata::BitDepth in_depth,
+                                     ACESclipMetadata::BitDepth out_depth )
 {
     element = doc.NewElement("aces:GradeRef");
     set_status( status );
@@ -214,8 +231,8 @@ void ACESclipWriter::gradeRef_start( const std::string convert_to,
 
     element = doc.NewElement("ASC_CDL");
     element->SetAttribute( "id", "cc001" );
-    element->SetAttribute( "inBitDepth", "32f" );
-    element->SetAttribute( "outBitDepth", "32f" );
+    element->SetAttribute( "inBitDepth", bit_depth_name( in_depth ) );
+    element->SetAttribute( "outBitDepth", bit_depth_name( out_depth ) );
     root5->InsertEndChild( element );
     root6 = element;
 }
@@ -225,22 +242,25 @@ void ACESclipWriter::gradeRef_SOPNode( const ASC_CDL& c )
     element = doc.NewElement("SOPNode");
     root6->InsertEndChild( element );
 
-    char buf[256];
+    char buf[3 * kFloatChars];
     XMLNode* root7 = element;
 
     element = doc.NewElement("Slope");
     root7->InsertEndChild( element );
-    sprintf( buf, "%g %g %g", c.slope(0), c.slope(1), c.slope(2) );
+    float slope[3] = { c.slope(0), c.slope(1), c.slope(2) };
+    format_V3( slope, buf );
     element->SetText( buf );
 
     element = doc.NewElement("Offset");
     root7->InsertEndChild( element );
-    sprintf( buf, "%g %g %g", c.offset(0), c.offset(1), c.offset(2) );
+    float offset[3] = { c.offset(0), c.offset(1), c.offset(2) };
+    format_V3( offset, buf );
     element->SetText( buf );
 
     element = doc.NewElement("Power");
     root7->InsertEndChild( element );
-    sprintf( buf, "%g %g %g", c.power(0), c.power(1), c.power(2) );
+    float power[3] = { c.power(0), c.power(1), c.power(2) };
+    format_V3( power, buf );
     element->SetText( buf );
 }
 
@@ -250,8 +270,11 @@ void ACESclipWriter::gradeRef_SatNode( const ASC_CDL& c )
     root6->InsertEndChild( element );
     XMLNode* root7 = element;
 
+    char buf[kFloatChars];
+    format_float( c.saturation(), buf );
+
     element = doc.NewElement("Saturation");
-    element->SetText( c.saturation() );
+    element->SetText( buf );
     root7->InsertEndChild( element );
 }
 
@@ -483,6 +506,34 @@ bool ACESclipWriter::save( const char* filename )
     return true;
 }
 
+void ACESclipWriter::save_to_string( std::string& out ) const
+{
+    XMLPrinter printer;
+    doc.Print( &printer );
+    out.assign( printer.CStr(), printer.CStrSize() - 1 );
+}
+
+size_t ACESclipWriter::save_to_buffer( char* buffer, size_t size ) const
+{
+    XMLPrinter printer;
+    doc.Print( &printer );
+
+    // CStrSize() counts the NUL
+    size_t n = printer.CStrSize() - 1;
+    if ( buffer && n <= size )
+    {
+        memcpy( buffer, printer.CStr(), n );
+        if ( n < size ) buffer[n] = 0;
+    }
+    return n;
+}
+
+bool ACESclipWriter::save_to_fd( int fd ) const
+{
+    XMLPrinter printer;
+    doc.Print( &printer );
+    return write_all( fd, printer.CStr(), printer.CStrSize() - 1 );
+}
 
 }  // namespace ACES
 
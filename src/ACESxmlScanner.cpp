@@ -0,0 +1,427 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <string.h>
+
+#include "ACESxmlScanner.h"
+
+
+namespace ACES {
+
+static inline bool is_space( char c )
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool XMLSpan::operator==( const char* s ) const
+{
+    size_t len = strlen( s );
+    return len == size() && memcmp( begin, s, len ) == 0;
+}
+
+XMLScanner::XMLScanner( const char* begin, const char* end ) :
+_begin( begin ),
+_end( end ),
+_p( begin ),
+_cdata( false ),
+_first_child( false ),
+_pending_end( false ),
+_depth( 0 ),
+_token_depth( 0 ),
+_num_attributes( 0 )
+{
+    _has_child[0] = false;
+
+    // Skip a UTF-8 byte order mark, as tinyxml2 does.
+    if ( _end - _p >= 3 && (unsigned char)_p[0] == 0xEF &&
+         (unsigned char)_p[1] == 0xBB && (unsigned char)_p[2] == 0xBF )
+        _p += 3;
+}
+
+/** 
+ * Move past the next occurrence of marker.
+ * 
+ * @param marker string to look for
+ * 
+ * @return true if found, false if the buffer ended first
+ */
+bool XMLScanner::skip_past( const char* marker )
+{
+    size_t len = strlen( marker );
+    for ( ; _p + len <= _end; ++_p )
+    {
+        if ( *_p == *marker && memcmp( _p, marker, len ) == 0 )
+        {
+            _p += len;
+            return true;
+        }
+    }
+    _p = _end;
+    return false;
+}
+
+XMLScanner::Token XMLScanner::start_element()
+{
+    const char* p = _p + 1;
+    const char* n = p;
+    while ( p < _end && !is_space( *p ) && *p != '/' && *p != '>' ) ++p;
+    if ( p == n || p >= _end ) return error();
+
+    _name = XMLSpan( n, p );
+    _num_attributes = 0;
+
+    for (;;)
+    {
+        while ( p < _end && is_space( *p ) ) ++p;
+        if ( p >= _end ) return error();
+
+        if ( *p == '>' )
+        {
+            ++p;
+            break;
+        }
+
+        if ( *p == '/' )
+        {
+            if ( p + 1 >= _end || p[1] != '>' ) return error();
+            p += 2;
+            _pending_end = true;
+            break;
+        }
+
+        const char* an = p;
+        while ( p < _end && !is_space( *p ) && *p != '=' && 
+                *p != '>' && *p != '/' ) ++p;
+        const char* ae = p;
+        while ( p < _end && is_space( *p ) ) ++p;
+        if ( ae == an || p >= _end || *p != '=' ) return error();
+        ++p;
+
+        while ( p < _end && is_space( *p ) ) ++p;
+        if ( p >= _end || ( *p != '"' && *p != '\'' ) ) return error();
+
+        char quote = *p++;
+        const char* vb = p;
+        while ( p < _end && *p != quote ) ++p;
+        if ( p >= _end ) return error();
+
+        if ( _num_attributes < kMaxAttributes )
+        {
+            _attr_name[_num_attributes]  = XMLSpan( an, ae );
+            _attr_value[_num_attributes] = XMLSpan( vb, p );
+            ++_num_attributes;
+        }
+        ++p;
+    }
+
+    if ( _depth >= kMaxDepth ) return error();
+
+    _has_child[_depth] = true;
+    _stack[_depth] = _name;
+    ++_depth;
+    _has_child[_depth] = false;
+    _token_depth = _depth;
+
+    _p = p;
+    return kStartElement;
+}
+
+XMLScanner::Token XMLScanner::end_element()
+{
+    const char* p = _p + 2;
+    const char* n = p;
+    while ( p < _end && !is_space( *p ) && *p != '>' ) ++p;
+
+    XMLSpan name( n, p );
+    while ( p < _end && is_space( *p ) ) ++p;
+    if ( p >= _end || *p != '>' || _depth == 0 ) return error();
+
+    const XMLSpan& open = _stack[_depth-1];
+    if ( open.size() != name.size() ||
+         memcmp( open.begin, name.begin, name.size() ) != 0 )
+        return error();
+
+    _name = name;
+    _token_depth = _depth;
+    --_depth;
+
+    _p = p + 1;
+    return kEndElement;
+}
+
+XMLScanner::Token XMLScanner::next()
+{
+    if ( _pending_end )
+    {
+        _pending_end = false;
+        _token_depth = _depth;
+        --_depth;
+        return kEndElement;
+    }
+
+    while ( _p < _end )
+    {
+        if ( *_p != '<' )
+        {
+            // Whitespace only runs are not text nodes in tinyxml2.
+            const char* s = _p;
+            bool blank = true;
+            for ( ; _p < _end && *_p != '<'; ++_p )
+            {
+                if ( !is_space( *_p ) ) blank = false;
+            }
+            if ( blank || _depth == 0 ) continue;
+
+            _text = XMLSpan( s, _p );
+            _cdata = false;
+            _first_child = !_has_child[_depth];
+            _has_child[_depth] = true;
+            _token_depth = _depth;
+            return kText;
+        }
+
+        size_t left = (size_t)( _end - _p );
+        if ( left < 2 ) return error();
+
+        if ( _p[1] == '/' ) return end_element();
+
+        if ( _p[1] == '?' )
+        {
+            _p += 2;
+            if ( !skip_past( "?>" ) ) return error();
+            _has_child[_depth] = true;
+            continue;
+        }
+
+        if ( _p[1] != '!' ) return start_element();
+
+        if ( left >= 4 && memcmp( _p, "<!--", 4 ) == 0 )
+        {
+            _p += 4;
+            if ( !skip_past( "-->" ) ) return error();
+            _has_child[_depth] = true;
+            continue;
+        }
+
+        if ( left >= 9 && memcmp( _p, "<![CDATA[", 9 ) == 0 )
+        {
+            _p += 9;
+            const char* s = _p;
+            if ( !skip_past( "]]>" ) || _depth == 0 ) return error();
+
+            _text = XMLSpan( s, _p - 3 );
+            _cdata = true;
+            _first_child = !_has_child[_depth];
+            _has_child[_depth] = true;
+            _token_depth = _depth;
+            return kText;
+        }
+
+        // <!DOCTYPE ...> and friends, possibly with an internal subset.
+        int nest = 0;
+        for ( _p += 2; _p < _end; ++_p )
+        {
+            if ( *_p == '[' ) ++nest;
+            else if ( *_p == ']' ) --nest;
+            else if ( *_p == '>' && nest <= 0 ) break;
+        }
+        if ( _p >= _end ) return error();
+        ++_p;
+        _has_child[_depth] = true;
+    }
+
+    if ( _depth != 0 ) return error();
+    return kEndOfDocument;
+}
+
+bool XMLScanner::attribute( const char* name, XMLSpan& value ) const
+{
+    for ( unsigned i = 0; i < _num_attributes; ++i )
+    {
+        if ( _attr_name[i] == name )
+        {
+            value = _attr_value[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//
+// Entity decoding
+//
+
+struct StringOutput
+{
+    StringOutput( std::string& s ) : out( s ) {}
+    void put( char c ) { out.push_back( c ); }
+    std::string& out;
+};
+
+struct BufferOutput
+{
+    BufferOutput( char* b, size_t size ) : p( b ), left( size - 1 ), len( 0 ) {}
+    void put( char c ) { if ( left ) { *p++ = c; --left; ++len; } }
+    char*  p;
+    size_t left;
+    size_t len;
+};
+
+template< class Output >
+static void put_utf8( unsigned long c, Output& out )
+{
+    if ( c < 0x80 )
+    {
+        out.put( (char) c );
+    }
+    else if ( c < 0x800 )
+    {
+        out.put( (char)( 0xC0 | ( c >> 6 ) ) );
+        out.put( (char)( 0x80 | ( c & 0x3F ) ) );
+    }
+    else if ( c < 0x10000 )
+    {
+        out.put( (char)( 0xE0 | ( c >> 12 ) ) );
+        out.put( (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) ) );
+        out.put( (char)( 0x80 | ( c & 0x3F ) ) );
+    }
+    else if ( c < 0x200000 )
+    {
+        out.put( (char)( 0xF0 | ( c >> 18 ) ) );
+        out.put( (char)( 0x80 | ( ( c >> 12 ) & 0x3F ) ) );
+        out.put( (char)( 0x80 | ( ( c >> 6 ) & 0x3F ) ) );
+        out.put( (char)( 0x80 | ( c & 0x3F ) ) );
+    }
+}
+
+/** 
+ * Decode one entity starting at p (which points to '&').
+ * 
+ * @return pointer past the entity, or NULL if it is not one we know.
+ */
+template< class Output >
+static const char* put_entity( const char* p, const char* end, Output& out )
+{
+    const char* semi = p + 1;
+    while ( semi < end && semi - p < 12 && *semi != ';' ) ++semi;
+    if ( semi >= end || *semi != ';' ) return NULL;
+
+    XMLSpan e( p + 1, semi );
+    if ( e == "lt" )        out.put( '<' );
+    else if ( e == "gt" )   out.put( '>' );
+    else if ( e == "amp" )  out.put( '&' );
+    else if ( e == "quot" ) out.put( '"' );
+    else if ( e == "apos" ) out.put( '\'' );
+    else if ( e.size() > 1 && e.begin[0] == '#' )
+    {
+        unsigned long c = 0;
+        const char* d = e.begin + 1;
+        if ( *d == 'x' || *d == 'X' )
+        {
+            for ( ++d; d < e.end; ++d )
+            {
+                if ( *d >= '0' && *d <= '9' )      c = c * 16 + ( *d - '0' );
+                else if ( *d >= 'a' && *d <= 'f' ) c = c * 16 + ( *d - 'a' + 10 );
+                else if ( *d >= 'A' && *d <= 'F' ) c = c * 16 + ( *d - 'A' + 10 );
+                else return NULL;
+            }
+        }
+        else
+        {
+            for ( ; d < e.end; ++d )
+            {
+                if ( *d < '0' || *d > '9' ) return NULL;
+                c = c * 10 + ( *d - '0' );
+            }
+        }
+        put_utf8( c, out );
+    }
+    else
+    {
+        return NULL;
+    }
+
+    return semi + 1;
+}
+
+template< class Output >
+static void decode( const XMLSpan& s, Output& out )
+{
+    const char* p = s.begin;
+    while ( p < s.end )
+    {
+        char c = *p;
+        if ( c == '\r' )
+        {
+            out.put( '\n' );
+            ++p;
+            if ( p < s.end && *p == '\n' ) ++p;
+            continue;
+        }
+        if ( c == '&' )
+        {
+            const char* n = put_entity( p, s.end, out );
+            if ( n )
+            {
+                p = n;
+                continue;
+            }
+        }
+        out.put( c );
+        ++p;
+    }
+}
+
+void xml_decode( const XMLSpan& s, std::string& out )
+{
+    const char* p = s.begin;
+    while ( p < s.end && *p != '&' && *p != '\r' ) ++p;
+    if ( p == s.end )
+    {
+        // Common case, nothing to decode.
+        out.assign( s.begin, s.size() );
+        return;
+    }
+
+    out.assign( s.begin, (size_t)( p - s.begin ) );
+    StringOutput o( out );
+    decode( XMLSpan( p, s.end ), o );
+}
+
+size_t xml_decode( const XMLSpan& s, char* out, size_t size )
+{
+    if ( size == 0 ) return 0;
+    BufferOutput o( out, size );
+    decode( s, o );
+    *o.p = 0;
+    return o.len;
+}
+
+}  // namespace ACES
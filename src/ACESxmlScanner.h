@@ -0,0 +1,170 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESxmlScanner_h
+#define ACESxmlScanner_h
+
+#include <stddef.h>
+#include <string>
+
+namespace ACES {
+
+/**
+ * XMLSpan:  a run of bytes inside the buffer being scanned.  Nothing is
+ *           copied, so a span is only valid while that buffer is.
+ */
+struct XMLSpan
+{
+    XMLSpan() : begin( NULL ), end( NULL ) {}
+    XMLSpan( const char* b, const char* e ) : begin( b ), end( e ) {}
+
+    bool   empty() const { return begin == end; }
+    size_t size() const  { return (size_t)( end - begin ); }
+
+    bool operator==( const char* s ) const;
+    bool operator!=( const char* s ) const { return !( *this == s ); }
+
+    const char* begin;
+    const char* end;
+};
+
+/**
+ * XMLScanner:  pull tokenizer that walks an XML buffer in place.
+ *
+ * It is not a validating parser.  It understands exactly what the
+ * ACESclip files need: elements, attributes, text, CDATA, and it skips
+ * the declaration, processing instructions, comments and DOCTYPE.
+ * Start and end tags must nest properly or kError is returned.
+ */
+class XMLScanner
+{
+  public:
+    enum Token
+    {
+    kStartElement,
+    kEndElement,
+    kText,
+    kEndOfDocument,
+    kError
+    };
+
+    enum { kMaxDepth = 64, kMaxAttributes = 16 };
+
+    XMLScanner( const char* begin, const char* end );
+
+    /** 
+     * Advance to the next token.  A self-closing element is returned as
+     * a kStartElement followed by its kEndElement.
+     * 
+     * @return the token type
+     */
+    Token next();
+
+    /// Name of the element for kStartElement and kEndElement
+    const XMLSpan& name() const { return _name; }
+
+    /// Raw (undecoded) contents for kText
+    const XMLSpan& text() const { return _text; }
+
+    /// True if the kText token is raw CDATA (no entities to decode)
+    bool cdata() const { return _cdata; }
+
+    /// True if the kText token is the first child of its element,
+    /// which is what tinyxml2's GetText() returns.
+    bool first_child() const { return _first_child; }
+
+    /// Depth of the element the token belongs to (for kText, of the
+    /// enclosing element).  The root element is at depth 1.
+    unsigned depth() const { return _token_depth; }
+
+    /** 
+     * Look up an attribute of the last kStartElement.
+     * 
+     * @param name   name of the attribute
+     * @param value  raw (undecoded) value of the attribute
+     * 
+     * @return true if found, false if not.
+     */
+    bool attribute( const char* name, XMLSpan& value ) const;
+
+    /// Bytes consumed so far.
+    size_t offset() const { return (size_t)( _p - _begin ); }
+
+  protected:
+    Token error() { _p = _end; return kError; }
+    bool skip_past( const char* marker );
+    Token start_element();
+    Token end_element();
+
+  protected:
+    const char* _begin;
+    const char* _end;
+    const char* _p;
+
+    XMLSpan     _name;
+    XMLSpan     _text;
+    bool        _cdata;
+    bool        _first_child;
+    bool        _pending_end;
+
+    unsigned    _depth;
+    unsigned    _token_depth;
+    XMLSpan     _stack[kMaxDepth];
+    bool        _has_child[kMaxDepth+1];
+
+    unsigned    _num_attributes;
+    XMLSpan     _attr_name[kMaxAttributes];
+    XMLSpan     _attr_value[kMaxAttributes];
+};
+
+/** 
+ * Decode the entities of a span the way tinyxml2 does for text and
+ * attribute values (the five named entities, numeric character
+ * references and newline normalization).
+ * 
+ * @param s    raw span
+ * @param out  decoded string (overwritten)
+ */
+void xml_decode( const XMLSpan& s, std::string& out );
+
+/** 
+ * Same as above, decoding into a fixed buffer that is always NUL
+ * terminated.  Longer contents are truncated.
+ * 
+ * @param s     raw span
+ * @param out   buffer to decode into
+ * @param size  size of the buffer, in bytes
+ * 
+ * @return the length of the decoded string
+ */
+size_t xml_decode( const XMLSpan& s, char* out, size_t size );
+
+}  // namespace ACES
+
+#endif  // ACESxmlScanner_h
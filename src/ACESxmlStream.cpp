@@ -0,0 +1,179 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "ACESxmlStream.h"
+
+
+namespace ACES {
+
+void xml_escape( std::string& out, const char* s, size_t len,
+                 bool attribute )
+{
+    const char* run = s;
+    const char* end = s + len;
+    for ( ; s != end; ++s )
+    {
+        const char* entity;
+        switch( *s )
+        {
+            case '&':  entity = "&amp;"; break;
+            case '<':  entity = "&lt;"; break;
+            case '>':  entity = "&gt;"; break;
+            case '"':  entity = attribute ? "&quot;" : NULL; break;
+            case '\'': entity = attribute ? "&apos;" : NULL; break;
+            default:   entity = NULL; break;
+        }
+        if ( !entity ) continue;
+
+        out.append( run, s - run );
+        out += entity;
+        run = s + 1;
+    }
+    out.append( run, end - run );
+}
+
+XMLStream::XMLStream( std::string& out ) :
+_out( out )
+{
+    reset();
+}
+
+void XMLStream::reset()
+{
+    _depth = 0;
+    _text_depth = -1;
+    _just_opened = false;
+    _first = true;
+}
+
+void XMLStream::seal()
+{
+    if ( _just_opened )
+    {
+        _just_opened = false;
+        _out += '>';
+    }
+}
+
+void XMLStream::indent( unsigned d )
+{
+    _out.append( d * 4, ' ' );
+}
+
+void XMLStream::declaration( const char* value )
+{
+    seal();
+    if ( _text_depth < 0 && !_first )
+    {
+        _out += '\n';
+        indent( _depth );
+    }
+    _first = false;
+    _out += "<?";
+    _out += value;
+    _out += "?>";
+}
+
+void XMLStream::open( const char* name )
+{
+    assert( _depth < kMaxDepth );
+
+    seal();
+    _stack[_depth] = name;
+    if ( _text_depth < 0 && !_first ) _out += '\n';
+    indent( _depth );
+    _out += '<';
+    _out += name;
+    _just_opened = true;
+    _first = false;
+    ++_depth;
+}
+
+void XMLStream::attribute( const char* name, const char* value )
+{
+    _out += ' ';
+    _out += name;
+    _out += "=\"";
+    xml_escape( _out, value, strlen(value), true );
+    _out += '"';
+}
+
+void XMLStream::text( const char* text, size_t len )
+{
+    _text_depth = int( _depth ) - 1;
+    seal();
+    xml_escape( _out, text, len, false );
+}
+
+void XMLStream::text( const char* text )
+{
+    XMLStream::text( text, strlen(text) );
+}
+
+void XMLStream::close()
+{
+    assert( _depth > 0 );
+
+    --_depth;
+    if ( _just_opened )
+    {
+        _out += "/>";
+    }
+    else
+    {
+        if ( _text_depth < 0 )
+        {
+            _out += '\n';
+            indent( _depth );
+        }
+        _out += "</";
+        _out += _stack[_depth];
+        _out += '>';
+    }
+    if ( _text_depth == int( _depth ) ) _text_depth = -1;
+    if ( _depth == 0 ) _out += '\n';
+    _just_opened = false;
+}
+
+void XMLStream::close_to( unsigned d )
+{
+    while ( _depth > d ) close();
+}
+
+void XMLStream::element( const char* name, const char* text )
+{
+    open( name );
+    XMLStream::text( text );
+    close();
+}
+
+}  // namespace ACES
@@ -0,0 +1,107 @@
+/* 
+Copyright (c) 2015, Gonzalo Garramuño
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer. 
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies, 
+either expressed or implied, of the FreeBSD Project.
+*/
+
+#ifndef ACESxmlStream_h
+#define ACESxmlStream_h
+
+#include <string>
+
+namespace ACES {
+
+/** 
+ * Append text to a string, escaped as XMLStream escapes it.
+ * 
+ * @param attribute  escape quotes too, for attribute values.
+ */
+void xml_escape( std::string& out, const char* s, size_t len,
+                 bool attribute );
+
+/**
+ * XMLStream:  writes XML straight into a string, one call per node.
+ *
+ * Layout and escaping follow tinyxml2's XMLPrinter exactly (four space
+ * indentation, <x/> for empty elements, text kept on the line of its
+ * element, &amp; &lt; &gt; escaped in text and &quot; &apos; too in
+ * attributes), so a document streamed here is byte for byte the same as
+ * the one tinyxml2 prints from a DOM built with the same nodes.
+ *
+ * Element names are not copied; they must stay valid until the element
+ * is closed (string literals, in practice).
+ */
+class XMLStream
+{
+  public:
+    enum { kMaxDepth = 64 };
+
+  public:
+    XMLStream( std::string& out );
+
+    /** 
+     * Start over, writing a new document.  The output is not cleared.
+     */
+    void reset();
+
+    void declaration( const char* value );
+    void open( const char* name );
+    void attribute( const char* name, const char* value );
+    void text( const char* text, size_t len );
+    void text( const char* text );
+    void close();
+
+    /** 
+     * Close elements until depth() is d.
+     */
+    void close_to( unsigned d );
+
+    /** 
+     * Element with text only, <name>text</name>.
+     */
+    void element( const char* name, const char* text );
+
+    /** 
+     * @return number of open elements.
+     */
+    unsigned depth() const { return _depth; }
+
+  protected:
+    void seal();
+    void indent( unsigned d );
+
+  protected:
+    std::string& _out;
+    const char*  _stack[kMaxDepth];
+    unsigned     _depth;
+    int          _text_depth;
+    bool         _just_opened;
+    bool         _first;
+};
+
+}  // namespace ACES
+
+#endif  // ACESxmlStream_h